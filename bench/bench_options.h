@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cxxopts.hpp>
+#include "synthetic_codebase.h"
+
+namespace cpp_diagram {
+
+// Options shared by the generator and the benchmark drivers
+inline void addSpecOptions(cxxopts::Options& options) {
+    options.add_options("codebase")
+        ("entities", "Approximate number of classes, methods and functions (overrides --classes/--functions)",
+         cxxopts::value<long long>())
+        ("classes", "Number of classes", cxxopts::value<int>()->default_value("100"))
+        ("functions", "Number of free functions", cxxopts::value<int>()->default_value("100"))
+        ("depth", "Hierarchy depth", cxxopts::value<int>()->default_value("3"))
+        ("methods", "Methods per class", cxxopts::value<int>()->default_value("4"))
+        ("fields", "Fields per class", cxxopts::value<int>()->default_value("3"))
+        ("calls", "Calls per function", cxxopts::value<int>()->default_value("3"))
+        ("templates", "Fraction of template classes", cxxopts::value<double>()->default_value("0.1"))
+        ("classes-per-file", "Classes per generated file", cxxopts::value<int>()->default_value("64"))
+        ("seed", "Random seed", cxxopts::value<unsigned>()->default_value("42"));
+}
+
+inline SyntheticSpec specFromOptions(const cxxopts::ParseResult& result) {
+    SyntheticSpec spec;
+    spec.classes = result["classes"].as<int>();
+    spec.functions = result["functions"].as<int>();
+    spec.hierarchyDepth = result["depth"].as<int>();
+    spec.methodsPerClass = result["methods"].as<int>();
+    spec.fieldsPerClass = result["fields"].as<int>();
+    spec.callsPerFunction = result["calls"].as<int>();
+    spec.templateRatio = result["templates"].as<double>();
+    spec.classesPerFile = result["classes-per-file"].as<int>();
+    spec.seed = result["seed"].as<unsigned>();
+    if (result.count("entities")) {
+        spec.scaleToEntities(result["entities"].as<long long>());
+    }
+    return spec;
+}
+
+} // namespace cpp_diagram
@@ -0,0 +1,34 @@
+#include <iostream>
+#include "bench_options.h"
+
+int main(int argc, char* argv[]) {
+    try {
+        cxxopts::Options options("cpp_diagram_codegen",
+                               "Generate a synthetic C++ codebase for benchmarking");
+        options.add_options()
+            ("o,output", "Output directory", cxxopts::value<std::string>())
+            ("h,help", "Print usage");
+        cpp_diagram::addSpecOptions(options);
+
+        auto result = options.parse(argc, argv);
+        if (result.count("help") || !result.count("output")) {
+            std::cout << options.help() << std::endl;
+            return result.count("help") ? 0 : 1;
+        }
+
+        cpp_diagram::SyntheticSpec spec = cpp_diagram::specFromOptions(result);
+        cpp_diagram::SyntheticCodebase codebase(spec);
+        auto files = codebase.writeSources(result["output"].as<std::string>());
+
+        std::cout << "Generated " << files.size() << " files with "
+                  << spec.entityCount() << " entities" << std::endl;
+        return 0;
+
+    } catch (const cxxopts::OptionException& e) {
+        std::cerr << "Error parsing options: " << e.what() << std::endl;
+        return 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,56 @@
+#!/usr/bin/env python3
+"""Compare two cpp_diagram_pipeline_bench result files.
+
+Exits non-zero when any stage's throughput in the current run drops more
+than --threshold below the baseline, so CI can gate on it.
+"""
+import argparse
+import json
+import sys
+
+
+def load(path):
+    with open(path) as f:
+        return json.load(f)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--threshold", type=float, default=0.10,
+                        help="allowed fractional throughput drop (default 0.10)")
+    args = parser.parse_args()
+
+    baseline = load(args.baseline)
+    current = load(args.current)
+    if baseline.get("spec") != current.get("spec") or baseline.get("mode") != current.get("mode"):
+        print("warning: baseline and current runs used different specs", file=sys.stderr)
+
+    regressions = 0
+    print(f"{'stage':<10}{'baseline/s':>16}{'current/s':>16}{'change':>10}")
+    for stage, base in baseline["stages"].items():
+        cur = current["stages"].get(stage)
+        if cur is None:
+            print(f"{stage:<10}{base['throughput']:>16.1f}{'missing':>16}")
+            regressions += 1
+            continue
+        if base["throughput"] <= 0:
+            continue
+        change = cur["throughput"] / base["throughput"] - 1.0
+        flag = ""
+        if change < -args.threshold:
+            flag = "  REGRESSION"
+            regressions += 1
+        print(f"{stage:<10}{base['throughput']:>16.1f}{cur['throughput']:>16.1f}{change:>+9.1%}{flag}")
+
+    base_rss = baseline.get("peak_rss_kb", 0)
+    cur_rss = current.get("peak_rss_kb", 0)
+    if base_rss > 0:
+        print(f"peak RSS: {base_rss} KB -> {cur_rss} KB ({cur_rss / base_rss - 1.0:+.1%})")
+
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,154 @@
+#include <benchmark/benchmark.h>
+#include <map>
+#include <graphviz/cgraph.h>
+#include "synthetic_codebase.h"
+#include "analysis/code_analyzer.h"
+#include "analysis/reachability_analyzer.h"
+#include "visualizer/diagram_generator.h"
+
+namespace cpp_diagram {
+
+// Friend of DiagramGenerator and CodeAnalyzer
+struct BenchmarkAccess {
+    static Agnode_t* createClassNode(DiagramGenerator& generator, Agraph_t* graph, const ClassInfo& classInfo) {
+        return generator.createClassNode(graph, classInfo);
+    }
+    static Agraph_t* createCallGraph(DiagramGenerator& generator, const std::vector<FunctionInfo>& functions) {
+        return generator.createCallGraph(functions);
+    }
+    static double calculateCoupling(CodeAnalyzer& analyzer, const ClassInfo& classInfo,
+                                    const std::vector<ClassInfo>& allClasses) {
+        return analyzer.calculateCoupling(classInfo, allClasses);
+    }
+};
+
+namespace {
+
+struct Fixture {
+    std::vector<ClassInfo> classes;
+    std::vector<FunctionInfo> functions;
+    std::vector<RelationshipInfo> relationships;
+};
+
+// In-memory models keyed by entity count, built once per process
+const Fixture& fixture(int64_t entities) {
+    static std::map<int64_t, Fixture> fixtures;
+    auto it = fixtures.find(entities);
+    if (it == fixtures.end()) {
+        SyntheticSpec spec;
+        spec.scaleToEntities(entities);
+        Fixture built;
+        SyntheticCodebase(spec).buildModel(built.classes, built.functions, built.relationships);
+        it = fixtures.emplace(entities, std::move(built)).first;
+    }
+    return it->second;
+}
+
+void BM_CreateClassNode(benchmark::State& state) {
+    const Fixture& model = fixture(state.range(0));
+    DiagramGenerator generator;
+    for (auto _ : state) {
+        Agraph_t* graph = agopen("ClassDiagram", Agdirected, nullptr);
+        for (const auto& classInfo : model.classes) {
+            benchmark::DoNotOptimize(BenchmarkAccess::createClassNode(generator, graph, classInfo));
+        }
+        agclose(graph);
+    }
+    state.SetItemsProcessed(state.iterations() * model.classes.size());
+    state.SetComplexityN(static_cast<int64_t>(model.classes.size()));
+}
+
+void BM_CreateCallGraph(benchmark::State& state) {
+    const Fixture& model = fixture(state.range(0));
+    DiagramGenerator generator;
+    int64_t calls = 0;
+    for (const auto& functionInfo : model.functions) {
+        calls += functionInfo.calledFunctions.size();
+    }
+    for (auto _ : state) {
+        Agraph_t* graph = BenchmarkAccess::createCallGraph(generator, model.functions);
+        benchmark::DoNotOptimize(graph);
+        agclose(graph);
+    }
+    state.SetItemsProcessed(state.iterations() * (model.functions.size() + calls));
+    state.SetComplexityN(static_cast<int64_t>(model.functions.size()));
+}
+
+void BM_CalculateCoupling(benchmark::State& state) {
+    const Fixture& model = fixture(state.range(0));
+    CodeAnalyzer analyzer;
+    size_t next = 0;
+    for (auto _ : state) {
+        const ClassInfo& classInfo = model.classes[next++ % model.classes.size()];
+        benchmark::DoNotOptimize(BenchmarkAccess::calculateCoupling(analyzer, classInfo, model.classes));
+    }
+    state.SetComplexityN(static_cast<int64_t>(model.classes.size()));
+}
+
+void BM_CalculateMetrics(benchmark::State& state) {
+    const Fixture& model = fixture(state.range(0));
+    CodeAnalyzer analyzer;
+    for (auto _ : state) {
+        for (const auto& classInfo : model.classes) {
+            benchmark::DoNotOptimize(analyzer.calculateMetrics(classInfo));
+        }
+        for (const auto& functionInfo : model.functions) {
+            benchmark::DoNotOptimize(analyzer.calculateMetrics(functionInfo));
+        }
+    }
+    int64_t entities = static_cast<int64_t>(model.classes.size() + model.functions.size());
+    state.SetItemsProcessed(state.iterations() * entities);
+    state.SetComplexityN(entities);
+}
+
+void BM_GenerateSummary(benchmark::State& state) {
+    const Fixture& model = fixture(state.range(0));
+    CodeAnalyzer analyzer;
+    CodeSummary summary = analyzer.analyzeCodebase(model.classes, model.functions, model.relationships);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(analyzer.generateSummary(summary, 3));
+    }
+    state.SetComplexityN(state.range(0));
+}
+
+void BM_AnalyzeCodebase(benchmark::State& state) {
+    const Fixture& model = fixture(state.range(0));
+    CodeAnalyzer analyzer;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(analyzer.analyzeCodebase(model.classes, model.functions, model.relationships));
+    }
+    int64_t entities = static_cast<int64_t>(model.classes.size() + model.functions.size());
+    state.SetItemsProcessed(state.iterations() * entities);
+    state.SetComplexityN(entities);
+}
+
+void BM_Reachability(benchmark::State& state) {
+    const Fixture& model = fixture(state.range(0));
+    ModelIndex index(model.classes, model.functions, model.relationships);
+    ReachabilityAnalyzer analyzer;
+    analyzer.setRoots({"synth::fn0"});
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(analyzer.analyze(index));
+    }
+    int64_t entities = static_cast<int64_t>(model.classes.size() + model.functions.size());
+    state.SetItemsProcessed(state.iterations() * entities);
+    state.SetComplexityN(entities);
+}
+
+// Fixture sizes in entities (classes + methods + functions)
+constexpr int64_t kSmallest = 100;
+constexpr int64_t kLargest = 100000;
+
+BENCHMARK(BM_CreateClassNode)->RangeMultiplier(10)->Range(kSmallest, kLargest)->Complexity();
+BENCHMARK(BM_CreateCallGraph)->RangeMultiplier(10)->Range(kSmallest, kLargest)->Complexity();
+BENCHMARK(BM_CalculateCoupling)->RangeMultiplier(10)->Range(kSmallest, kLargest)->Complexity();
+BENCHMARK(BM_CalculateMetrics)->RangeMultiplier(10)->Range(kSmallest, kLargest)->Complexity();
+BENCHMARK(BM_GenerateSummary)->RangeMultiplier(10)->Range(kSmallest, kLargest)->Complexity();
+BENCHMARK(BM_AnalyzeCodebase)->RangeMultiplier(10)->Range(kSmallest, kLargest)->Complexity();
+BENCHMARK(BM_Reachability)->RangeMultiplier(10)->Range(kSmallest, kLargest)->Complexity();
+
+} // namespace
+
+} // namespace cpp_diagram
+
+BENCHMARK_MAIN();
@@ -0,0 +1,198 @@
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include "bench_options.h"
+#include "parser/ast_parser.h"
+#include "visualizer/diagram_generator.h"
+#include "analysis/code_analyzer.h"
+#include "analysis/devirtualization_analyzer.h"
+#include "analysis/reachability_analyzer.h"
+#include "analysis/layout_analyzer.h"
+#include "analysis/model_index.h"
+#include "profiling/tracer.h"
+
+namespace fs = std::filesystem;
+using namespace cpp_diagram;
+
+namespace {
+
+// Tracer categories reported as benchmark stages, in pipeline order
+const char* kStages[] = {"generate", "clang", "extract", "analysis", "graph", "layout", "render"};
+
+long long modelEntities(const std::vector<ClassInfo>& classes, const std::vector<FunctionInfo>& functions) {
+    // Methods are also listed in functions, so classes + functions counts each once
+    return static_cast<long long>(classes.size() + functions.size());
+}
+
+std::string resultsJson(const std::string& mode, const SyntheticSpec& spec,
+                        const Tracer& tracer, const std::map<std::string, long long>& entities) {
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(3);
+    ss << "{\n";
+    ss << "  \"schema\": 1,\n";
+    ss << "  \"mode\": \"" << mode << "\",\n";
+    ss << "  \"spec\": {\"classes\": " << spec.classes << ", \"depth\": " << spec.hierarchyDepth
+       << ", \"methods\": " << spec.methodsPerClass << ", \"fields\": " << spec.fieldsPerClass
+       << ", \"functions\": " << spec.functions << ", \"calls\": " << spec.callsPerFunction
+       << ", \"templates\": " << spec.templateRatio << ", \"seed\": " << spec.seed
+       << ", \"entities\": " << spec.entityCount() << "},\n";
+    ss << "  \"stages\": {";
+
+    auto totals = tracer.categoryTotals();
+    bool first = true;
+    for (const char* stage : kStages) {
+        auto it = totals.find(stage);
+        if (it == totals.end()) continue;
+        long long count = entities.count(stage) ? entities.at(stage) : 0;
+        double wallMs = it->second.wallMicros / 1000.0;
+        double throughput = wallMs > 0 ? count / (wallMs / 1000.0) : 0.0;
+        ss << (first ? "\n" : ",\n");
+        ss << "    \"" << stage << "\": {\"wall_ms\": " << wallMs
+           << ", \"cpu_ms\": " << it->second.cpuMicros / 1000.0
+           << ", \"entities\": " << count
+           << ", \"throughput\": " << throughput << "}";
+        first = false;
+    }
+    ss << "\n  },\n";
+    ss << "  \"peak_rss_kb\": " << tracer.peakRssKb() << "\n";
+    ss << "}\n";
+    return ss.str();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    try {
+        cxxopts::Options options("cpp_diagram_pipeline_bench",
+                               "Benchmark the pipeline stages on a synthetic codebase");
+        options.add_options()
+            ("mode", "parse (generate sources and run clang) or model (build the model in memory)",
+             cxxopts::value<std::string>()->default_value("parse"))
+            ("w,workdir", "Directory for generated sources and diagrams",
+             cxxopts::value<std::string>()->default_value("bench_work"))
+            ("max-layout-nodes", "Largest graph handed to graphviz",
+             cxxopts::value<int>()->default_value("2000"))
+            ("f,format", "Output format for the render stage", cxxopts::value<std::string>()->default_value("svg"))
+            ("detail", "Node detail level for the diagram stages (1-3)", cxxopts::value<int>()->default_value("3"))
+            ("member-limit", "Members listed per class node before folding (0 for all)",
+             cxxopts::value<int>()->default_value("0"))
+            ("json", "Write results to this file instead of stdout", cxxopts::value<std::string>())
+            ("trace", "Also write a Chrome trace of the run", cxxopts::value<std::string>())
+            ("h,help", "Print usage");
+        addSpecOptions(options);
+
+        auto result = options.parse(argc, argv);
+        if (result.count("help")) {
+            std::cout << options.help() << std::endl;
+            return 0;
+        }
+
+        std::string mode = result["mode"].as<std::string>();
+        if (mode != "parse" && mode != "model") {
+            std::cerr << "Error: Unknown mode: " << mode << std::endl;
+            return 1;
+        }
+
+        SyntheticSpec spec = specFromOptions(result);
+        SyntheticCodebase codebase(spec);
+        fs::path workDir(result["workdir"].as<std::string>());
+        fs::create_directories(workDir);
+
+        Tracer tracer;
+        std::map<std::string, long long> entities;
+        std::vector<ClassInfo> classes;
+        std::vector<FunctionInfo> functions;
+        std::vector<RelationshipInfo> relationships;
+
+        if (mode == "parse") {
+            std::vector<std::string> files;
+            {
+                TraceScope scope(&tracer, "writeSources", "generate");
+                files = codebase.writeSources((workDir / "src").string());
+            }
+            ASTParser parser;
+            parser.setTracer(&tracer);
+            if (!parser.parseFiles(files)) {
+                std::cerr << "Error: Failed to parse generated sources" << std::endl;
+                return 1;
+            }
+            classes = parser.getClassInfo();
+            functions = parser.getFunctionInfo();
+            relationships = parser.getRelationships();
+            entities["clang"] = entities["extract"] = modelEntities(classes, functions);
+        } else {
+            TraceScope scope(&tracer, "buildModel", "generate");
+            codebase.buildModel(classes, functions, relationships);
+        }
+        entities["generate"] = entities["analysis"] = modelEntities(classes, functions);
+
+        {
+            TraceScope scope(&tracer, "analysis", "analysis");
+            CodeAnalyzer analyzer;
+            auto summary = analyzer.analyzeCodebase(classes, functions, relationships);
+            analyzer.generateSummary(summary, 2);
+
+            ModelIndex index(classes, functions, relationships);
+            DevirtualizationAnalyzer devirtualizer;
+            devirtualizer.analyze(index);
+
+            ReachabilityAnalyzer reachability;
+            reachability.setRoots({"synth::fn0"});
+            reachability.analyze(index);
+
+            LayoutAnalyzer layoutAnalyzer;
+            layoutAnalyzer.analyze(classes);
+        }
+
+        // Graphviz layout is superlinear; larger models are truncated so the
+        // run finishes, and throughput is reported per diagrammed node
+        size_t maxNodes = static_cast<size_t>(std::max(result["max-layout-nodes"].as<int>(), 1));
+        std::vector<ClassInfo> diagramClasses(classes.begin(),
+                                              classes.begin() + std::min(maxNodes, classes.size()));
+        std::vector<FunctionInfo> diagramFunctions(functions.begin(),
+                                                   functions.begin() + std::min(maxNodes, functions.size()));
+        entities["graph"] = entities["layout"] = entities["render"] =
+            static_cast<long long>(diagramClasses.size() + diagramFunctions.size());
+
+        DiagramGenerator diagramGenerator;
+        diagramGenerator.setTracer(&tracer);
+        diagramGenerator.setOutputFormat(result["format"].as<std::string>());
+        diagramGenerator.setDetailLevel(result["detail"].as<int>(),
+                                        static_cast<size_t>(std::max(result["member-limit"].as<int>(), 0)));
+        std::string format = "." + result["format"].as<std::string>();
+        if (!diagramGenerator.generateClassDiagram(diagramClasses, relationships,
+                                                   (workDir / ("class" + format)).string()) ||
+            !diagramGenerator.generateCallGraph(diagramFunctions, (workDir / ("call" + format)).string())) {
+            std::cerr << "Error: Failed to generate diagrams" << std::endl;
+            return 1;
+        }
+
+        std::string json = resultsJson(mode, spec, tracer, entities);
+        if (result.count("json")) {
+            std::ofstream out(result["json"].as<std::string>());
+            if (!out.is_open()) {
+                std::cerr << "Error: Cannot write " << result["json"].as<std::string>() << std::endl;
+                return 1;
+            }
+            out << json;
+        } else {
+            std::cout << json;
+        }
+
+        if (result.count("trace") && !tracer.writeChromeTrace(result["trace"].as<std::string>())) {
+            std::cerr << "Error: Cannot write trace file " << result["trace"].as<std::string>() << std::endl;
+            return 1;
+        }
+        return 0;
+
+    } catch (const cxxopts::OptionException& e) {
+        std::cerr << "Error parsing options: " << e.what() << std::endl;
+        return 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
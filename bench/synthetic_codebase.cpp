@@ -0,0 +1,245 @@
+#include "synthetic_codebase.h"
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+namespace cpp_diagram {
+
+namespace {
+
+// SplitMix64: cheap, stateless and identical on every platform
+uint64_t mix(uint64_t value) {
+    value += 0x9e3779b97f4a7c15ULL;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+}
+
+uint64_t hashOf(unsigned seed, uint64_t a, uint64_t b = 0) {
+    return mix(mix(seed ^ (a * 0x100000001b3ULL)) ^ b);
+}
+
+std::string className(int index) { return "C" + std::to_string(index); }
+std::string functionName(int index) { return "fn" + std::to_string(index); }
+
+const char* fieldType(int field) {
+    static const char* types[] = {"int", "double", "char", "long"};
+    return types[field % 4];
+}
+
+} // namespace
+
+void SyntheticSpec::scaleToEntities(long long entities) {
+    entities = std::max(entities, 10LL);
+    functions = static_cast<int>(entities / 10);
+    classes = static_cast<int>(std::max(1LL, (entities - functions) / (1 + methodsPerClass)));
+}
+
+long long SyntheticSpec::entityCount() const {
+    return static_cast<long long>(classes) * (1 + methodsPerClass) + functions;
+}
+
+SyntheticCodebase::SyntheticCodebase(const SyntheticSpec& spec) : spec_(spec) {
+    spec_.classes = std::max(spec_.classes, 1);
+    spec_.classesPerFile = std::max(spec_.classesPerFile, 1);
+    spec_.hierarchyDepth = std::max(spec_.hierarchyDepth, 0);
+}
+
+bool SyntheticCodebase::isTemplate(int classIndex) const {
+    return (hashOf(spec_.seed, classIndex, 1) % 1000) < spec_.templateRatio * 1000;
+}
+
+int SyntheticCodebase::baseOf(int classIndex) const {
+    // Chains of hierarchyDepth + 1 consecutive classes, never across files
+    int level = classIndex % (spec_.hierarchyDepth + 1);
+    if (level == 0 || fileOf(classIndex - 1) != fileOf(classIndex)) {
+        return -1;
+    }
+    return classIndex - 1;
+}
+
+std::vector<int> SyntheticCodebase::calleesOf(int functionIndex) const {
+    std::vector<int> callees;
+    if (spec_.functions <= 1) {
+        return callees;
+    }
+    for (int call = 0; call < spec_.callsPerFunction; ++call) {
+        int callee = static_cast<int>(hashOf(spec_.seed, functionIndex, 100 + call) % spec_.functions);
+        if (callee != functionIndex) {
+            callees.push_back(callee);
+        }
+    }
+    return callees;
+}
+
+std::string SyntheticCodebase::sourceFor(int file) const {
+    std::stringstream ss;
+    int files = (spec_.classes + spec_.classesPerFile - 1) / spec_.classesPerFile;
+    int firstClass = file * spec_.classesPerFile;
+    int lastClass = std::min(spec_.classes, firstClass + spec_.classesPerFile);
+    int functionsPerFile = (spec_.functions + files - 1) / files;
+    int firstFunction = file * functionsPerFile;
+    int lastFunction = std::min(spec_.functions, firstFunction + functionsPerFile);
+
+    ss << "// Generated by cpp_diagram_codegen; do not edit\n";
+    ss << "namespace synth {\n\n";
+
+    // Prototypes for every function called from this file
+    std::set<int> prototypes;
+    for (int f = firstFunction; f < lastFunction; ++f) {
+        for (int callee : calleesOf(f)) prototypes.insert(callee);
+    }
+    for (int callee : prototypes) {
+        ss << "int " << functionName(callee) << "(int x);\n";
+    }
+    ss << "\n";
+
+    for (int c = firstClass; c < lastClass; ++c) {
+        int base = baseOf(c);
+        bool templated = isTemplate(c);
+        if (templated) {
+            ss << "template<typename T>\n";
+        }
+        ss << "class " << className(c);
+        if (base >= 0) {
+            ss << " : public " << className(base);
+            if (isTemplate(base)) ss << (templated ? "<T>" : "<int>");
+        }
+        ss << " {\npublic:\n";
+        ss << "    virtual ~" << className(c) << "() = default;\n";
+        for (int m = 0; m < spec_.methodsPerClass; ++m) {
+            ss << "    virtual int m" << m << "(int x) { return x + " << m << "; }\n";
+        }
+        ss << "\nprivate:\n";
+        for (int field = 0; field < spec_.fieldsPerClass; ++field) {
+            ss << "    " << (templated && field == 0 ? "T" : fieldType(field))
+               << " f" << field << "_{};\n";
+        }
+        ss << "};\n\n";
+    }
+
+    for (int f = firstFunction; f < lastFunction; ++f) {
+        ss << "int " << functionName(f) << "(int x) {\n";
+        ss << "    int r = x;\n";
+        for (int callee : calleesOf(f)) {
+            ss << "    r += " << functionName(callee) << "(r);\n";
+        }
+        if (lastClass > firstClass) {
+            int target = firstClass + static_cast<int>(hashOf(spec_.seed, f, 2) % (lastClass - firstClass));
+            ss << "    " << className(target) << (isTemplate(target) ? "<int>" : "")
+               << " object;\n";
+            ss << "    r += object.m0(r);\n";
+        }
+        ss << "    return r;\n}\n\n";
+    }
+
+    ss << "} // namespace synth\n";
+    return ss.str();
+}
+
+std::vector<std::string> SyntheticCodebase::writeSources(const std::string& directory) const {
+    fs::create_directories(directory);
+    std::vector<std::string> files;
+    int fileCount = (spec_.classes + spec_.classesPerFile - 1) / spec_.classesPerFile;
+    for (int file = 0; file < fileCount; ++file) {
+        fs::path path = fs::path(directory) / ("synth_" + std::to_string(file) + ".cpp");
+        std::ofstream out(path);
+        out << sourceFor(file);
+        files.push_back(path.string());
+    }
+    return files;
+}
+
+void SyntheticCodebase::buildModel(std::vector<ClassInfo>& classes,
+                                   std::vector<FunctionInfo>& functions,
+                                   std::vector<RelationshipInfo>& relationships) const {
+    classes.reserve(classes.size() + spec_.classes);
+    for (int c = 0; c < spec_.classes; ++c) {
+        ClassInfo classInfo;
+        classInfo.name = className(c);
+        classInfo.qualifiedName = "synth::" + classInfo.name;
+        classInfo.isTemplate = isTemplate(c);
+        if (classInfo.isTemplate) {
+            classInfo.templateParameters.push_back("T");
+        }
+
+        int base = baseOf(c);
+        if (base >= 0) {
+            classInfo.baseClasses.push_back("synth::" + className(base));
+            RelationshipInfo relationship;
+            relationship.fromClass = classInfo.qualifiedName;
+            relationship.toClass = classInfo.baseClasses.back();
+            relationship.type = RelationshipType::Inheritance;
+            relationships.push_back(relationship);
+        }
+
+        for (int m = 0; m < spec_.methodsPerClass; ++m) {
+            MethodInfo method;
+            method.name = "m" + std::to_string(m);
+            method.qualifiedName = classInfo.qualifiedName + "::" + method.name;
+            method.returnType = "int";
+            method.parameters.push_back("int");
+            method.parameterRecordTypes.push_back("");
+            method.isVirtual = true;
+            method.isOverride = base >= 0;
+            classInfo.methods.push_back(method);
+            functions.push_back(method);
+        }
+
+        int64_t offset = 8;  // vtable pointer
+        for (int field = 0; field < spec_.fieldsPerClass; ++field) {
+            FieldInfo fieldInfo;
+            fieldInfo.name = "f" + std::to_string(field) + "_";
+            fieldInfo.type = classInfo.isTemplate && field == 0 ? "T" : fieldType(field);
+            fieldInfo.access = AccessSpecifier::Private;
+            if (!classInfo.isTemplate) {
+                int64_t size = fieldInfo.type == "char" ? 1 : fieldInfo.type == "int" ? 4 : 8;
+                offset = (offset + size - 1) / size * size;
+                fieldInfo.offset = offset;
+                fieldInfo.size = size;
+                fieldInfo.alignment = size;
+                offset += size;
+            }
+            classInfo.fields.push_back(fieldInfo);
+        }
+        if (!classInfo.isTemplate) {
+            classInfo.hasLayout = true;
+            classInfo.alignment = 8;
+            classInfo.fieldsStart = 8;
+            classInfo.size = (offset + 7) / 8 * 8;
+        }
+
+        classes.push_back(std::move(classInfo));
+    }
+
+    functions.reserve(functions.size() + spec_.functions);
+    int files = (spec_.classes + spec_.classesPerFile - 1) / spec_.classesPerFile;
+    int functionsPerFile = (spec_.functions + files - 1) / files;
+    for (int f = 0; f < spec_.functions; ++f) {
+        FunctionInfo functionInfo;
+        functionInfo.name = functionName(f);
+        functionInfo.qualifiedName = "synth::" + functionInfo.name;
+        functionInfo.returnType = "int";
+        functionInfo.parameters.push_back("int");
+        functionInfo.parameterRecordTypes.push_back("");
+        for (int callee : calleesOf(f)) {
+            functionInfo.calledFunctions.push_back("synth::" + functionName(callee));
+        }
+
+        int file = f / std::max(functionsPerFile, 1);
+        int firstClass = file * spec_.classesPerFile;
+        int lastClass = std::min(spec_.classes, firstClass + spec_.classesPerFile);
+        if (lastClass > firstClass) {
+            int target = firstClass + static_cast<int>(hashOf(spec_.seed, f, 2) % (lastClass - firstClass));
+            functionInfo.calledFunctions.push_back("synth::" + className(target) + "::m0");
+        }
+        functions.push_back(std::move(functionInfo));
+    }
+}
+
+} // namespace cpp_diagram
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "parser/ast_types.h"
+
+namespace cpp_diagram {
+
+// Shape of a generated codebase. Everything is derived deterministically
+// from the seed, so two runs with the same spec produce identical input.
+struct SyntheticSpec {
+    int classes = 100;
+    int hierarchyDepth = 3;      // longest base-class chain
+    int methodsPerClass = 4;
+    int fieldsPerClass = 3;
+    int functions = 100;         // free functions
+    int callsPerFunction = 3;    // call density
+    double templateRatio = 0.1;  // fraction of classes that are templates
+    int classesPerFile = 64;
+    unsigned seed = 42;
+
+    // Size the spec so the model holds roughly this many classes, methods
+    // and functions
+    void scaleToEntities(long long entities);
+
+    long long entityCount() const;
+};
+
+class SyntheticCodebase {
+public:
+    explicit SyntheticCodebase(const SyntheticSpec& spec);
+
+    // Write the codebase as C++ sources; returns the files written
+    std::vector<std::string> writeSources(const std::string& directory) const;
+
+    // Build the model the parser would extract, without running clang
+    void buildModel(std::vector<ClassInfo>& classes,
+                    std::vector<FunctionInfo>& functions,
+                    std::vector<RelationshipInfo>& relationships) const;
+
+private:
+    int fileOf(int classIndex) const { return classIndex / spec_.classesPerFile; }
+    bool isTemplate(int classIndex) const;
+    int baseOf(int classIndex) const;  // -1 for hierarchy roots
+    std::vector<int> calleesOf(int functionIndex) const;
+    std::string sourceFor(int file) const;
+
+    SyntheticSpec spec_;
+};
+
+} // namespace cpp_diagram
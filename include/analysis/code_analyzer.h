@@ -3,7 +3,8 @@
 #include <string>
 #include <vector>
 #include <memory>
-#include "parser/ast_parser.h"
+#include "parser/ast_types.h"
+#include "analysis/pattern_engine.h"
 
 namespace cpp_diagram {
 
@@ -36,7 +37,8 @@ public:
 
     // Analyze the entire codebase
     CodeSummary analyzeCodebase(const std::vector<ClassInfo>& classes,
-                              const std::vector<FunctionInfo>& functions);
+                              const std::vector<FunctionInfo>& functions,
+                              const std::vector<RelationshipInfo>& relationships);
 
     // Generate natural language summary
     std::string generateSummary(const CodeSummary& summary, int detailLevel);
@@ -46,6 +48,9 @@ public:
     CodeMetrics calculateMetrics(const FunctionInfo& functionInfo);
 
 private:
+    // Microbenchmarks reach the private helpers through this
+    friend struct BenchmarkAccess;
+
     // Helper methods for analysis
     std::vector<std::string> identifyDesignPatterns(const ClassInfo& classInfo);
     std::vector<std::string> identifyAlgorithms(const FunctionInfo& functionInfo);
@@ -61,6 +66,8 @@ private:
     std::string generateFunctionSummary(const FunctionInfo& functionInfo,
                                       const CodeMetrics& metrics,
                                       int detailLevel);
+
+    PatternEngine patternEngine_;
 };
 
 } // namespace cpp_diagram 
\ No newline at end of file
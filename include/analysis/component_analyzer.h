@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "parser/ast_types.h"
+
+namespace cpp_diagram {
+
+struct Component {
+    std::string name;
+    int classes = 0;
+    int functions = 0;
+    int layer = -1;   // index into the configured layers, -1 if unassigned
+    size_t cycle = 0; // strongly connected component id
+};
+
+// Class relationships and calls from one component into another
+struct ComponentDependency {
+    size_t from = 0;
+    size_t to = 0;
+    int relationships = 0;
+    int calls = 0;
+    bool inCycle = false;
+    bool violatesLayering = false;  // a lower layer reaching up
+
+    int weight() const { return relationships + calls; }
+};
+
+struct ComponentGraph {
+    std::vector<Component> components;
+    std::vector<ComponentDependency> dependencies;
+    std::vector<std::vector<size_t>> cycles;  // component ids of each cycle
+};
+
+// Rolls the class-level model up into components, taken from the source
+// directory or the namespace of each class and function
+class ComponentAnalyzer {
+public:
+    ComponentAnalyzer();
+    ~ComponentAnalyzer();
+
+    // "directory" or "namespace"; depth keeps that many leading path or
+    // namespace parts (0 keeps all of them). Directories are taken relative
+    // to the working directory when they are inside it.
+    bool setGrouping(const std::string& grouping, int depth);
+
+    // Layers from top to bottom, matched as component name prefixes; a
+    // component may only depend on its own layer and the ones below it
+    void setLayers(const std::vector<std::string>& layers);
+
+    ComponentGraph analyze(const std::vector<ClassInfo>& classes,
+                           const std::vector<FunctionInfo>& functions,
+                           const std::vector<RelationshipInfo>& relationships) const;
+
+    // Render a human-readable report of dependencies, cycles and violations
+    std::string generateReport(const ComponentGraph& graph) const;
+
+private:
+    // Component of an entity from its source file or its qualified name
+    std::string componentName(const std::string& file, const std::string& qualifiedName) const;
+
+    bool byNamespace_ = false;
+    int depth_ = 0;
+    std::vector<std::string> layers_;
+};
+
+} // namespace cpp_diagram
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "parser/ast_types.h"
+#include "analysis/layout_analyzer.h"
+
+namespace cpp_diagram {
+
+struct ConcurrencyField {
+    std::string name;
+    std::string type;
+    int64_t offset = 0;
+    int64_t size = 0;
+    SyncKind sync = SyncKind::None;
+    int writeSites = 0;
+    bool isContended = false;  // a synchronization member or frequently written
+    int64_t firstLine = 0;     // cache lines the field covers
+    int64_t lastLine = 0;
+};
+
+// Two contended fields on one cache line, at least one of them a
+// synchronization member
+struct SharingConflict {
+    size_t first = 0;  // indices into ConcurrencyLayout::fields
+    size_t second = 0;
+    int64_t cacheLine = 0;
+};
+
+struct ConcurrencyLayout {
+    std::string className;
+    int64_t size = 0;
+    int syncMembers = 0;
+    std::vector<ConcurrencyField> fields;  // in offset order
+    std::vector<SharingConflict> conflicts;
+    std::vector<size_t> splitFields;  // synchronization members straddling two lines
+};
+
+// Finds false sharing from record layouts: atomics, mutexes and condition
+// variables that share a cache line with each other or with fields the
+// code writes often
+class ConcurrencyAnalyzer {
+public:
+    static constexpr int64_t kCacheLineSize = LayoutAnalyzer::kCacheLineSize;
+
+    ConcurrencyAnalyzer();
+    ~ConcurrencyAnalyzer();
+
+    // Fields written at this many sites count as frequently written
+    void setWriteThreshold(int sites);
+
+    // Every class with a synchronization member and a layout, most
+    // conflicts first. Write sites are counted over the function bodies.
+    std::vector<ConcurrencyLayout> analyze(const std::vector<ClassInfo>& classes,
+                                           const std::vector<FunctionInfo>& functions) const;
+
+    // Render a human-readable report
+    std::string generateReport(const std::vector<ConcurrencyLayout>& layouts) const;
+
+    static const char* syncName(SyncKind sync);
+
+private:
+    int writeThreshold_ = 2;
+};
+
+} // namespace cpp_diagram
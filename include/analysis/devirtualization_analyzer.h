@@ -0,0 +1,60 @@
+#pragma once
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "analysis/model_index.h"
+
+namespace cpp_diagram {
+
+enum class DevirtualizationKind {
+    SingleImplementation,  // every call through the base reaches one override
+    NeverOverridden,       // virtual method no subclass overrides
+    FinalClass             // leaf class with virtual methods not marked final
+};
+
+struct DevirtualizationCandidate {
+    DevirtualizationKind kind;
+    std::string className;
+    std::string method;          // qualified method name, empty for FinalClass
+    std::string implementation;  // the only reachable override, if any
+    int callSites = 0;
+    int hotCallSites = 0;
+    std::vector<std::string> hotCallers;
+    double score = 0.0;
+};
+
+// Shape of the inheritance DAG the candidates were derived from
+struct HierarchyStats {
+    int classes = 0;
+    int roots = 0;
+    int maxDepth = 0;
+    int virtualMethods = 0;
+};
+
+class DevirtualizationAnalyzer {
+public:
+    DevirtualizationAnalyzer();
+    ~DevirtualizationAnalyzer();
+
+    // Functions whose call sites weigh more when ranking candidates
+    void setHotFunctions(const std::vector<std::string>& hotFunctions);
+
+    // Find devirtualization opportunities, best first
+    std::vector<DevirtualizationCandidate> analyze(const ModelIndex& index) const;
+
+    // Summarize the inheritance DAG
+    HierarchyStats hierarchyStats(const ModelIndex& index) const;
+
+    // Render a ranked, human-readable report
+    std::string generateReport(const std::vector<DevirtualizationCandidate>& candidates,
+                               const HierarchyStats& stats) const;
+
+private:
+    void countCallSites(const ModelIndex& index,
+                        std::vector<DevirtualizationCandidate>& candidates) const;
+
+    std::unordered_set<std::string> hotFunctions_;
+};
+
+} // namespace cpp_diagram
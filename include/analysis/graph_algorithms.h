@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace cpp_diagram {
+
+// Strongly connected component of every node, numbered so that each edge
+// leaving a component points to a lower number (successors first)
+std::vector<size_t> stronglyConnected(const std::vector<std::vector<size_t>>& adjacency);
+
+} // namespace cpp_diagram
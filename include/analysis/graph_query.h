@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "analysis/model_index.h"
+#include "parser/ast_types.h"
+
+namespace cpp_diagram {
+
+enum class QueryTarget {
+    Classes,
+    Functions
+};
+
+// True if text matches a pattern where "*" stands for any run of characters
+bool globMatch(const std::string& pattern, const std::string& text);
+
+// Canonical class or function ids (see ModelIndex) that matched, in model order
+struct QueryResult {
+    QueryTarget target = QueryTarget::Classes;
+    std::vector<size_t> ids;
+};
+
+// A small query language over the model:
+//
+//   query      := ("classes" | "functions") ["where" condition]
+//   condition  := conjunct {"or" conjunct}
+//   conjunct   := factor {"and" factor}
+//   factor     := "not" factor | "(" condition ")" | flag
+//               | attribute op value | relation "(" name ")"
+//   op         := "=" | "!=" | "<" | "<=" | ">" | ">=" | "~"
+//
+// e.g. classes where derives(Shape) and calls(Logger::log)
+//      functions where reachable_from(main) and calls > 3
+//
+// "~" matches a glob with "*" or else a substring; names may be quoted and
+// relation arguments may be globs. Graph relations are evaluated once per
+// query as sets over the index's hierarchy and call adjacency, so a query
+// costs one pass over the model plus one traversal per relation.
+class GraphQuery {
+public:
+    GraphQuery();
+    ~GraphQuery();
+
+    // Parse a query; on failure error() says what is wrong and where
+    bool compile(const std::string& text);
+    const std::string& error() const { return error_; }
+    QueryTarget target() const { return target_; }
+
+    QueryResult run(const ModelIndex& index) const;
+
+    // Restrict a model to a result so any diagram can be drawn from it.
+    // Classes keep their methods as functions; functions keep the classes
+    // that own them. Relationships are kept between the remaining classes.
+    static void select(const ModelIndex& index, const QueryResult& result,
+                       std::vector<ClassInfo>& classes, std::vector<FunctionInfo>& functions,
+                       std::vector<RelationshipInfo>& relationships);
+
+    // Render the query and the qualified names it matched
+    std::string generateReport(const ModelIndex& index, const QueryResult& result) const;
+
+    // Attribute, flag and relation names the language accepts for a target
+    static std::vector<std::string> attributes(QueryTarget target);
+    static std::vector<std::string> flags(QueryTarget target);
+    static std::vector<std::string> relations(QueryTarget target);
+
+private:
+    enum class NodeKind { And, Or, Not, Compare, Flag, Relation };
+
+    struct Node {
+        NodeKind kind = NodeKind::Flag;
+        size_t left = 0;
+        size_t right = 0;
+        std::string name;  // attribute, flag or relation
+        int code = 0;      // attribute or flag, resolved once when compiled
+        int op = 0;        // comparison, likewise
+        std::string value;
+        int64_t number = 0;
+        bool numeric = false;
+        bool glob = false;  // value has a "*"
+        size_t depth = 1;   // height of the subtree rooted here
+    };
+
+    struct Token;
+
+    // Recursive descent over the tokens; each returns the index of the node
+    // it added, or npos after setting error_
+    size_t parseOr(const std::vector<Token>& tokens, size_t& pos);
+    size_t parseAnd(const std::vector<Token>& tokens, size_t& pos);
+    size_t parseFactor(const std::vector<Token>& tokens, size_t& pos);
+    size_t fail(const Token& token, const std::string& message);
+
+    // Relations as one membership mask per node, then the condition per id
+    std::vector<std::vector<char>> evaluateRelations(const ModelIndex& index) const;
+    bool matches(const ModelIndex& index, size_t id, size_t node,
+                 const std::vector<std::vector<char>>& relationMasks) const;
+
+    std::string text_;
+    std::string error_;
+    QueryTarget target_ = QueryTarget::Classes;
+    std::vector<Node> nodes_;
+    size_t root_ = 0;
+    size_t nesting_ = 0;  // open "(" and "not" while parsing
+    bool hasCondition_ = false;
+};
+
+} // namespace cpp_diagram
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "parser/ast_types.h"
+
+namespace cpp_diagram {
+
+struct HeaderCost {
+    const HeaderInfo* header;
+    double share;  // inclusive tokens as a fraction of all tokens parsed
+    int64_t fanIn = 0;  // files that include it, directly or through other headers
+};
+
+class IncludeAnalyzer {
+public:
+    IncludeAnalyzer();
+    ~IncludeAnalyzer();
+
+    // Rank headers by the parse cost they bring into every TU, costliest first
+    std::vector<HeaderCost> rankHeaders(const std::vector<HeaderInfo>& headers) const;
+
+    // Render a human-readable report of the top headers
+    std::string generateReport(const std::vector<HeaderInfo>& headers, size_t limit) const;
+};
+
+} // namespace cpp_diagram
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "parser/ast_types.h"
+
+namespace cpp_diagram {
+
+enum class LayoutSlotKind {
+    Header,   // vtable pointer and base class subobjects
+    Field,
+    VirtualBase,  // placed after the fields, not padding
+    Padding
+};
+
+struct LayoutSlot {
+    LayoutSlotKind kind;
+    std::string name;
+    std::string type;
+    int64_t offset = 0;
+    int64_t size = 0;
+    bool straddlesCacheLine = false;
+};
+
+struct ClassLayout {
+    std::string className;
+    int64_t size = 0;
+    int64_t alignment = 0;
+    int64_t paddingBytes = 0;
+    int cacheLines = 0;
+    std::vector<LayoutSlot> slots;  // in offset order, padding made explicit
+
+    // Field order that minimizes size, only filled in if it saves bytes
+    std::vector<std::string> suggestedOrder;
+    int64_t suggestedSize = 0;
+};
+
+class LayoutAnalyzer {
+public:
+    static constexpr int64_t kCacheLineSize = 64;
+
+    LayoutAnalyzer();
+    ~LayoutAnalyzer();
+
+    // Analyze one class; returns false if the parser captured no layout
+    bool analyzeClass(const ClassInfo& classInfo, ClassLayout& layout) const;
+
+    // Analyze every class with a layout, worst padding first
+    std::vector<ClassLayout> analyze(const std::vector<ClassInfo>& classes) const;
+
+    // Render a human-readable report
+    std::string generateReport(const std::vector<ClassLayout>& layouts) const;
+
+private:
+    void suggestReordering(const ClassInfo& classInfo, ClassLayout& layout) const;
+};
+
+} // namespace cpp_diagram
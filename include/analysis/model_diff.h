@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "parser/ast_types.h"
+
+namespace cpp_diagram {
+
+// Unchanged entries are only kept as one-hop context around the changes
+enum class ChangeKind {
+    Added,
+    Removed,
+    Modified,
+    Unchanged
+};
+
+struct EntityChange {
+    ChangeKind kind = ChangeKind::Unchanged;
+    std::string name;                  // qualified name
+    std::string parameters;            // "(int, bool)" for methods and functions
+    std::string owner;                 // owning class of a method
+    std::vector<std::string> details;  // what changed in a modified entity, e.g. "bases"
+};
+
+struct EdgeChange {
+    ChangeKind kind = ChangeKind::Unchanged;
+    std::string from;
+    std::string to;
+    std::string label;
+};
+
+// Architectural difference between a base and a head model
+struct ModelDiff {
+    std::vector<EntityChange> classes;
+    std::vector<EntityChange> methods;
+    std::vector<EntityChange> functions;  // free functions, plus callers and callees as context
+    std::vector<EdgeChange> relationships;
+    std::vector<EdgeChange> calls;
+
+    // Number of entries that are not context
+    size_t changeCount() const;
+};
+
+// Compares two models through per-entity signature hashes. Entities are
+// matched by qualified name (methods and functions also by parameters),
+// so a comparison takes time linear in the size of both models.
+class ModelDiffer {
+public:
+    ModelDiffer();
+    ~ModelDiffer();
+
+    ModelDiff compare(const std::vector<ClassInfo>& baseClasses,
+                      const std::vector<FunctionInfo>& baseFunctions,
+                      const std::vector<RelationshipInfo>& baseRelationships,
+                      const std::vector<ClassInfo>& headClasses,
+                      const std::vector<FunctionInfo>& headFunctions,
+                      const std::vector<RelationshipInfo>& headRelationships) const;
+
+    // Render a human-readable list of the changes
+    std::string generateReport(const ModelDiff& diff) const;
+
+    // Parameter list that tells overloads apart, e.g. "(int, bool)"
+    static std::string parameterList(const FunctionInfo& function);
+};
+
+} // namespace cpp_diagram
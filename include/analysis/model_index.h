@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "parser/ast_types.h"
+
+namespace cpp_diagram {
+
+// Read-only lookup structure over a parsed model. Classes and functions are
+// addressed by dense ids (their position in the input vectors); the index
+// keeps references to those vectors, so they must outlive it.
+class ModelIndex {
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    // A method addressed by its owning class and position in ClassInfo::methods
+    struct MethodRef {
+        size_t classId;
+        size_t methodIndex;
+    };
+
+    ModelIndex(const std::vector<ClassInfo>& classes,
+               const std::vector<FunctionInfo>& functions,
+               const std::vector<RelationshipInfo>& relationships);
+
+    // Class lookup
+    size_t classCount() const { return classes_.size(); }
+    const ClassInfo& classAt(size_t id) const { return classes_[id]; }
+    size_t findClass(const std::string& qualifiedName) const;
+
+    // Function lookup
+    size_t functionCount() const { return functions_.size(); }
+    const FunctionInfo& functionAt(size_t id) const { return functions_[id]; }
+    size_t findFunction(const std::string& qualifiedName) const;
+
+    // Classes and functions defined in headers repeat once per TU; only the
+    // first copy, the one find*() returns, is canonical
+    bool isCanonicalClass(size_t id) const { return canonicalClasses_[id] != 0; }
+    bool isCanonicalFunction(size_t id) const { return canonicalFunctions_[id] != 0; }
+
+    // Class declaring a canonical function as a method, npos for free functions
+    size_t ownerClass(size_t functionId) const { return owners_[functionId]; }
+
+    // Method lookup by qualified name; overloads share a name, so every
+    // declaration is returned
+    const std::vector<MethodRef>& findMethods(const std::string& qualifiedName) const;
+    const MethodInfo& methodAt(const MethodRef& ref) const {
+        return classes_[ref.classId].methods[ref.methodIndex];
+    }
+
+    // Relationship lookup
+    size_t relationshipCount() const { return relationships_.size(); }
+    const RelationshipInfo& relationshipAt(size_t index) const { return relationships_[index]; }
+
+    // Adjacency over the class hierarchy and relationship graph
+    const std::vector<size_t>& baseClasses(size_t id) const { return bases_[id]; }
+    const std::vector<size_t>& derivedClasses(size_t id) const { return derived_[id]; }
+    const std::vector<size_t>& outgoingRelationships(size_t id) const { return outgoing_[id]; }
+    const std::vector<size_t>& incomingRelationships(size_t id) const { return incoming_[id]; }
+
+    // Contiguous run of ids in a flat adjacency array
+    struct IdRange {
+        const size_t* first;
+        const size_t* last;
+        const size_t* begin() const { return first; }
+        const size_t* end() const { return last; }
+        size_t size() const { return static_cast<size_t>(last - first); }
+        bool empty() const { return first == last; }
+    };
+
+    // Call graph between canonical function ids (the ones findFunction
+    // returns); calls made by every copy of a function are merged. Stored
+    // as offsets into one array per direction so traversals stay in cache.
+    IdRange callees(size_t id) const {
+        return {calleeIds_.data() + calleeOffsets_[id], calleeIds_.data() + calleeOffsets_[id + 1]};
+    }
+    IdRange callers(size_t id) const {
+        return {callerIds_.data() + callerOffsets_[id], callerIds_.data() + callerOffsets_[id + 1]};
+    }
+
+    // True if baseId is a direct or indirect base of id
+    bool isSubclassOf(size_t id, size_t baseId) const;
+
+    // Overriders match on name, parameter types and constness
+    static std::string signature(const MethodInfo& method);
+
+private:
+    const std::vector<ClassInfo>& classes_;
+    const std::vector<FunctionInfo>& functions_;
+    const std::vector<RelationshipInfo>& relationships_;
+
+    std::unordered_map<std::string, size_t> classIds_;
+    std::unordered_map<std::string, size_t> functionIds_;
+    std::unordered_map<std::string, std::vector<MethodRef>> methodIds_;
+    std::vector<char> canonicalClasses_;
+    std::vector<char> canonicalFunctions_;
+    std::vector<size_t> owners_;
+    std::vector<std::vector<size_t>> bases_;
+    std::vector<std::vector<size_t>> derived_;
+    std::vector<std::vector<size_t>> outgoing_;
+    std::vector<std::vector<size_t>> incoming_;
+    std::vector<size_t> calleeOffsets_;
+    std::vector<size_t> calleeIds_;
+    std::vector<size_t> callerOffsets_;
+    std::vector<size_t> callerIds_;
+};
+
+} // namespace cpp_diagram
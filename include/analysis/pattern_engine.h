@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "analysis/model_index.h"
+
+namespace cpp_diagram {
+
+// Structural facts about a class, computed once per class before any rule
+// is evaluated. Rules state which facts they need as a bitmask.
+enum ClassFeature : uint32_t {
+    FeatureAbstract              = 1u << 0,
+    FeatureNonPublicConstructors = 1u << 1,  // declares constructors, none callable from outside
+    FeatureStaticSelfInstance    = 1u << 2,  // static field or accessor of its own type
+    FeatureVisitorInterface      = 1u << 3,  // two or more virtual visit(Element) style methods
+    FeatureAggregatesBase        = 1u << 4,  // holds a collection of one of its own bases
+    FeatureCrtpBase              = 1u << 5,  // derives from a template instantiated with itself
+    FeatureOpaqueImpl            = 1u << 6,  // private pointer to a nested or undefined Impl
+    FeatureCreatesAbstract       = 1u << 7,  // static method returning an abstract class
+    FeatureObserverRegistry      = 1u << 8   // holds a collection of an abstract class it accepts
+};
+
+struct PatternMatch {
+    std::string pattern;
+    std::string className;
+    std::vector<std::string> participants;
+};
+
+struct PatternRule {
+    std::string name;
+    uint32_t requiredFeatures = 0;
+
+    // Optional structural check run only on classes that have all required
+    // features; fills in the participants of the match
+    std::function<bool(const ModelIndex&, size_t, PatternMatch&)> verify;
+};
+
+class PatternEngine {
+public:
+    PatternEngine();
+    ~PatternEngine();
+
+    // Register an additional rule
+    void addRule(PatternRule rule);
+
+    // Classify every class in the model in a single pass
+    std::vector<PatternMatch> classify(const ModelIndex& index) const;
+
+    // Compute the feature bitmask of every class in the model
+    std::vector<uint32_t> computeFeatures(const ModelIndex& index) const;
+
+private:
+    uint32_t classFeatures(const ModelIndex& index, size_t id) const;
+
+    std::vector<PatternRule> rules_;
+};
+
+} // namespace cpp_diagram
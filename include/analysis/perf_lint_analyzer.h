@@ -0,0 +1,47 @@
+#pragma once
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "parser/ast_types.h"
+
+namespace cpp_diagram {
+
+// One finding with the function or class it was attached to
+struct PerfLintEntry {
+    PerfFinding finding;
+    std::string owner;  // qualified function or class name
+    std::string file;
+    bool isClass = false;
+    bool isHot = false;
+};
+
+// Collects the perf lint findings the parser attached to the model
+class PerfLintAnalyzer {
+public:
+    PerfLintAnalyzer();
+    ~PerfLintAnalyzer();
+
+    // Findings in these functions come first. Once set, std::function
+    // parameters are only reported for them, since the indirection only
+    // matters on hot paths.
+    void setHotFunctions(const std::vector<std::string>& hotFunctions);
+
+    // Distinct findings, hot ones first, then by file and line
+    std::vector<PerfLintEntry> analyze(const std::vector<ClassInfo>& classes,
+                                       const std::vector<FunctionInfo>& functions) const;
+
+    // Render a human-readable list of the findings
+    std::string generateReport(const std::vector<PerfLintEntry>& entries) const;
+
+    // Render the findings as JSON for editors and CI checks
+    std::string generateJson(const std::vector<PerfLintEntry>& entries) const;
+
+    // Stable identifier of a check, e.g. "allocation-in-loop"
+    static const char* issueName(PerfIssue issue);
+
+private:
+    std::unordered_set<std::string> hotFunctions_;
+};
+
+} // namespace cpp_diagram
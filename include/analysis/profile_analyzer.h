@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include "parser/ast_types.h"
+
+namespace cpp_diagram {
+
+struct FunctionCost {
+    int64_t selfSamples = 0;       // samples with the function on top of the stack
+    int64_t inclusiveSamples = 0;  // samples with the function anywhere on the stack
+};
+
+// Sampled costs mapped onto the model's qualified function names
+struct ProfileData {
+    int64_t totalSamples = 0;
+    int64_t unmatchedSamples = 0;  // stacks without a single known function
+    std::map<std::string, FunctionCost> functions;
+    std::map<std::pair<std::string, std::string>, int64_t> calls;  // caller, callee
+
+    double share(int64_t samples) const {
+        return totalSamples > 0 ? static_cast<double>(samples) / totalSamples : 0.0;
+    }
+};
+
+// Imports sampling profiles: collapsed stacks ("main;foo;bar 42", as written
+// by stackcollapse-perf.pl or similar) or raw `perf script` output
+class ProfileAnalyzer {
+public:
+    ProfileAnalyzer();
+    ~ProfileAnalyzer();
+
+    // Read a profile and attribute its samples to the given functions.
+    // Frames that do not resolve to a known function are skipped, so a call
+    // through library code links the nearest known caller and callee.
+    bool load(const std::string& path, const std::vector<FunctionInfo>& functions,
+              ProfileData& profile) const;
+
+    // Strip arguments, offsets and DSOs from a symbol, e.g.
+    // "ns::Foo::bar(int) const+0x1f" becomes "ns::Foo::bar"
+    static std::string normalizeSymbol(const std::string& symbol);
+
+    // Render the hottest functions by inclusive samples
+    std::string generateReport(const ProfileData& profile, size_t limit) const;
+
+private:
+    // Attribute one stack, outermost frame first
+    void addStack(const std::vector<std::string>& frames, int64_t samples,
+                  const std::map<std::string, std::string>& known, ProfileData& profile) const;
+};
+
+} // namespace cpp_diagram
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "analysis/model_index.h"
+
+namespace cpp_diagram {
+
+// What the roots reach, per canonical function and class id (see ModelIndex)
+struct ReachabilityResult {
+    std::vector<size_t> roots;
+    std::vector<std::string> unmatchedRoots;  // root names or globs that matched nothing
+
+    // Fewest calls from a root, -1 if unreachable, and the function on one
+    // such path that called it or made its class live (npos for roots)
+    std::vector<int> depth;
+    std::vector<size_t> parent;
+
+    // Classes whose methods, constructors or layout live code depends on
+    std::vector<char> liveClasses;
+
+    // Strongly connected components of the reachable call graph; cycles
+    // holds the recursive ones (several members, or a function calling itself)
+    std::vector<size_t> component;
+    std::vector<std::vector<size_t>> cycles;
+
+    // Longest call chain from a root, each cycle collapsed into one frame
+    std::vector<size_t> longestChain;
+
+    size_t callEdges = 0;
+    size_t virtualEdges = 0;  // call sites dispatched to overrides in subclasses
+};
+
+// Whole-program reachability over the call graph. Calls to a virtual method
+// also reach every override in its subclasses (class hierarchy analysis),
+// and a live class keeps its constructors and destructor alive. Everything
+// is one traversal of a flat edge array, linear in calls and classes.
+class ReachabilityAnalyzer {
+public:
+    ReachabilityAnalyzer();
+    ~ReachabilityAnalyzer();
+
+    // Entry points by qualified name, "*" matching any run of characters,
+    // e.g. test bodies or an exported namespace (default: main, *::TestBody)
+    void setRoots(const std::vector<std::string>& roots);
+
+    ReachabilityResult analyze(const ModelIndex& index) const;
+
+    // Unreachable functions and classes largest first, with recursion and
+    // call depth; lists are cut off after limit entries. Entities from
+    // system headers are left out (see isSystemEntity)
+    std::string generateReport(const ModelIndex& index, const ReachabilityResult& result,
+                               size_t limit) const;
+
+private:
+    std::vector<std::string> roots_;
+};
+
+} // namespace cpp_diagram
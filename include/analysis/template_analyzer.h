@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "parser/ast_types.h"
+
+namespace cpp_diagram {
+
+struct TemplateCost {
+    const TemplateInfo* info;
+    double share;  // fraction of all instantiated AST nodes
+};
+
+class TemplateAnalyzer {
+public:
+    TemplateAnalyzer();
+    ~TemplateAnalyzer();
+
+    // Rank templates by instantiated AST size, heaviest first
+    std::vector<TemplateCost> rankTemplates(const std::vector<TemplateInfo>& templates) const;
+
+    // Render a human-readable report of the heaviest templates
+    std::string generateReport(const std::vector<TemplateInfo>& templates, size_t limit) const;
+};
+
+} // namespace cpp_diagram
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "parser/ast_types.h"
+
+namespace cpp_diagram {
+
+// On-disk layout of a saved model. Every section is an array of fixed-size,
+// 8-byte aligned records addressed by offset from the start of the file;
+// strings live once in a shared table and are referenced by offset and
+// length, and string lists are runs of references in their own section.
+// Records are stored in the writer's native byte order, which open()
+// checks, so the mapped records can be read in place.
+namespace model_format {
+
+constexpr char kMagic[8] = {'C', 'P', 'P', 'D', 'M', 'O', 'D', 'L'};
+constexpr uint32_t kVersion = 6;
+constexpr uint32_t kByteOrderMark = 0x01020304;
+
+struct StringRef {
+    uint64_t offset;
+    uint64_t length;
+};
+
+// A run of records in another section
+struct Range {
+    uint64_t first;
+    uint64_t count;
+};
+
+struct Section {
+    uint64_t offset;
+    uint64_t count;  // records, or bytes for the string table
+};
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrderMark;
+    uint64_t fileSize;
+    Section strings;
+    Section stringLists;
+    Section classes;
+    Section methods;
+    Section fields;
+    Section functions;
+    Section relationships;
+    Section findings;
+};
+
+enum FunctionFlag : uint32_t {
+    FunctionTemplate = 1u << 0,
+    FunctionVirtual = 1u << 1,
+    FunctionPureVirtual = 1u << 2,
+    FunctionStatic = 1u << 3,
+    FunctionConst = 1u << 4,
+    FunctionConstructor = 1u << 5,
+    FunctionDestructor = 1u << 6,
+    FunctionDeleted = 1u << 7,
+    FunctionOverride = 1u << 8,
+    FunctionFinal = 1u << 9,
+    FunctionSystem = 1u << 10
+};
+
+// Free functions and methods share one record; method flags are unset for
+// free functions
+struct FunctionRecord {
+    StringRef name;
+    StringRef qualifiedName;
+    StringRef returnType;
+    StringRef returnRecordType;
+    Range parameters;            // stringLists
+    Range parameterRecordTypes;  // stringLists
+    Range templateParameters;    // stringLists
+    Range calledFunctions;       // stringLists
+    Range writtenFields;         // stringLists
+    Range perfFindings;          // findings
+    StringRef file;
+    uint32_t flags;
+    uint32_t access;
+    int64_t statements;
+};
+
+enum FieldFlag : uint32_t {
+    FieldStatic = 1u << 0,
+    FieldIndirect = 1u << 1,
+    FieldContainer = 1u << 2,
+    FieldBitField = 1u << 3,
+    FieldAtomic = 1u << 4,
+    FieldMutex = 1u << 5,
+    FieldCondition = 1u << 6
+};
+
+struct FieldRecord {
+    StringRef name;
+    StringRef type;
+    StringRef recordType;
+    int64_t offset;
+    int64_t size;
+    int64_t alignment;
+    uint32_t flags;
+    uint32_t access;
+};
+
+enum ClassFlag : uint32_t {
+    ClassAbstract = 1u << 0,
+    ClassTemplate = 1u << 1,
+    ClassFinal = 1u << 2,
+    ClassHasLayout = 1u << 3,
+    ClassSystem = 1u << 4
+};
+
+struct ClassRecord {
+    StringRef name;
+    StringRef qualifiedName;
+    Range templateParameters;  // stringLists
+    Range baseClasses;         // stringLists
+    Range methods;             // methods
+    Range fields;              // fields
+    Range perfFindings;        // findings
+    Range virtualBases;        // fields; name, offset, size and alignment
+    StringRef file;
+    int64_t size;
+    int64_t alignment;
+    int64_t fieldsStart;
+    uint32_t flags;
+    uint32_t reserved;
+};
+
+struct RelationshipRecord {
+    StringRef fromClass;
+    StringRef toClass;
+    StringRef label;
+    Range templateArguments;  // stringLists
+    uint32_t type;
+    uint32_t isBidirectional;
+};
+
+struct FindingRecord {
+    StringRef message;
+    uint32_t issue;
+    uint32_t line;
+};
+
+} // namespace model_format
+
+// A saved model mapped read-only into memory. open() maps the file and
+// checks its header; load() then copies every record into the vectors the
+// analyzers take, so loading still costs time in proportion to the model.
+// What a saved model saves is the Clang parse, not the copy.
+class ModelFile {
+public:
+    ModelFile();
+    ~ModelFile();
+
+    ModelFile(const ModelFile&) = delete;
+    ModelFile& operator=(const ModelFile&) = delete;
+
+    // Write a model in the mappable format. It goes to a temporary file that
+    // is renamed over the target, so a failed write leaves the old model
+    static bool save(const std::string& path,
+                     const std::vector<ClassInfo>& classes,
+                     const std::vector<FunctionInfo>& functions,
+                     const std::vector<RelationshipInfo>& relationships);
+
+    // Map a saved model and validate its header and section bounds
+    bool open(const std::string& path);
+    void close();
+
+    // The mapped records, read in place
+    size_t classCount() const { return header_ ? header_->classes.count : 0; }
+    size_t functionCount() const { return header_ ? header_->functions.count : 0; }
+    size_t relationshipCount() const { return header_ ? header_->relationships.count : 0; }
+    const model_format::ClassRecord& classAt(size_t id) const { return classes_[id]; }
+    const model_format::FunctionRecord& functionAt(size_t id) const { return functions_[id]; }
+    const model_format::FunctionRecord& methodAt(size_t index) const { return methods_[index]; }
+    const model_format::FieldRecord& fieldAt(size_t index) const { return fields_[index]; }
+    const model_format::RelationshipRecord& relationshipAt(size_t index) const { return relationships_[index]; }
+    const model_format::FindingRecord& findingAt(size_t index) const { return findings_[index]; }
+    std::string_view str(const model_format::StringRef& ref) const;
+    std::string_view listItem(const model_format::Range& range, size_t index) const;
+
+    // Materialize the model; false if a record points outside its section
+    // or holds an enum value this build does not know
+    bool load(std::vector<ClassInfo>& classes,
+              std::vector<FunctionInfo>& functions,
+              std::vector<RelationshipInfo>& relationships) const;
+
+private:
+    bool validRange(const model_format::Range& range, uint64_t sectionCount) const {
+        return range.first <= sectionCount && range.count <= sectionCount - range.first;
+    }
+    std::vector<std::string> list(const model_format::Range& range) const;
+    bool findingList(const model_format::Range& range, std::vector<PerfFinding>& items) const;
+    bool loadFunction(const model_format::FunctionRecord& record, FunctionInfo& function) const;
+    bool validFunction(const model_format::FunctionRecord& record) const;
+
+    void* mapping_ = nullptr;
+    size_t mappingSize_ = 0;
+    const model_format::Header* header_ = nullptr;
+    const char* strings_ = nullptr;
+    const model_format::StringRef* stringLists_ = nullptr;
+    const model_format::ClassRecord* classes_ = nullptr;
+    const model_format::FunctionRecord* methods_ = nullptr;
+    const model_format::FieldRecord* fields_ = nullptr;
+    const model_format::FunctionRecord* functions_ = nullptr;
+    const model_format::RelationshipRecord* relationships_ = nullptr;
+    const model_format::FindingRecord* findings_ = nullptr;
+};
+
+} // namespace cpp_diagram
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "parser/ast_types.h"
+
+namespace cpp_diagram {
+
+// Combines partial models, such as the shard files of a sharded parse, in
+// the order they are added. Classes are deduplicated by qualified name and
+// functions by name and parameters, keeping the first definition; the call
+// edges of duplicate functions and all relationships are unioned.
+class ModelMerger {
+public:
+    ModelMerger();
+    ~ModelMerger();
+
+    void add(std::vector<ClassInfo>&& classes,
+             std::vector<FunctionInfo>&& functions,
+             std::vector<RelationshipInfo>&& relationships);
+
+    const std::vector<ClassInfo>& classes() const { return classes_; }
+    const std::vector<FunctionInfo>& functions() const { return functions_; }
+    const std::vector<RelationshipInfo>& relationships() const { return relationships_; }
+
+private:
+    std::vector<ClassInfo> classes_;
+    std::vector<FunctionInfo> functions_;
+    std::vector<RelationshipInfo> relationships_;
+
+    std::unordered_set<std::string> classNames_;
+    std::unordered_map<std::string, size_t> functionIds_;
+    // Callees of each function seen more than once, by function id, so
+    // unioning call edges is linear in the edges added
+    std::unordered_map<size_t, std::unordered_set<std::string>> calleeSets_;
+    std::unordered_set<std::string> relationshipKeys_;
+};
+
+} // namespace cpp_diagram
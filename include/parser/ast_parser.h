@@ -1,12 +1,19 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 #include <memory>
+#include <memory_resource>
+#include <unordered_map>
 #include <clang/AST/ASTConsumer.h>
 #include <clang/AST/RecursiveASTVisitor.h>
 #include <clang/Frontend/CompilerInstance.h>
 #include <clang/Frontend/FrontendAction.h>
+#include <clang/Tooling/Tooling.h>
+#include "profiling/tracer.h"
 
 namespace cpp_diagram {
 
@@ -14,6 +21,9 @@ namespace cpp_diagram {
 struct ClassInfo;
 struct FunctionInfo;
 struct RelationshipInfo;
+struct HeaderInfo;
+struct TemplateInfo;
+enum class RelationshipType;
 
 class ASTParser {
 public:
@@ -35,7 +45,35 @@ public:
     // Get relationships between classes
     std::vector<RelationshipInfo> getRelationships() const;
 
+    // Record per-TU clang frontend and extraction phases
+    void setTracer(Tracer* tracer);
+
+    // Record the include graph and per-file token counts while parsing.
+    // Off by default because it adds a callback per lexed token.
+    void setCollectIncludes(bool collect);
+
+    // Get the include graph, one entry per source file or header
+    std::vector<HeaderInfo> getHeaderInfo() const;
+
+    // Count template instantiations and their AST size while parsing
+    void setCollectTemplates(bool collect);
+
+    // Get instantiation statistics, one entry per primary template
+    std::vector<TemplateInfo> getTemplateInfo() const;
+
+    // Flag common performance problems while extracting and attach them to
+    // the functions and classes. Parameters copied by value count as large
+    // above copyThreshold bytes.
+    void setCollectPerfLint(bool collect, int64_t copyThreshold);
+
+    // Where the PCH of the include block shared by all inputs is cached;
+    // defaults to PreambleCache::defaultDirectory(), empty turns it off.
+    // Never used while collecting includes, which must see every header.
+    void setPreambleCache(const std::string& directory);
+
 private:
+    class IncludeRecorder;
+
     class ASTConsumer : public clang::ASTConsumer {
     public:
         explicit ASTConsumer(ASTParser& parser) : parser_(parser) {}
@@ -45,14 +83,84 @@ private:
         ASTParser& parser_;
     };
 
+    // Extracts one translation unit. Records are staged here and moved into
+    // the parser's model in one step by commit(); spellings and names that
+    // repeat across the TU are cached in the TU's arena, which is released
+    // as a whole when the TU ends.
     class ASTVisitor : public clang::RecursiveASTVisitor<ASTVisitor> {
     public:
-        explicit ASTVisitor(ASTParser& parser) : parser_(parser) {}
+        ASTVisitor(ASTParser& parser, std::pmr::memory_resource* arena);
         bool VisitCXXRecordDecl(clang::CXXRecordDecl* decl);
         bool VisitFunctionDecl(clang::FunctionDecl* decl);
+        bool VisitClassTemplateDecl(clang::ClassTemplateDecl* decl);
+        bool VisitFunctionTemplateDecl(clang::FunctionTemplateDecl* decl);
+
+        // Move the staged records into the parser's model
+        void commit();
+
+        size_t classCount() const { return classes_.size(); }
+        size_t functionCount() const { return functions_.size(); }
 
     private:
+        struct ResolvedType {
+            std::string_view record;
+            bool isIndirect;
+            bool isContainer;
+            bool isSystem;              // the class is declared in a system header
+            RelationshipType ownership; // weakest hold along the way to the class
+        };
+
+        // Qualified name of the class a type refers to, seeing through
+        // pointers, references, smart pointers and standard containers
+        const ResolvedType& resolveRecordType(clang::QualType type);
+
+        // Composition, aggregation and association edges from the member
+        // types, then dependencies from method signatures
+        void addMemberRelationships(const clang::CXXRecordDecl* decl, const ClassInfo& classInfo,
+                                    const std::vector<std::pair<const ResolvedType*, size_t>>& members);
+
+        // Cached type spelling and qualified declaration name
+        std::string_view spell(clang::QualType type);
+        std::string_view qualifiedName(const clang::NamedDecl* decl);
+        std::string_view fileName(const clang::Decl* decl);
+        std::string_view intern(const std::string& text);
+
+        // Record every direct call made anywhere in a function body; in user
+        // code also the fields it writes and, with perf lint on, the
+        // allocations and growth inside its loops
+        void collectCalls(const clang::FunctionDecl* decl, FunctionInfo& functionInfo, bool userCode);
+        void collectFieldWrite(const clang::Stmt* stmt, FunctionInfo& functionInfo);
+        void lintCall(const clang::CallExpr* call, const clang::FunctionDecl* callee, bool inLoop,
+                      FunctionInfo& functionInfo);
+
+        // Flag large parameters copied by value and std::function parameters
+        void lintParameters(const clang::FunctionDecl* decl, FunctionInfo& functionInfo);
+
+        // Note why a class would be copied rather than moved when a vector
+        // holding it grows
+        void lintMoveConstructor(const clang::CXXRecordDecl* decl, const ClassInfo& classInfo);
+
+        // Record one instantiation of a primary template
+        void recordInstantiation(const clang::NamedDecl* primary,
+                                 const clang::NamedDecl* instantiation,
+                                 bool isClassTemplate);
+
         ASTParser& parser_;
+        std::pmr::memory_resource* arena_;
+        std::pmr::unordered_map<const void*, std::string_view> typeSpellings_;
+        std::pmr::unordered_map<const void*, std::string_view> qualifiedNames_;
+        std::pmr::unordered_map<const void*, ResolvedType> resolvedTypes_;
+        std::pmr::unordered_map<unsigned, std::string_view> fileNames_;  // by FileID
+        std::vector<std::pair<const clang::Stmt*, bool>> pendingStmts_;  // statement, inside a loop
+
+        // Local containers grown inside a loop and those reserve()d anywhere
+        // in the function being walked
+        std::vector<std::pair<const clang::VarDecl*, int>> grownInLoop_;
+        std::vector<const clang::VarDecl*> reserved_;
+
+        std::vector<ClassInfo> classes_;
+        std::vector<FunctionInfo> functions_;
+        std::vector<RelationshipInfo> relationships_;
     };
 
     class ASTFrontendAction : public clang::ASTFrontendAction {
@@ -60,6 +168,18 @@ private:
         explicit ASTFrontendAction(ASTParser& parser) : parser_(parser) {}
         std::unique_ptr<clang::ASTConsumer> CreateASTConsumer(
             clang::CompilerInstance& compiler, llvm::StringRef file) override;
+        bool BeginSourceFileAction(clang::CompilerInstance& compiler) override;
+        void EndSourceFileAction() override;
+
+    private:
+        ASTParser& parser_;
+        size_t unitEvent_ = 0;
+    };
+
+    class ActionFactory : public clang::tooling::FrontendActionFactory {
+    public:
+        explicit ActionFactory(ASTParser& parser) : parser_(parser) {}
+        std::unique_ptr<clang::FrontendAction> create() override;
 
     private:
         ASTParser& parser_;
@@ -68,6 +188,31 @@ private:
     std::vector<ClassInfo> classes_;
     std::vector<FunctionInfo> functions_;
     std::vector<RelationshipInfo> relationships_;
+
+    Tracer* tracer_ = nullptr;
+    size_t frontendEvent_ = 0;
+    bool frontendOpen_ = false;  // until the consumer or the action closes it
+
+    bool collectIncludes_ = false;
+    std::vector<HeaderInfo> headers_;
+    std::unordered_map<std::string, size_t> headerIds_;
+
+    bool collectTemplates_ = false;
+    std::vector<TemplateInfo> templates_;
+    std::unordered_map<std::string, size_t> templateIds_;
+
+    // Classes are only flagged for their move constructor once some vector
+    // holds them, which may be in another TU; both sides are matched up
+    // after the last TU
+    void attachMoveFindings();
+
+    bool collectPerfLint_ = false;
+    int64_t copyThreshold_ = 0;
+    std::unordered_map<std::string, std::pair<std::string, int>> moveIssues_;  // reason, line
+    std::unordered_map<std::string, std::string> vectorElements_;  // class -> holding field
+
+    std::string preambleCache_;
+    std::unordered_map<std::string, bool> parsedUnits_;  // main files that reached the consumer -> error free
 };
 
 } // namespace cpp_diagram 
\ No newline at end of file
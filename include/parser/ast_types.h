@@ -1 +1,186 @@
- 
\ No newline at end of file
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace cpp_diagram {
+
+enum class AccessSpecifier {
+    Public,
+    Protected,
+    Private
+};
+
+enum class RelationshipType {
+    Inheritance,
+    Composition,
+    Aggregation,
+    Association,
+    Dependency
+};
+
+// Static performance lint checks run while extracting the model
+enum class PerfIssue {
+    AllocationInLoop,      // new, make_shared or make_unique inside a loop
+    GrowthWithoutReserve,  // push_back/emplace_back in a loop, never reserve()d
+    LargeByValue,          // non-trivially-copyable parameter copied by value
+    ThrowingMove,          // class kept in a container has no noexcept move constructor
+    StdFunctionParameter   // type-erased callable in a signature
+};
+
+struct PerfFinding {
+    PerfIssue issue = PerfIssue::AllocationInLoop;
+    std::string message;
+    int line = 0;  // 0 if unknown
+};
+
+// Synchronization primitives held by value, which threads write to
+enum class SyncKind {
+    None,
+    Atomic,    // std::atomic<T>, std::atomic_flag
+    Mutex,     // std::mutex and the other standard mutexes, spin locks
+    Condition  // std::condition_variable, std::condition_variable_any
+};
+
+struct FieldInfo {
+    std::string name;
+    std::string type;
+    AccessSpecifier access = AccessSpecifier::Private;
+    bool isStatic = false;
+
+    // Qualified name of the class the field type refers to once pointers,
+    // references, smart pointers and containers are stripped (empty if none)
+    std::string recordType;
+    bool isIndirect = false;   // held through a pointer, reference or smart pointer
+    bool isContainer = false;  // held inside a standard container
+
+    // Record layout in bytes; offset is -1 when the layout is unknown
+    // (static members, templates that were never instantiated)
+    int64_t offset = -1;
+    int64_t size = 0;
+    int64_t alignment = 0;
+    bool isBitField = false;
+
+    SyncKind sync = SyncKind::None;
+};
+
+struct FunctionInfo {
+    std::string name;
+    std::string qualifiedName;
+    std::string returnType;
+    std::vector<std::string> parameters;
+    bool isTemplate = false;
+    std::vector<std::string> templateParameters;
+    std::vector<std::string> calledFunctions;
+
+    // Qualified names of the data members the body assigns, increments or
+    // calls non-const methods on, once per write site
+    std::vector<std::string> writtenFields;
+
+    // Resolved class of the return type and of each parameter, parallel to
+    // returnType/parameters (empty where the type is not a class)
+    std::string returnRecordType;
+    std::vector<std::string> parameterRecordTypes;
+
+    std::string file;  // source file of the definition
+    bool isSystem = false;  // declared in a system header
+    std::vector<PerfFinding> perfFindings;
+
+    // Statements and expressions in the body, a rough measure of code size
+    int64_t statements = 0;
+};
+
+struct MethodInfo : FunctionInfo {
+    AccessSpecifier access = AccessSpecifier::Public;
+    bool isVirtual = false;
+    bool isPureVirtual = false;
+    bool isStatic = false;
+    bool isConst = false;
+    bool isConstructor = false;
+    bool isDestructor = false;
+    bool isDeleted = false;
+    bool isOverride = false;
+    bool isFinal = false;
+};
+
+// A virtual base subobject; the Itanium ABI places these after the fields
+struct VirtualBaseInfo {
+    std::string name;  // qualified name of the base
+    int64_t offset = 0;
+    int64_t size = 0;  // its non-virtual part
+    int64_t alignment = 0;
+};
+
+struct ClassInfo {
+    std::string name;
+    std::string qualifiedName;
+    bool isAbstract = false;
+    bool isTemplate = false;
+    bool isFinal = false;
+    std::vector<std::string> templateParameters;
+    std::vector<std::string> baseClasses;
+    std::vector<MethodInfo> methods;
+    std::vector<FieldInfo> fields;
+    std::string file;  // source file of the definition
+    bool isSystem = false;  // declared in a system header
+    std::vector<PerfFinding> perfFindings;
+
+    // Record layout in bytes, available for complete non-dependent classes
+    bool hasLayout = false;
+    int64_t size = 0;
+    int64_t alignment = 0;
+    int64_t fieldsStart = 0;  // bytes taken by the vtable pointer and bases
+    std::vector<VirtualBaseInfo> virtualBases;  // by offset, empty ones left out
+};
+
+struct RelationshipInfo {
+    std::string fromClass;
+    std::string toClass;
+    RelationshipType type = RelationshipType::Dependency;
+    bool isBidirectional = false;
+    std::string label;
+
+    // Class-typed template arguments of the target, e.g. Derived for an
+    // inheritance edge to Base<Derived>
+    std::vector<std::string> templateArguments;
+};
+
+struct HeaderInfo {
+    std::string path;
+    bool isSystem = false;
+    bool isMainFile = false;
+
+    // Parse cost summed over every translation unit that includes the file
+    int64_t tokens = 0;           // tokens lexed from the file itself
+    int64_t inclusiveTokens = 0;  // plus everything it pulled in
+    int translationUnits = 0;     // TUs that include it, directly or not
+
+    std::vector<std::string> includedBy;  // distinct direct includers
+};
+
+struct TemplateInfo {
+    std::string name;  // qualified name of the primary template
+    bool isClassTemplate = false;
+
+    // Work summed over every translation unit; each TU instantiates anew
+    int instantiations = 0;
+    int64_t astNodes = 0;  // declarations and statements in the instantiations
+
+    std::vector<std::string> arguments;  // distinct spellings, e.g. Container<int>
+};
+
+// The standard library, libc and compiler internals are nobody's
+// architecture or dead code. Names are checked as well for models saved
+// before isSystem was recorded.
+inline bool isSystemEntity(const std::string& qualifiedName, bool isSystem) {
+    return isSystem || qualifiedName.compare(0, 5, "std::") == 0 || qualifiedName.compare(0, 2, "__") == 0;
+}
+inline bool isSystemEntity(const ClassInfo& classInfo) {
+    return isSystemEntity(classInfo.qualifiedName, classInfo.isSystem);
+}
+inline bool isSystemEntity(const FunctionInfo& function) {
+    return isSystemEntity(function.qualifiedName, function.isSystem);
+}
+
+} // namespace cpp_diagram
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "profiling/tracer.h"
+
+namespace cpp_diagram {
+
+// One #include line at the top of a source file. Quoted includes are keyed
+// by the absolute path they resolve to, so the same header reached from
+// different directories still matches.
+struct IncludeDirective {
+    std::string key;   // "<vector>" or "\"/abs/path/header.h\""
+    size_t end = 0;    // byte offset just past the line
+};
+
+// Precompiles the include block every input starts with once and lets each
+// TU skip those bytes and load the PCH instead. PCHs are cached on disk,
+// keyed by the compiler version, the flags and the include block, and are
+// rebuilt when any header they were built from is newer or its contents
+// hash differently. PCHs unused for kMaxAgeDays are deleted, and the least
+// recently used ones go once the directory holds more than kMaxBytes.
+class PreambleCache {
+public:
+    static constexpr int kMaxAgeDays = 30;
+    static constexpr uint64_t kMaxBytes = 2ull << 30;
+
+    explicit PreambleCache(std::string directory);
+    ~PreambleCache();
+
+    // $XDG_CACHE_HOME/cpp_diagram/preamble, falling back to ~/.cache; empty
+    // if neither is set
+    static std::string defaultDirectory();
+
+    // Leading include directives of a file's contents, up to the first line
+    // that is not an include, a comment or blank
+    static std::vector<IncludeDirective> scanDirectives(const std::string& contents,
+                                                        const std::string& directory);
+
+    // Find the directives all files start with; false if they share none
+    bool scan(const std::vector<std::string>& files);
+
+    // Build the PCH for the shared block with the TU flags, or reuse a
+    // cached one that is still fresh
+    bool prepare(const std::vector<std::string>& args, Tracer* tracer);
+
+    // Bytes at the start of a file the PCH stands in for, 0 if none
+    size_t preambleBytes(const std::string& file) const;
+
+    const std::string& pchPath() const { return pchPath_; }
+    size_t directiveCount() const { return shared_.size(); }
+    bool reused() const { return reused_; }
+
+private:
+    // True if the PCH exists and no dependency listed next to it is newer
+    // or hashes differently from when it was built
+    bool isFresh(const std::string& dependencyFile, const std::string& hashFile) const;
+
+    // Delete cached PCHs that are too old or over the size budget, never
+    // the one named keep
+    void prune(const std::string& keep) const;
+
+    std::string directory_;
+    std::vector<std::string> shared_;                  // keys of the shared directives
+    std::unordered_map<std::string, size_t> bytes_;    // absolute file -> preamble bytes
+    std::string pchPath_;
+    bool reused_ = false;
+};
+
+} // namespace cpp_diagram
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace cpp_diagram {
+
+// Records wall time, CPU time and peak RSS for named phases of a run and
+// exports them as a Chrome trace (chrome://tracing, Perfetto) and a summary
+// table. Components take an optional Tracer*; a null tracer records nothing.
+class Tracer {
+public:
+    struct PhaseTotal {
+        int count = 0;
+        int64_t wallMicros = 0;
+        int64_t cpuMicros = 0;
+    };
+
+    Tracer();
+    ~Tracer();
+
+    // Open and close an event; events may nest
+    size_t begin(const std::string& name, const std::string& category);
+    void end(size_t event);
+
+    // Attach a count, e.g. nodes or edges, to an event
+    void setCounter(size_t event, const std::string& name, int64_t value);
+
+    // Write the trace-event JSON file
+    bool writeChromeTrace(const std::string& path) const;
+
+    // Wall and CPU time summed per category
+    std::map<std::string, PhaseTotal> categoryTotals() const;
+
+    // Highest resident set size seen at any event boundary
+    int64_t peakRssKb() const;
+
+    // Per-category totals followed by the individual events
+    std::string generateSummary() const;
+
+private:
+    struct Event {
+        std::string name;
+        std::string category;
+        int64_t startMicros = 0;
+        int64_t wallMicros = 0;
+        int64_t cpuMicros = 0;
+        int64_t peakRssKb = 0;
+        int depth = 0;
+        std::map<std::string, int64_t> counters;
+    };
+
+    int64_t nowMicros() const;
+
+    std::chrono::steady_clock::time_point origin_;
+    std::vector<Event> events_;
+    std::vector<int64_t> cpuAtBegin_;
+    int openEvents_ = 0;
+    mutable std::mutex mutex_;
+};
+
+// Closes its event when it goes out of scope
+class TraceScope {
+public:
+    TraceScope(Tracer* tracer, const std::string& name, const std::string& category);
+    ~TraceScope();
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+    void setCounter(const std::string& name, int64_t value);
+
+private:
+    Tracer* tracer_;
+    size_t event_ = 0;
+};
+
+} // namespace cpp_diagram
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "parser/ast_types.h"
+#include "analysis/code_analyzer.h"
+#include "analysis/model_index.h"
+
+namespace cpp_diagram {
+
+// Keeps a parsed model in memory and answers diagram, slice and metric
+// queries against it, so clients pay for parsing once instead of per run.
+// Requests and responses are single-line JSON objects; serve() reads them
+// from a Unix domain socket, one per line.
+class QueryServer {
+public:
+    QueryServer();
+    ~QueryServer();
+
+    // Parse the inputs and replace the current model
+    bool load(const std::vector<std::string>& inputFiles);
+
+    // Load a model saved with --save-model and replace the current model
+    bool loadModel(const std::string& path);
+
+    // Directory that diagram requests may write "output" files under
+    // (default: the working directory the server was started in)
+    bool setOutputRoot(const std::string& directory);
+
+    // Answer one request, e.g. {"query":"slice","root":"ns::Foo","depth":2}
+    std::string handle(const std::string& request);
+
+    // Accept connections on socketPath until a shutdown query arrives.
+    // Clients are polled together, so an idle one cannot hold up the rest
+    bool serve(const std::string& socketPath);
+
+    // Send one request to a running server and wait for its response
+    static bool query(const std::string& socketPath, const std::string& request,
+                      std::string& response);
+
+private:
+    using Request = std::map<std::string, std::string>;
+
+    std::string handleMetrics(const Request& request);
+    std::string handleSlice(const Request& request);
+    std::string handleSelect(const Request& request);
+    std::string handleDiagram(const Request& request);
+    std::string handleReload();
+
+    // Ids within depth hops of root over inheritance and relationships
+    std::vector<size_t> sliceClasses(size_t root, int depth) const;
+    // Ids within depth hops of root over calls, in the given direction
+    std::vector<size_t> sliceFunctions(size_t root, int depth, const std::string& direction) const;
+
+    // Rebuild the index and adjacency after the model changes
+    void buildIndex();
+
+    // The output root joined with path, or empty if that leaves the root
+    std::filesystem::path resolveOutput(const std::string& path) const;
+
+    // Private directory for diagrams returned inline, created on first use
+    // and removed with the server
+    std::filesystem::path scratchDirectory();
+
+    std::vector<std::string> inputFiles_;
+    std::string modelPath_;
+    std::filesystem::path outputRoot_;
+    std::filesystem::path scratchDirectory_;
+    std::vector<ClassInfo> classes_;
+    std::vector<FunctionInfo> functions_;
+    std::vector<RelationshipInfo> relationships_;
+    std::unique_ptr<ModelIndex> index_;
+
+    // Undirected class adjacency, by id; the call graph is in the index
+    std::vector<std::vector<size_t>> classNeighbours_;
+
+    CodeAnalyzer analyzer_;
+    CodeSummary summary_;
+    int requestCount_ = 0;
+    bool running_ = false;
+};
+
+} // namespace cpp_diagram
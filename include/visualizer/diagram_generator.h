@@ -3,8 +3,16 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <map>
 #include <graphviz/gvc.h>
-#include "parser/ast_parser.h"
+#include "parser/ast_types.h"
+#include "analysis/layout_analyzer.h"
+#include "analysis/concurrency_analyzer.h"
+#include "analysis/profile_analyzer.h"
+#include "analysis/model_diff.h"
+#include "analysis/component_analyzer.h"
+#include "analysis/perf_lint_analyzer.h"
+#include "profiling/tracer.h"
 
 namespace cpp_diagram {
 
@@ -22,31 +30,97 @@ public:
     bool generateCallGraph(const std::vector<FunctionInfo>& functions,
                           const std::string& outputFile);
 
-    // Generate a component diagram
-    bool generateComponentDiagram(const std::vector<ClassInfo>& classes,
+    // Generate a component dependency diagram
+    bool generateComponentDiagram(const ComponentGraph& components,
                                 const std::string& outputFile);
 
+    // Generate a byte-level memory layout diagram
+    bool generateLayoutDiagram(const std::vector<ClassLayout>& layouts,
+                             const std::string& outputFile);
+
+    // Generate a per-class view of synchronization members, frequently
+    // written fields and the cache lines they share
+    bool generateConcurrencyDiagram(const std::vector<ConcurrencyLayout>& layouts,
+                                    const std::string& outputFile);
+
+    // Generate an include graph shaded by header parse cost
+    bool generateIncludeDiagram(const std::vector<HeaderInfo>& headers,
+                              const std::string& outputFile);
+
+    // Generate a diagram of changed classes and calls plus their one-hop context
+    bool generateDiffDiagram(const ModelDiff& diff, const std::string& outputFile);
+
     // Set diagram style options
     void setStyle(const std::string& styleName);
     void setOutputFormat(const std::string& format);
 
+    // What class and function nodes show: 1 names only, 2 the public API,
+    // 3 every member (the default). Classes with more than memberLimit
+    // members left to show list the first ones and fold the rest into a
+    // count and the node tooltip; 0 shows them all.
+    void setDetailLevel(int level, size_t memberLimit);
+
+    // Record graph building, layout and rendering phases
+    void setTracer(Tracer* tracer);
+
+    // Shade template classes and functions by instantiation cost
+    void setTemplateCosts(const std::vector<TemplateInfo>& templates);
+
+    // Color and size call graph nodes and edges by sampled cost, dropping
+    // functions whose inclusive share is below pruneThreshold (0..1)
+    void setProfile(const ProfileData& profile, double pruneThreshold);
+
+    // Outline call graph functions that have perf lint findings
+    void setPerfFindings(const std::vector<PerfLintEntry>& entries);
+
 private:
+    // Microbenchmarks reach the private helpers through this
+    friend struct BenchmarkAccess;
+
     // Graphviz context
     GVC_t* gvc_;
     
     // Current style settings
     std::string style_;
     std::string outputFormat_;
+    int detailLevel_ = 3;
+    size_t memberLimit_ = 0;
+    Tracer* tracer_ = nullptr;
+
+    // Template instantiation overlay
+    std::map<std::string, TemplateInfo> templateCosts_;
+    int64_t maxTemplateNodes_ = 0;
+
+    // Profile overlay
+    ProfileData profile_;
+    bool hasProfile_ = false;
+    double pruneThreshold_ = 0.0;
+
+    // Perf lint overlay, findings by function
+    std::map<std::string, std::vector<PerfFinding>> perfFindings_;
+
+    // Lay out, render and free a finished graph
+    bool layoutAndRender(Agraph_t* graph, const std::string& outputFile);
 
     // Helper methods for graph creation
     Agraph_t* createClassGraph(const std::vector<ClassInfo>& classes,
                              const std::vector<RelationshipInfo>& relationships);
     Agraph_t* createCallGraph(const std::vector<FunctionInfo>& functions);
-    Agraph_t* createComponentGraph(const std::vector<ClassInfo>& classes);
+    Agraph_t* createComponentGraph(const ComponentGraph& components);
+    Agraph_t* createLayoutGraph(const std::vector<ClassLayout>& layouts);
+    Agraph_t* createConcurrencyGraph(const std::vector<ConcurrencyLayout>& layouts);
+    Agraph_t* createIncludeGraph(const std::vector<HeaderInfo>& headers);
+    Agraph_t* createDiffGraph(const ModelDiff& diff);
 
     // Helper methods for node and edge creation
     Agnode_t* createClassNode(Agraph_t* graph, const ClassInfo& classInfo);
     Agnode_t* createFunctionNode(Agraph_t* graph, const FunctionInfo& functionInfo);
+    Agnode_t* createLayoutNode(Agraph_t* graph, const ClassLayout& layout);
+    Agnode_t* createConcurrencyNode(Agraph_t* graph, const ConcurrencyLayout& layout);
+    void applyTemplateCost(Agnode_t* node, const std::string& qualifiedName, std::string& label);
+    void applyProfileCost(Agnode_t* node, const std::string& qualifiedName, std::string& label);
+    void applyProfileCost(Agedge_t* edge, int64_t samples);
+    void applyPerfFindings(Agnode_t* node, const std::string& qualifiedName, std::string& label);
     Agedge_t* createRelationshipEdge(Agraph_t* graph, Agnode_t* from, Agnode_t* to,
                                    const RelationshipInfo& relationship);
 };
@@ -60,7 +60,8 @@ CodeSummary CodeAnalyzer::analyzeFunction(const FunctionInfo& functionInfo) {
 }
 
 CodeSummary CodeAnalyzer::analyzeCodebase(const std::vector<ClassInfo>& classes,
-                                        const std::vector<FunctionInfo>& functions) {
+                                        const std::vector<FunctionInfo>& functions,
+                                        const std::vector<RelationshipInfo>& relationships) {
     CodeSummary summary;
     
     // Calculate overall metrics
@@ -99,6 +100,22 @@ CodeSummary CodeAnalyzer::analyzeCodebase(const std::vector<ClassInfo>& classes,
     }
     
     summary.purpose = purpose.str();
+
+    // Classify the whole codebase against the structural pattern rules
+    ModelIndex index(classes, functions, relationships);
+    for (const auto& match : patternEngine_.classify(index)) {
+        std::string pattern = match.pattern + ": " + match.className;
+        if (!match.participants.empty()) {
+            pattern += " (";
+            for (size_t i = 0; i < match.participants.size(); ++i) {
+                if (i > 0) pattern += ", ";
+                pattern += match.participants[i];
+            }
+            pattern += ")";
+        }
+        summary.designPatterns.push_back(pattern);
+    }
+
     return summary;
 }
 
@@ -184,32 +201,17 @@ CodeMetrics CodeAnalyzer::calculateMetrics(const FunctionInfo& functionInfo) {
 
 std::vector<std::string> CodeAnalyzer::identifyDesignPatterns(const ClassInfo& classInfo) {
     std::vector<std::string> patterns;
-    
-    // Check for Singleton pattern
-    if (classInfo.methods.size() == 1 && 
-        classInfo.methods[0].isStatic && 
-        classInfo.methods[0].name == "getInstance") {
-        patterns.push_back("Singleton");
-    }
-    
-    // Check for Factory pattern
-    if (classInfo.name.find("Factory") != std::string::npos) {
-        patterns.push_back("Factory");
-    }
-    
-    // Check for Observer pattern
-    bool hasAttach = false;
-    bool hasDetach = false;
-    bool hasNotify = false;
-    for (const auto& method : classInfo.methods) {
-        if (method.name == "attach") hasAttach = true;
-        if (method.name == "detach") hasDetach = true;
-        if (method.name == "notify") hasNotify = true;
-    }
-    if (hasAttach && hasDetach && hasNotify) {
-        patterns.push_back("Observer");
+
+    // Without the rest of the codebase only the class's own structure is
+    // visible, so hierarchy-based rules will not fire here
+    std::vector<ClassInfo> classes = {classInfo};
+    std::vector<FunctionInfo> functions;
+    std::vector<RelationshipInfo> relationships;
+    ModelIndex index(classes, functions, relationships);
+    for (const auto& match : patternEngine_.classify(index)) {
+        patterns.push_back(match.pattern);
     }
-    
+
     return patterns;
 }
 
@@ -0,0 +1,247 @@
+#include "analysis/component_analyzer.h"
+#include "analysis/graph_algorithms.h"
+#include <algorithm>
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
+#include <unordered_map>
+
+namespace fs = std::filesystem;
+
+namespace cpp_diagram {
+
+namespace {
+
+// Enclosing scope of a qualified name: "a::b::C" -> "a::b"
+std::string enclosingScope(const std::string& qualifiedName) {
+    size_t separator = qualifiedName.rfind("::");
+    return separator == std::string::npos ? "" : qualifiedName.substr(0, separator);
+}
+
+} // namespace
+
+ComponentAnalyzer::ComponentAnalyzer() = default;
+ComponentAnalyzer::~ComponentAnalyzer() = default;
+
+bool ComponentAnalyzer::setGrouping(const std::string& grouping, int depth) {
+    if (grouping != "directory" && grouping != "namespace") {
+        return false;
+    }
+    byNamespace_ = grouping == "namespace";
+    depth_ = std::max(depth, 0);
+    return true;
+}
+
+void ComponentAnalyzer::setLayers(const std::vector<std::string>& layers) {
+    layers_ = layers;
+}
+
+std::string ComponentAnalyzer::componentName(const std::string& file, const std::string& qualifiedName) const {
+    std::vector<std::string> parts;
+    std::string separator;
+    if (byNamespace_) {
+        separator = "::";
+        std::string scope = enclosingScope(qualifiedName);
+        size_t start = 0;
+        while (!scope.empty() && start <= scope.size()) {
+            size_t end = scope.find("::", start);
+            if (end == std::string::npos) end = scope.size();
+            parts.push_back(scope.substr(start, end - start));
+            start = end + 2;
+        }
+    } else {
+        separator = "/";
+        fs::path directory = fs::path(file).parent_path().lexically_normal();
+        if (directory.is_absolute()) {
+            std::error_code error;
+            fs::path relative = directory.lexically_relative(fs::current_path(error));
+            if (!error && !relative.empty() && *relative.begin() != "..") {
+                directory = relative;
+            }
+        }
+        for (const auto& part : directory) {
+            if (part != "." && !part.empty()) parts.push_back(part.string());
+        }
+    }
+
+    if (depth_ > 0 && parts.size() > static_cast<size_t>(depth_)) {
+        parts.resize(depth_);
+    }
+    if (parts.empty()) {
+        return byNamespace_ ? "(global)" : "(root)";
+    }
+
+    std::string name = parts[0];
+    for (size_t i = 1; i < parts.size(); ++i) {
+        name += separator + parts[i];
+    }
+    return name;
+}
+
+ComponentGraph ComponentAnalyzer::analyze(const std::vector<ClassInfo>& classes,
+                                          const std::vector<FunctionInfo>& functions,
+                                          const std::vector<RelationshipInfo>& relationships) const {
+    ComponentGraph graph;
+    std::unordered_map<std::string, size_t> componentIds;
+    // Entities share a handful of files and namespaces; name each one once
+    std::unordered_map<std::string, size_t> keyComponents;
+
+    auto componentOf = [&](const std::string& file, const std::string& qualifiedName) {
+        std::string key = byNamespace_ ? enclosingScope(qualifiedName) : file;
+        auto keyIt = keyComponents.find(key);
+        if (keyIt != keyComponents.end()) {
+            return keyIt->second;
+        }
+        std::string name = componentName(file, qualifiedName);
+        auto [it, inserted] = componentIds.emplace(name, graph.components.size());
+        if (inserted) {
+            graph.components.push_back({});
+            graph.components.back().name = name;
+        }
+        keyComponents.emplace(key, it->second);
+        return it->second;
+    };
+
+    // Assign every class, method and free function to a component
+    std::unordered_map<std::string, size_t> classComponents;
+    std::unordered_map<std::string, size_t> functionComponents;
+    for (const auto& classInfo : classes) {
+        if (isSystemEntity(classInfo) || classComponents.count(classInfo.qualifiedName)) {
+            continue;
+        }
+        size_t id = componentOf(classInfo.file, classInfo.qualifiedName);
+        classComponents.emplace(classInfo.qualifiedName, id);
+        ++graph.components[id].classes;
+        for (const auto& method : classInfo.methods) {
+            functionComponents.emplace(method.qualifiedName, id);
+        }
+    }
+    for (const auto& function : functions) {
+        if (isSystemEntity(function) || functionComponents.count(function.qualifiedName)) {
+            continue;
+        }
+        size_t id = componentOf(function.file, function.qualifiedName);
+        functionComponents.emplace(function.qualifiedName, id);
+        ++graph.components[id].functions;
+    }
+
+    // Roll relationships and calls up into weighted component edges
+    std::unordered_map<uint64_t, size_t> dependencyIds;
+    auto dependency = [&](size_t from, size_t to) -> ComponentDependency& {
+        uint64_t key = static_cast<uint64_t>(from) << 32 | to;
+        auto [it, inserted] = dependencyIds.emplace(key, graph.dependencies.size());
+        if (inserted) {
+            graph.dependencies.push_back({});
+            graph.dependencies.back().from = from;
+            graph.dependencies.back().to = to;
+        }
+        return graph.dependencies[it->second];
+    };
+    for (const auto& relationship : relationships) {
+        auto fromIt = classComponents.find(relationship.fromClass);
+        auto toIt = classComponents.find(relationship.toClass);
+        if (fromIt != classComponents.end() && toIt != classComponents.end() && fromIt->second != toIt->second) {
+            ++dependency(fromIt->second, toIt->second).relationships;
+        }
+    }
+    for (const auto& function : functions) {
+        auto fromIt = functionComponents.find(function.qualifiedName);
+        if (fromIt == functionComponents.end()) continue;
+        for (const auto& callee : function.calledFunctions) {
+            auto toIt = functionComponents.find(callee);
+            if (toIt != functionComponents.end() && fromIt->second != toIt->second) {
+                ++dependency(fromIt->second, toIt->second).calls;
+            }
+        }
+    }
+
+    // Cycles are the strongly connected components with more than one member
+    std::vector<std::vector<size_t>> adjacency(graph.components.size());
+    for (const auto& edge : graph.dependencies) {
+        adjacency[edge.from].push_back(edge.to);
+    }
+    std::vector<size_t> scc = stronglyConnected(adjacency);
+    std::vector<std::vector<size_t>> members(graph.components.size());
+    for (size_t id = 0; id < graph.components.size(); ++id) {
+        graph.components[id].cycle = scc[id];
+        members[scc[id]].push_back(id);
+    }
+    for (auto& cycle : members) {
+        if (cycle.size() > 1) graph.cycles.push_back(std::move(cycle));
+    }
+
+    // Layers are matched on whole path or namespace parts
+    for (auto& component : graph.components) {
+        for (size_t layer = 0; layer < layers_.size(); ++layer) {
+            const std::string& prefix = layers_[layer];
+            if (component.name.compare(0, prefix.size(), prefix) == 0 &&
+                (component.name.size() == prefix.size() || component.name[prefix.size()] == '/' ||
+                 component.name[prefix.size()] == ':')) {
+                component.layer = static_cast<int>(layer);
+                break;
+            }
+        }
+    }
+
+    for (auto& edge : graph.dependencies) {
+        const Component& from = graph.components[edge.from];
+        const Component& to = graph.components[edge.to];
+        edge.inCycle = from.cycle == to.cycle;
+        edge.violatesLayering = from.layer >= 0 && to.layer >= 0 && from.layer > to.layer;
+    }
+
+    return graph;
+}
+
+std::string ComponentAnalyzer::generateReport(const ComponentGraph& graph) const {
+    std::stringstream ss;
+    ss << "Component Dependencies:\n";
+    ss << "  Components: " << graph.components.size() << ", dependencies: " << graph.dependencies.size()
+       << ", cycles: " << graph.cycles.size() << "\n\n";
+
+    std::vector<size_t> byWeight(graph.dependencies.size());
+    for (size_t i = 0; i < byWeight.size(); ++i) byWeight[i] = i;
+    std::stable_sort(byWeight.begin(), byWeight.end(), [&](size_t a, size_t b) {
+        return graph.dependencies[a].weight() > graph.dependencies[b].weight();
+    });
+
+    ss << "  " << std::setw(8) << "weight" << std::setw(8) << "rels" << std::setw(8) << "calls"
+       << "  dependency\n";
+    for (size_t index : byWeight) {
+        const ComponentDependency& edge = graph.dependencies[index];
+        ss << "  " << std::setw(8) << edge.weight() << std::setw(8) << edge.relationships
+           << std::setw(8) << edge.calls << "  " << graph.components[edge.from].name << " -> "
+           << graph.components[edge.to].name;
+        if (edge.inCycle) ss << "  [cycle]";
+        if (edge.violatesLayering) ss << "  [layering]";
+        ss << "\n";
+    }
+
+    ss << "\nCycles:\n";
+    if (graph.cycles.empty()) ss << "  (none)\n";
+    for (const auto& cycle : graph.cycles) {
+        ss << "  ";
+        for (size_t i = 0; i < cycle.size(); ++i) {
+            if (i > 0) ss << ", ";
+            ss << graph.components[cycle[i]].name;
+        }
+        ss << "\n";
+    }
+
+    if (!layers_.empty()) {
+        ss << "\nLayering Violations:\n";
+        size_t violations = 0;
+        for (const auto& edge : graph.dependencies) {
+            if (!edge.violatesLayering) continue;
+            ss << "  " << graph.components[edge.from].name << " (" << layers_[graph.components[edge.from].layer]
+               << ") -> " << graph.components[edge.to].name << " (" << layers_[graph.components[edge.to].layer]
+               << ")\n";
+            ++violations;
+        }
+        if (violations == 0) ss << "  (none)\n";
+    }
+
+    return ss.str();
+}
+
+} // namespace cpp_diagram
@@ -0,0 +1,150 @@
+#include "analysis/concurrency_analyzer.h"
+#include <algorithm>
+#include <set>
+#include <sstream>
+#include <unordered_map>
+
+namespace cpp_diagram {
+
+ConcurrencyAnalyzer::ConcurrencyAnalyzer() = default;
+ConcurrencyAnalyzer::~ConcurrencyAnalyzer() = default;
+
+void ConcurrencyAnalyzer::setWriteThreshold(int sites) {
+    writeThreshold_ = std::max(sites, 1);
+}
+
+const char* ConcurrencyAnalyzer::syncName(SyncKind sync) {
+    switch (sync) {
+        case SyncKind::Atomic: return "atomic";
+        case SyncKind::Mutex: return "mutex";
+        case SyncKind::Condition: return "condition";
+        case SyncKind::None: break;
+    }
+    return "";
+}
+
+std::vector<ConcurrencyLayout> ConcurrencyAnalyzer::analyze(const std::vector<ClassInfo>& classes,
+                                                            const std::vector<FunctionInfo>& functions) const {
+    // Inline functions are extracted once per TU that sees them; count the
+    // writes of each definition once
+    std::unordered_map<std::string, int> writeSites;
+    std::set<std::string> seenFunctions;
+    for (const auto& function : functions) {
+        if (function.writtenFields.empty()) continue;
+        std::string key = function.qualifiedName + "(";
+        for (const auto& parameter : function.parameters) {
+            key += parameter + ",";
+        }
+        if (!seenFunctions.insert(key).second) continue;
+        for (const auto& field : function.writtenFields) {
+            ++writeSites[field];
+        }
+    }
+
+    std::vector<ConcurrencyLayout> layouts;
+    std::set<std::string> seenClasses;
+    for (const auto& classInfo : classes) {
+        // libstdc++ and glibc wrap their own locks (std::__mutex_base,
+        // the pthread_mutex_t union); only user classes are of interest
+        if (isSystemEntity(classInfo)) continue;
+        bool hasSync = std::any_of(classInfo.fields.begin(), classInfo.fields.end(), [](const FieldInfo& field) {
+            return field.sync != SyncKind::None && !field.isStatic;
+        });
+        if (!hasSync || !classInfo.hasLayout || !seenClasses.insert(classInfo.qualifiedName).second) {
+            continue;
+        }
+
+        ConcurrencyLayout layout;
+        layout.className = classInfo.qualifiedName;
+        layout.size = classInfo.size;
+        for (const auto& field : classInfo.fields) {
+            if (field.isStatic || field.offset < 0) continue;
+            ConcurrencyField entry;
+            entry.name = field.name;
+            entry.type = field.type;
+            entry.offset = field.offset;
+            entry.size = field.size;
+            entry.sync = field.sync;
+            auto it = writeSites.find(classInfo.qualifiedName + "::" + field.name);
+            entry.writeSites = it != writeSites.end() ? it->second : 0;
+            entry.isContended = field.sync != SyncKind::None || entry.writeSites >= writeThreshold_;
+            entry.firstLine = field.offset / kCacheLineSize;
+            entry.lastLine = (field.offset + std::max<int64_t>(field.size, 1) - 1) / kCacheLineSize;
+            layout.fields.push_back(std::move(entry));
+        }
+        std::stable_sort(layout.fields.begin(), layout.fields.end(),
+                         [](const ConcurrencyField& a, const ConcurrencyField& b) { return a.offset < b.offset; });
+
+        // Fields are few, so every contended pair is checked; a pair is
+        // reported on the first line it shares
+        for (size_t i = 0; i < layout.fields.size(); ++i) {
+            const ConcurrencyField& a = layout.fields[i];
+            if (a.sync != SyncKind::None) {
+                ++layout.syncMembers;
+                if (a.lastLine != a.firstLine && a.size <= kCacheLineSize) {
+                    layout.splitFields.push_back(i);
+                }
+            }
+            if (!a.isContended) continue;
+            for (size_t j = i + 1; j < layout.fields.size(); ++j) {
+                const ConcurrencyField& b = layout.fields[j];
+                if (!b.isContended || (a.sync == SyncKind::None && b.sync == SyncKind::None)) continue;
+                int64_t shared = std::max(a.firstLine, b.firstLine);
+                if (shared <= std::min(a.lastLine, b.lastLine)) {
+                    layout.conflicts.push_back({i, j, shared});
+                }
+            }
+        }
+        layouts.push_back(std::move(layout));
+    }
+
+    std::stable_sort(layouts.begin(), layouts.end(), [](const ConcurrencyLayout& a, const ConcurrencyLayout& b) {
+        return a.conflicts.size() + a.splitFields.size() > b.conflicts.size() + b.splitFields.size();
+    });
+    return layouts;
+}
+
+std::string ConcurrencyAnalyzer::generateReport(const std::vector<ConcurrencyLayout>& layouts) const {
+    std::stringstream ss;
+    ss << "Concurrency Layout (cache line = " << kCacheLineSize << " bytes, frequently written = "
+       << writeThreshold_ << "+ write sites):\n\n";
+
+    auto notes = [](const ConcurrencyField& field) {
+        std::string text = field.sync != SyncKind::None ? syncName(field.sync) : "written";
+        if (field.writeSites > 0) {
+            text += ", " + std::to_string(field.writeSites) + (field.writeSites == 1 ? " write" : " writes");
+        }
+        return text;
+    };
+    auto describe = [&](const ConcurrencyField& field) { return field.name + " (" + notes(field) + ")"; };
+
+    for (const auto& layout : layouts) {
+        ss << layout.className << ": size " << layout.size << ", synchronization members "
+           << layout.syncMembers << ", conflicts " << layout.conflicts.size() << "\n";
+        for (const auto& field : layout.fields) {
+            ss << "  [" << field.offset << ".." << field.offset + field.size << ") line " << field.firstLine;
+            if (field.lastLine != field.firstLine) ss << "-" << field.lastLine;
+            ss << "  " << field.name << " : " << field.type;
+            if (field.isContended) ss << "  <-- " << notes(field);
+            ss << "\n";
+        }
+        for (const auto& conflict : layout.conflicts) {
+            ss << "  False sharing on cache line " << conflict.cacheLine << ": "
+               << describe(layout.fields[conflict.first]) << " and "
+               << describe(layout.fields[conflict.second]) << "\n";
+        }
+        for (size_t index : layout.splitFields) {
+            const ConcurrencyField& field = layout.fields[index];
+            ss << "  Split " << syncName(field.sync) << ": " << field.name << " straddles cache lines "
+               << field.firstLine << "-" << field.lastLine << "\n";
+        }
+        if (!layout.conflicts.empty() || !layout.splitFields.empty()) {
+            ss << "  Fix: give each contended member its own cache line, e.g. alignas(" << kCacheLineSize
+               << ") or std::hardware_destructive_interference_size\n";
+        }
+        ss << "\n";
+    }
+    return ss.str();
+}
+
+} // namespace cpp_diagram
@@ -0,0 +1,247 @@
+#include "analysis/devirtualization_analyzer.h"
+#include <algorithm>
+#include <sstream>
+#include <unordered_map>
+
+namespace cpp_diagram {
+
+namespace {
+
+bool isCanonical(const ModelIndex& index, size_t id) {
+    return index.findClass(index.classAt(id).qualifiedName) == id;
+}
+
+const char* kindName(DevirtualizationKind kind) {
+    switch (kind) {
+        case DevirtualizationKind::SingleImplementation: return "single implementation";
+        case DevirtualizationKind::NeverOverridden: return "never overridden";
+        case DevirtualizationKind::FinalClass: return "final candidate";
+    }
+    return "";
+}
+
+} // namespace
+
+DevirtualizationAnalyzer::DevirtualizationAnalyzer() = default;
+DevirtualizationAnalyzer::~DevirtualizationAnalyzer() = default;
+
+void DevirtualizationAnalyzer::setHotFunctions(const std::vector<std::string>& hotFunctions) {
+    hotFunctions_.clear();
+    hotFunctions_.insert(hotFunctions.begin(), hotFunctions.end());
+}
+
+std::vector<DevirtualizationCandidate> DevirtualizationAnalyzer::analyze(const ModelIndex& index) const {
+    std::vector<DevirtualizationCandidate> candidates;
+
+    // Group every virtual declaration by signature so overriders are found
+    // without walking each subtree
+    std::unordered_map<std::string, std::vector<ModelIndex::MethodRef>> declarations;
+    for (size_t id = 0; id < index.classCount(); ++id) {
+        if (!isCanonical(index, id)) continue;
+        const auto& methods = index.classAt(id).methods;
+        for (size_t m = 0; m < methods.size(); ++m) {
+            if (methods[m].isVirtual && !methods[m].isDestructor) {
+                declarations[ModelIndex::signature(methods[m])].push_back({id, m});
+            }
+        }
+    }
+
+    for (size_t id = 0; id < index.classCount(); ++id) {
+        // Standard library hierarchies are not ours to seal; their methods
+        // still count as overridden by user classes above
+        if (!isCanonical(index, id) || isSystemEntity(index.classAt(id))) continue;
+        const ClassInfo& classInfo = index.classAt(id);
+
+        // Methods introduced by this class
+        for (const auto& method : classInfo.methods) {
+            if (!method.isVirtual || method.isDestructor || method.isOverride || method.isFinal ||
+                isSystemEntity(method)) {
+                continue;
+            }
+
+            std::vector<std::string> implementations;
+            if (!method.isPureVirtual) {
+                implementations.push_back(method.qualifiedName);
+            }
+            int overriders = 0;
+            for (const auto& ref : declarations[ModelIndex::signature(method)]) {
+                if (ref.classId == id || !index.isSubclassOf(ref.classId, id)) continue;
+                ++overriders;
+                if (!index.methodAt(ref).isPureVirtual) {
+                    implementations.push_back(index.methodAt(ref).qualifiedName);
+                }
+            }
+
+            DevirtualizationCandidate candidate;
+            candidate.className = classInfo.qualifiedName;
+            candidate.method = method.qualifiedName;
+            if (overriders == 0 && !method.isPureVirtual) {
+                candidate.kind = DevirtualizationKind::NeverOverridden;
+            } else if (implementations.size() == 1) {
+                candidate.kind = DevirtualizationKind::SingleImplementation;
+                candidate.implementation = implementations[0];
+            } else {
+                continue;
+            }
+            candidates.push_back(candidate);
+        }
+
+        // Leaf classes that could be sealed
+        bool hasVirtual = std::any_of(classInfo.methods.begin(), classInfo.methods.end(),
+                                      [](const MethodInfo& method) { return method.isVirtual; });
+        if (hasVirtual && !classInfo.isFinal && !classInfo.isAbstract &&
+            index.derivedClasses(id).empty()) {
+            DevirtualizationCandidate candidate;
+            candidate.kind = DevirtualizationKind::FinalClass;
+            candidate.className = classInfo.qualifiedName;
+            candidates.push_back(candidate);
+        }
+    }
+
+    countCallSites(index, candidates);
+
+    // Hot call sites dominate; method-level findings beat class-level ones
+    for (auto& candidate : candidates) {
+        candidate.score = candidate.hotCallSites * 10.0 + candidate.callSites +
+                          (candidate.kind == DevirtualizationKind::FinalClass ? 0.0 : 0.5);
+    }
+    std::stable_sort(candidates.begin(), candidates.end(),
+        [](const DevirtualizationCandidate& a, const DevirtualizationCandidate& b) {
+            if (a.score != b.score) return a.score > b.score;
+            if (a.className != b.className) return a.className < b.className;
+            return a.method < b.method;
+        });
+
+    return candidates;
+}
+
+void DevirtualizationAnalyzer::countCallSites(const ModelIndex& index,
+                                              std::vector<DevirtualizationCandidate>& candidates) const {
+    std::unordered_map<std::string, std::vector<size_t>> byMethod;
+    std::unordered_map<std::string, size_t> byClass;
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        if (candidates[i].kind == DevirtualizationKind::FinalClass) {
+            byClass[candidates[i].className] = i;
+        } else {
+            byMethod[candidates[i].method].push_back(i);
+        }
+    }
+
+    for (size_t f = 0; f < index.functionCount(); ++f) {
+        const FunctionInfo& caller = index.functionAt(f);
+        bool hot = hotFunctions_.count(caller.qualifiedName) > 0;
+
+        for (const auto& callee : caller.calledFunctions) {
+            const auto& refs = index.findMethods(callee);
+            if (refs.empty() || !index.methodAt(refs.front()).isVirtual) {
+                continue;
+            }
+
+            std::vector<size_t> hits;
+            auto methodIt = byMethod.find(callee);
+            if (methodIt != byMethod.end()) {
+                hits = methodIt->second;
+            }
+            auto classIt = byClass.find(index.classAt(refs.front().classId).qualifiedName);
+            if (classIt != byClass.end()) {
+                hits.push_back(classIt->second);
+            }
+
+            for (size_t i : hits) {
+                auto& candidate = candidates[i];
+                ++candidate.callSites;
+                if (hot) {
+                    ++candidate.hotCallSites;
+                    if (std::find(candidate.hotCallers.begin(), candidate.hotCallers.end(),
+                                  caller.qualifiedName) == candidate.hotCallers.end()) {
+                        candidate.hotCallers.push_back(caller.qualifiedName);
+                    }
+                }
+            }
+        }
+    }
+}
+
+HierarchyStats DevirtualizationAnalyzer::hierarchyStats(const ModelIndex& index) const {
+    HierarchyStats stats;
+
+    // Longest path from a root, computed in topological order
+    std::vector<int> depth(index.classCount(), 0);
+    std::vector<size_t> pendingBases(index.classCount(), 0);
+    std::vector<size_t> ready;
+    // System classes are walked so user classes deriving from them get
+    // their depth, but are not counted
+    std::vector<char> system(index.classCount(), 0);
+    for (size_t id = 0; id < index.classCount(); ++id) {
+        if (!isCanonical(index, id)) continue;
+        system[id] = isSystemEntity(index.classAt(id));
+        if (!system[id]) {
+            ++stats.classes;
+            for (const auto& method : index.classAt(id).methods) {
+                if (method.isVirtual) ++stats.virtualMethods;
+            }
+        }
+        pendingBases[id] = index.baseClasses(id).size();
+        if (pendingBases[id] == 0) {
+            if (!system[id]) ++stats.roots;
+            ready.push_back(id);
+        }
+    }
+
+    while (!ready.empty()) {
+        size_t id = ready.back();
+        ready.pop_back();
+        if (!system[id]) stats.maxDepth = std::max(stats.maxDepth, depth[id]);
+        for (size_t derivedId : index.derivedClasses(id)) {
+            depth[derivedId] = std::max(depth[derivedId], depth[id] + 1);
+            if (--pendingBases[derivedId] == 0) {
+                ready.push_back(derivedId);
+            }
+        }
+    }
+
+    return stats;
+}
+
+std::string DevirtualizationAnalyzer::generateReport(const std::vector<DevirtualizationCandidate>& candidates,
+                                                     const HierarchyStats& stats) const {
+    std::stringstream ss;
+
+    ss << "Devirtualization Opportunities:\n";
+    ss << "  Classes: " << stats.classes << ", hierarchy roots: " << stats.roots
+       << ", max depth: " << stats.maxDepth << ", virtual methods: " << stats.virtualMethods << "\n\n";
+
+    if (candidates.empty()) {
+        ss << "  No candidates found.\n";
+        return ss.str();
+    }
+
+    int rank = 1;
+    for (const auto& candidate : candidates) {
+        ss << "  " << rank++ << ". [" << kindName(candidate.kind) << "] ";
+        switch (candidate.kind) {
+            case DevirtualizationKind::SingleImplementation:
+                ss << candidate.method << " -> " << candidate.implementation;
+                break;
+            case DevirtualizationKind::NeverOverridden:
+                ss << candidate.method << " (drop virtual or mark final)";
+                break;
+            case DevirtualizationKind::FinalClass:
+                ss << candidate.className << " (mark class final)";
+                break;
+        }
+        ss << "\n     call sites: " << candidate.callSites
+           << ", hot call sites: " << candidate.hotCallSites << "\n";
+        if (!candidate.hotCallers.empty()) {
+            ss << "     hot callers:";
+            for (const auto& caller : candidate.hotCallers) {
+                ss << " " << caller;
+            }
+            ss << "\n";
+        }
+    }
+
+    return ss.str();
+}
+
+} // namespace cpp_diagram
@@ -0,0 +1,58 @@
+#include "analysis/graph_algorithms.h"
+#include <algorithm>
+#include <utility>
+
+namespace cpp_diagram {
+
+// Tarjan's algorithm, iteratively so long chains cannot overflow the stack
+std::vector<size_t> stronglyConnected(const std::vector<std::vector<size_t>>& adjacency) {
+    const size_t unvisited = static_cast<size_t>(-1);
+    size_t count = adjacency.size();
+    std::vector<size_t> order(count, unvisited), low(count, 0), scc(count, unvisited);
+    std::vector<bool> onStack(count, false);
+    std::vector<size_t> stack;
+    std::vector<std::pair<size_t, size_t>> work;  // node, next edge
+    size_t nextOrder = 0;
+    size_t nextScc = 0;
+
+    for (size_t root = 0; root < count; ++root) {
+        if (order[root] != unvisited) continue;
+        work.push_back({root, 0});
+        while (!work.empty()) {
+            auto& [node, edge] = work.back();
+            if (edge == 0 && order[node] == unvisited) {
+                order[node] = low[node] = nextOrder++;
+                stack.push_back(node);
+                onStack[node] = true;
+            }
+            if (edge < adjacency[node].size()) {
+                size_t next = adjacency[node][edge++];
+                if (order[next] == unvisited) {
+                    work.push_back({next, 0});
+                } else if (onStack[next]) {
+                    low[node] = std::min(low[node], order[next]);
+                }
+                continue;
+            }
+
+            size_t done = node;
+            work.pop_back();
+            if (!work.empty()) {
+                low[work.back().first] = std::min(low[work.back().first], low[done]);
+            }
+            if (low[done] == order[done]) {
+                size_t member;
+                do {
+                    member = stack.back();
+                    stack.pop_back();
+                    onStack[member] = false;
+                    scc[member] = nextScc;
+                } while (member != done);
+                ++nextScc;
+            }
+        }
+    }
+    return scc;
+}
+
+} // namespace cpp_diagram
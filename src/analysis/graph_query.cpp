@@ -0,0 +1,567 @@
+#include "analysis/graph_query.h"
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+#include <unordered_set>
+
+namespace cpp_diagram {
+
+namespace {
+
+constexpr size_t kNone = static_cast<size_t>(-1);
+
+// Parsing and matching recurse once per level of the condition tree, so a
+// query cannot nest deeper than this
+constexpr size_t kMaxDepth = 256;
+
+// Relations that take a class name; the others take a function name
+const std::vector<std::string> kClassArgumentRelations = {"derives", "base_of", "uses", "used_by", "member_of"};
+
+bool contains(const std::vector<std::string>& names, const std::string& name) {
+    return std::find(names.begin(), names.end(), name) != names.end();
+}
+
+bool isWordChar(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == ':' || c == '*' ||
+           c == '.' || c == '/' || c == '-';
+}
+
+// Canonical ids of the classes or functions an argument names
+std::vector<size_t> resolveClasses(const ModelIndex& index, const std::string& name) {
+    std::vector<size_t> ids;
+    if (name.find('*') == std::string::npos) {
+        size_t id = index.findClass(name);
+        if (id != ModelIndex::npos) ids.push_back(id);
+        return ids;
+    }
+    for (size_t id = 0; id < index.classCount(); ++id) {
+        const std::string& qualifiedName = index.classAt(id).qualifiedName;
+        if (index.isCanonicalClass(id) && globMatch(name, qualifiedName)) ids.push_back(id);
+    }
+    return ids;
+}
+
+std::vector<size_t> resolveFunctions(const ModelIndex& index, const std::string& name) {
+    std::vector<size_t> ids;
+    if (name.find('*') == std::string::npos) {
+        size_t id = index.findFunction(name);
+        if (id != ModelIndex::npos) ids.push_back(id);
+        return ids;
+    }
+    for (size_t id = 0; id < index.functionCount(); ++id) {
+        const std::string& qualifiedName = index.functionAt(id).qualifiedName;
+        if (index.isCanonicalFunction(id) && globMatch(name, qualifiedName)) ids.push_back(id);
+    }
+    return ids;
+}
+
+// Everything reachable from the seeds in one or more steps; a seed is only
+// included when a cycle leads back to it
+template <typename Neighbours>
+std::vector<char> reachable(const std::vector<size_t>& seeds, size_t count, Neighbours neighbours) {
+    std::vector<char> reached(count, 0);
+    std::vector<size_t> pending(seeds);
+    while (!pending.empty()) {
+        size_t id = pending.back();
+        pending.pop_back();
+        for (size_t next : neighbours(id)) {
+            if (!reached[next]) {
+                reached[next] = 1;
+                pending.push_back(next);
+            }
+        }
+    }
+    return reached;
+}
+
+// Attributes and flags, resolved from their names when a query is compiled
+// so matching an entity does not compare strings
+enum Attribute {
+    AttributeName, AttributeFile, AttributeMethods, AttributeFields, AttributeBases, AttributeDerived,
+    AttributeRelationships, AttributeSize, AttributeFindings, AttributeCalls, AttributeCallers,
+    AttributeParams, AttributeWrites, FlagAbstract, FlagTemplate, FlagFinal, FlagMethod
+};
+
+enum Comparison { Equal, NotEqual, Less, LessEqual, Greater, GreaterEqual, Like };
+
+int comparisonCode(const std::string& op) {
+    static const std::vector<std::string> ops = {"=", "!=", "<", "<=", ">", ">=", "~"};
+    return static_cast<int>(std::find(ops.begin(), ops.end(), op) - ops.begin());
+}
+
+int attributeCode(const std::string& name) {
+    static const std::vector<std::string> names = {
+        "name", "file", "methods", "fields", "bases", "derived", "relationships", "size", "findings",
+        "calls", "callers", "params", "writes", "abstract", "template", "final", "method"
+    };
+    return static_cast<int>(std::find(names.begin(), names.end(), name) - names.begin());
+}
+
+std::string targetName(QueryTarget target) {
+    return target == QueryTarget::Classes ? "classes" : "functions";
+}
+
+} // namespace
+
+struct GraphQuery::Token {
+    enum Kind { Word, String, Number, Op, LParen, RParen, End } kind;
+    std::string text;
+    size_t offset;
+};
+
+bool globMatch(const std::string& pattern, const std::string& text) {
+    size_t p = 0;
+    size_t t = 0;
+    size_t star = std::string::npos;
+    size_t resume = 0;
+    while (t < text.size()) {
+        if (p < pattern.size() && pattern[p] == '*') {
+            star = p++;
+            resume = t;
+        } else if (p < pattern.size() && pattern[p] == text[t]) {
+            ++p;
+            ++t;
+        } else if (star != std::string::npos) {
+            p = star + 1;
+            t = ++resume;
+        } else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == '*') ++p;
+    return p == pattern.size();
+}
+
+GraphQuery::GraphQuery() = default;
+GraphQuery::~GraphQuery() = default;
+
+std::vector<std::string> GraphQuery::attributes(QueryTarget target) {
+    if (target == QueryTarget::Classes) {
+        return {"name", "file", "methods", "fields", "bases", "derived", "relationships", "size", "findings"};
+    }
+    return {"name", "file", "calls", "callers", "params", "writes", "findings"};
+}
+
+std::vector<std::string> GraphQuery::flags(QueryTarget target) {
+    if (target == QueryTarget::Classes) {
+        return {"abstract", "template", "final"};
+    }
+    return {"template", "method"};
+}
+
+std::vector<std::string> GraphQuery::relations(QueryTarget target) {
+    if (target == QueryTarget::Classes) {
+        return {"derives", "base_of", "uses", "used_by", "calls", "reaches", "reachable_from"};
+    }
+    return {"calls", "called_by", "reaches", "reachable_from", "member_of"};
+}
+
+size_t GraphQuery::fail(const Token& token, const std::string& message) {
+    if (error_.empty()) {
+        error_ = message + " at column " + std::to_string(token.offset + 1);
+    }
+    return kNone;
+}
+
+bool GraphQuery::compile(const std::string& text) {
+    text_ = text;
+    error_.clear();
+    nodes_.clear();
+    nesting_ = 0;
+    hasCondition_ = false;
+
+    std::vector<Token> tokens;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        char c = text[pos];
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            ++pos;
+        } else if (c == '(' || c == ')') {
+            tokens.push_back({c == '(' ? Token::LParen : Token::RParen, std::string(1, c), pos++});
+        } else if (c == '"' || c == '\'') {
+            size_t end = text.find(c, pos + 1);
+            if (end == std::string::npos) {
+                error_ = "unterminated string at column " + std::to_string(pos + 1);
+                return false;
+            }
+            tokens.push_back({Token::String, text.substr(pos + 1, end - pos - 1), pos});
+            pos = end + 1;
+        } else if (c == '<' || c == '>' || c == '!' || c == '=' || c == '~') {
+            size_t length = pos + 1 < text.size() && text[pos + 1] == '=' && c != '=' && c != '~' ? 2 : 1;
+            std::string op = text.substr(pos, length);
+            if (op == "!") {
+                error_ = "expected != at column " + std::to_string(pos + 1);
+                return false;
+            }
+            tokens.push_back({Token::Op, op, pos});
+            pos += length;
+        } else if (isWordChar(c)) {
+            size_t start = pos;
+            while (pos < text.size() && isWordChar(text[pos])) ++pos;
+            std::string word = text.substr(start, pos - start);
+            bool number = std::all_of(word.begin(), word.end(),
+                                      [](char d) { return std::isdigit(static_cast<unsigned char>(d)); });
+            tokens.push_back({number ? Token::Number : Token::Word, word, start});
+        } else {
+            error_ = std::string("unexpected '") + c + "' at column " + std::to_string(pos + 1);
+            return false;
+        }
+    }
+    tokens.push_back({Token::End, "", text.size()});
+
+    pos = 0;
+    if (tokens[pos].kind != Token::Word || (tokens[pos].text != "classes" && tokens[pos].text != "functions")) {
+        fail(tokens[pos], "expected 'classes' or 'functions'");
+        return false;
+    }
+    target_ = tokens[pos++].text == "classes" ? QueryTarget::Classes : QueryTarget::Functions;
+
+    if (tokens[pos].kind == Token::Word && tokens[pos].text == "where") {
+        ++pos;
+        root_ = parseOr(tokens, pos);
+        if (root_ == kNone) return false;
+        hasCondition_ = true;
+    }
+    if (tokens[pos].kind != Token::End) {
+        fail(tokens[pos], "unexpected '" + tokens[pos].text + "'");
+        return false;
+    }
+    return true;
+}
+
+size_t GraphQuery::parseOr(const std::vector<Token>& tokens, size_t& pos) {
+    size_t left = parseAnd(tokens, pos);
+    while (left != kNone && tokens[pos].kind == Token::Word && tokens[pos].text == "or") {
+        const Token& op = tokens[pos++];
+        size_t right = parseAnd(tokens, pos);
+        if (right == kNone) return kNone;
+        Node node;
+        node.kind = NodeKind::Or;
+        node.left = left;
+        node.right = right;
+        node.depth = std::max(nodes_[left].depth, nodes_[right].depth) + 1;
+        if (node.depth > kMaxDepth) return fail(op, "condition nests too deeply");
+        nodes_.push_back(node);
+        left = nodes_.size() - 1;
+    }
+    return left;
+}
+
+size_t GraphQuery::parseAnd(const std::vector<Token>& tokens, size_t& pos) {
+    size_t left = parseFactor(tokens, pos);
+    while (left != kNone && tokens[pos].kind == Token::Word && tokens[pos].text == "and") {
+        const Token& op = tokens[pos++];
+        size_t right = parseFactor(tokens, pos);
+        if (right == kNone) return kNone;
+        Node node;
+        node.kind = NodeKind::And;
+        node.left = left;
+        node.right = right;
+        node.depth = std::max(nodes_[left].depth, nodes_[right].depth) + 1;
+        if (node.depth > kMaxDepth) return fail(op, "condition nests too deeply");
+        nodes_.push_back(node);
+        left = nodes_.size() - 1;
+    }
+    return left;
+}
+
+size_t GraphQuery::parseFactor(const std::vector<Token>& tokens, size_t& pos) {
+    const Token& token = tokens[pos];
+    if (token.kind == Token::LParen) {
+        if (nesting_ == kMaxDepth) return fail(token, "condition nests too deeply");
+        ++pos;
+        ++nesting_;
+        size_t inner = parseOr(tokens, pos);
+        --nesting_;
+        if (inner == kNone) return kNone;
+        if (tokens[pos].kind != Token::RParen) return fail(tokens[pos], "expected ')'");
+        ++pos;
+        return inner;
+    }
+    if (token.kind != Token::Word) {
+        return fail(token, "expected a condition");
+    }
+    ++pos;
+
+    Node node;
+    node.name = token.text;
+    if (token.text == "not") {
+        if (nesting_ == kMaxDepth) return fail(token, "condition nests too deeply");
+        ++nesting_;
+        size_t operand = parseFactor(tokens, pos);
+        --nesting_;
+        if (operand == kNone) return kNone;
+        node.kind = NodeKind::Not;
+        node.left = operand;
+        node.depth = nodes_[operand].depth + 1;
+        if (node.depth > kMaxDepth) return fail(token, "condition nests too deeply");
+    } else if (tokens[pos].kind == Token::LParen) {
+        if (!contains(relations(target_), token.text)) {
+            return fail(token, "unknown relation '" + token.text + "' for " + targetName(target_));
+        }
+        const Token& argument = tokens[pos + 1];
+        if (argument.kind != Token::Word && argument.kind != Token::String && argument.kind != Token::Number) {
+            return fail(argument, "expected a name");
+        }
+        if (tokens[pos + 2].kind != Token::RParen) return fail(tokens[pos + 2], "expected ')'");
+        pos += 3;
+        node.kind = NodeKind::Relation;
+        node.value = argument.text;
+    } else if (tokens[pos].kind == Token::Op) {
+        const Token& op = tokens[pos];
+        const Token& value = tokens[pos + 1];
+        if (!contains(attributes(target_), token.text)) {
+            return fail(token, "unknown attribute '" + token.text + "' for " + targetName(target_));
+        }
+        if (value.kind != Token::Word && value.kind != Token::String && value.kind != Token::Number) {
+            return fail(value, "expected a value");
+        }
+        bool textual = token.text == "name" || token.text == "file";
+        if (textual && op.text != "=" && op.text != "!=" && op.text != "~") {
+            return fail(op, "'" + token.text + "' only compares with =, != or ~");
+        }
+        if (!textual && (value.kind != Token::Number || op.text == "~" || value.text.size() > 18)) {
+            return fail(value, "'" + token.text + "' compares with a number");
+        }
+        pos += 2;
+        node.kind = NodeKind::Compare;
+        node.code = attributeCode(token.text);
+        node.op = comparisonCode(op.text);
+        node.value = value.text;
+        node.glob = value.text.find('*') != std::string::npos;
+        node.numeric = !textual;
+        node.number = node.numeric ? std::stoll(value.text) : 0;
+    } else {
+        if (!contains(flags(target_), token.text)) {
+            return fail(token, "unknown flag '" + token.text + "' for " + targetName(target_));
+        }
+        node.kind = NodeKind::Flag;
+        node.code = attributeCode(token.text);
+    }
+    nodes_.push_back(node);
+    return nodes_.size() - 1;
+}
+
+std::vector<std::vector<char>> GraphQuery::evaluateRelations(const ModelIndex& index) const {
+    std::vector<std::vector<char>> masks(nodes_.size());
+    size_t classCount = index.classCount();
+    size_t functionCount = index.functionCount();
+    auto callees = [&](size_t id) { return index.callees(id); };
+    auto callers = [&](size_t id) { return index.callers(id); };
+
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+        const Node& node = nodes_[i];
+        if (node.kind != NodeKind::Relation) continue;
+        const std::string& relation = node.name;
+        bool classArgument = contains(kClassArgumentRelations, relation);
+        std::vector<size_t> seeds =
+            classArgument ? resolveClasses(index, node.value) : resolveFunctions(index, node.value);
+
+        // Function relations yield functions; for classes they are lifted
+        // to the classes owning a matching method
+        std::vector<char> functions;
+        std::vector<char>& mask = masks[i];
+        if (relation == "derives") {
+            mask = reachable(seeds, classCount, [&](size_t id) -> const std::vector<size_t>& {
+                return index.derivedClasses(id);
+            });
+        } else if (relation == "base_of") {
+            mask = reachable(seeds, classCount, [&](size_t id) -> const std::vector<size_t>& {
+                return index.baseClasses(id);
+            });
+        } else if (relation == "uses" || relation == "used_by") {
+            mask.assign(classCount, 0);
+            bool incoming = relation == "uses";
+            for (size_t seed : seeds) {
+                const auto& edges = incoming ? index.incomingRelationships(seed) : index.outgoingRelationships(seed);
+                for (size_t edge : edges) {
+                    const RelationshipInfo& relationship = index.relationshipAt(edge);
+                    size_t other = index.findClass(incoming ? relationship.fromClass : relationship.toClass);
+                    if (other != ModelIndex::npos && other != seed) mask[other] = 1;
+                }
+            }
+        } else if (relation == "member_of") {
+            mask.assign(functionCount, 0);
+            for (size_t seed : seeds) {
+                for (const auto& method : index.classAt(seed).methods) {
+                    size_t id = index.findFunction(method.qualifiedName);
+                    if (id != ModelIndex::npos) mask[id] = 1;
+                }
+            }
+        } else if (relation == "calls") {
+            functions.assign(functionCount, 0);
+            for (size_t seed : seeds) {
+                for (size_t caller : index.callers(seed)) functions[caller] = 1;
+            }
+        } else if (relation == "called_by") {
+            functions.assign(functionCount, 0);
+            for (size_t seed : seeds) {
+                for (size_t callee : index.callees(seed)) functions[callee] = 1;
+            }
+        } else if (relation == "reaches") {
+            functions = reachable(seeds, functionCount, callers);
+        } else if (relation == "reachable_from") {
+            functions = reachable(seeds, functionCount, callees);
+        }
+
+        if (!functions.empty()) {
+            if (target_ == QueryTarget::Functions) {
+                mask = std::move(functions);
+            } else {
+                mask.assign(classCount, 0);
+                for (size_t id = 0; id < functionCount; ++id) {
+                    if (!functions[id]) continue;
+                    size_t owner = index.ownerClass(id);
+                    if (owner != ModelIndex::npos) mask[owner] = 1;
+                }
+            }
+        }
+    }
+    return masks;
+}
+
+bool GraphQuery::matches(const ModelIndex& index, size_t id, size_t nodeId,
+                         const std::vector<std::vector<char>>& relationMasks) const {
+    const Node& node = nodes_[nodeId];
+    switch (node.kind) {
+        case NodeKind::And:
+            return matches(index, id, node.left, relationMasks) && matches(index, id, node.right, relationMasks);
+        case NodeKind::Or:
+            return matches(index, id, node.left, relationMasks) || matches(index, id, node.right, relationMasks);
+        case NodeKind::Not:
+            return !matches(index, id, node.left, relationMasks);
+        case NodeKind::Relation:
+            return relationMasks[nodeId][id] != 0;
+        case NodeKind::Flag:
+        case NodeKind::Compare:
+            break;
+    }
+
+    bool isClass = target_ == QueryTarget::Classes;
+    switch (node.code) {
+        case FlagAbstract: return index.classAt(id).isAbstract;
+        case FlagFinal: return index.classAt(id).isFinal;
+        case FlagTemplate: return isClass ? index.classAt(id).isTemplate : index.functionAt(id).isTemplate;
+        case FlagMethod: return index.ownerClass(id) != ModelIndex::npos;
+        default: break;
+    }
+
+    if (!node.numeric) {
+        const std::string& text = node.code == AttributeName
+            ? (isClass ? index.classAt(id).qualifiedName : index.functionAt(id).qualifiedName)
+            : (isClass ? index.classAt(id).file : index.functionAt(id).file);
+        if (node.op == Like) {
+            return node.glob ? globMatch(node.value, text) : text.find(node.value) != std::string::npos;
+        }
+        return (text == node.value) == (node.op == Equal);
+    }
+
+    int64_t value = 0;
+    switch (node.code) {
+        case AttributeMethods: value = static_cast<int64_t>(index.classAt(id).methods.size()); break;
+        case AttributeFields: value = static_cast<int64_t>(index.classAt(id).fields.size()); break;
+        case AttributeBases: value = static_cast<int64_t>(index.baseClasses(id).size()); break;
+        case AttributeDerived: value = static_cast<int64_t>(index.derivedClasses(id).size()); break;
+        case AttributeRelationships: value = static_cast<int64_t>(index.outgoingRelationships(id).size()); break;
+        case AttributeSize: value = index.classAt(id).size; break;
+        case AttributeCalls: value = static_cast<int64_t>(index.callees(id).size()); break;
+        case AttributeCallers: value = static_cast<int64_t>(index.callers(id).size()); break;
+        case AttributeParams: value = static_cast<int64_t>(index.functionAt(id).parameters.size()); break;
+        case AttributeWrites: value = static_cast<int64_t>(index.functionAt(id).writtenFields.size()); break;
+        case AttributeFindings:
+            if (isClass) {
+                const ClassInfo& classInfo = index.classAt(id);
+                value = static_cast<int64_t>(classInfo.perfFindings.size());
+                for (const auto& method : classInfo.methods) {
+                    value += static_cast<int64_t>(method.perfFindings.size());
+                }
+            } else {
+                value = static_cast<int64_t>(index.functionAt(id).perfFindings.size());
+            }
+            break;
+        default: break;
+    }
+
+    switch (node.op) {
+        case Equal: return value == node.number;
+        case NotEqual: return value != node.number;
+        case Less: return value < node.number;
+        case LessEqual: return value <= node.number;
+        case Greater: return value > node.number;
+        default: return value >= node.number;
+    }
+}
+
+QueryResult GraphQuery::run(const ModelIndex& index) const {
+    QueryResult result;
+    result.target = target_;
+    std::vector<std::vector<char>> relationMasks = evaluateRelations(index);
+
+    // Classes and functions repeated across TUs are matched once, through
+    // the canonical id the index resolves their name to
+    bool isClass = target_ == QueryTarget::Classes;
+    size_t count = isClass ? index.classCount() : index.functionCount();
+    for (size_t id = 0; id < count; ++id) {
+        if (isClass ? !index.isCanonicalClass(id) : !index.isCanonicalFunction(id)) continue;
+        if (!hasCondition_ || matches(index, id, root_, relationMasks)) {
+            result.ids.push_back(id);
+        }
+    }
+    return result;
+}
+
+void GraphQuery::select(const ModelIndex& index, const QueryResult& result,
+                        std::vector<ClassInfo>& classes, std::vector<FunctionInfo>& functions,
+                        std::vector<RelationshipInfo>& relationships) {
+    std::vector<char> keepClass(index.classCount(), 0);
+    std::vector<char> keepFunction(index.functionCount(), 0);
+    for (size_t id : result.ids) {
+        if (result.target == QueryTarget::Classes) {
+            keepClass[id] = 1;
+            for (const auto& method : index.classAt(id).methods) {
+                size_t functionId = index.findFunction(method.qualifiedName);
+                if (functionId != ModelIndex::npos) keepFunction[functionId] = 1;
+            }
+        } else {
+            keepFunction[id] = 1;
+            size_t owner = index.ownerClass(id);
+            if (owner != ModelIndex::npos) keepClass[owner] = 1;
+        }
+    }
+
+    std::vector<ClassInfo> selectedClasses;
+    for (size_t id = 0; id < index.classCount(); ++id) {
+        if (keepClass[id]) selectedClasses.push_back(index.classAt(id));
+    }
+    std::vector<FunctionInfo> selectedFunctions;
+    for (size_t id = 0; id < index.functionCount(); ++id) {
+        if (keepFunction[id]) selectedFunctions.push_back(index.functionAt(id));
+    }
+    std::vector<RelationshipInfo> selectedRelationships;
+    for (size_t i = 0; i < index.relationshipCount(); ++i) {
+        const RelationshipInfo& relationship = index.relationshipAt(i);
+        size_t fromId = index.findClass(relationship.fromClass);
+        size_t toId = index.findClass(relationship.toClass);
+        if (fromId != ModelIndex::npos && toId != ModelIndex::npos && keepClass[fromId] && keepClass[toId]) {
+            selectedRelationships.push_back(relationship);
+        }
+    }
+
+    // The inputs may be the vectors the index refers to, so replace them last
+    classes = std::move(selectedClasses);
+    functions = std::move(selectedFunctions);
+    relationships = std::move(selectedRelationships);
+}
+
+std::string GraphQuery::generateReport(const ModelIndex& index, const QueryResult& result) const {
+    std::stringstream ss;
+    bool isClass = result.target == QueryTarget::Classes;
+    ss << "Query: " << text_ << "\n";
+    ss << "  Matches: " << result.ids.size() << " " << targetName(result.target) << "\n\n";
+    for (size_t id : result.ids) {
+        ss << "  " << (isClass ? index.classAt(id).qualifiedName : index.functionAt(id).qualifiedName) << "\n";
+    }
+    return ss.str();
+}
+
+} // namespace cpp_diagram
@@ -0,0 +1,143 @@
+#include "analysis/include_analyzer.h"
+#include "analysis/graph_algorithms.h"
+#include <algorithm>
+#include <bitset>
+#include <cstdint>
+#include <iomanip>
+#include <sstream>
+#include <unordered_map>
+
+namespace cpp_diagram {
+
+namespace {
+
+// Files that include each header directly or through other headers. Include
+// cycles are collapsed first; the includer set of a component is then the
+// union of its direct includers' sets, which are complete by the time it is
+// visited because includers are numbered first. A component's bitset is
+// freed once every header it includes has read it, so memory peaks at one
+// bitset (a bit per file) per component still waiting on its includees:
+// small for layered include graphs, but V²/64 words in the worst case.
+std::vector<int64_t> transitiveFanIn(const std::vector<HeaderInfo>& headers) {
+    std::unordered_map<std::string, size_t> ids;
+    for (size_t id = 0; id < headers.size(); ++id) {
+        ids.emplace(headers[id].path, id);
+    }
+    std::vector<std::vector<size_t>> includers(headers.size());
+    for (size_t id = 0; id < headers.size(); ++id) {
+        for (const auto& includer : headers[id].includedBy) {
+            auto it = ids.find(includer);
+            if (it != ids.end() && it->second != id) includers[id].push_back(it->second);
+        }
+    }
+
+    std::vector<size_t> component = stronglyConnected(includers);
+    size_t components = 0;
+    for (size_t c : component) components = std::max(components, c + 1);
+    std::vector<std::vector<size_t>> members(components);
+    for (size_t id = 0; id < headers.size(); ++id) {
+        members[component[id]].push_back(id);
+    }
+
+    // Reads of each component's bitset still to come, one per include edge
+    // leaving it
+    std::vector<size_t> pendingReads(components, 0);
+    for (size_t id = 0; id < headers.size(); ++id) {
+        for (size_t includer : includers[id]) {
+            if (component[includer] != component[id]) ++pendingReads[component[includer]];
+        }
+    }
+
+    // One bit per file
+    size_t words = (headers.size() + 63) / 64;
+    std::vector<std::vector<uint64_t>> reachedBy(components);
+    std::vector<int64_t> fanIn(headers.size(), 0);
+    for (size_t c = 0; c < components; ++c) {
+        std::vector<uint64_t>& bits = reachedBy[c];
+        bits.assign(words, 0);
+        for (size_t id : members[c]) {
+            if (members[c].size() > 1) bits[id / 64] |= uint64_t(1) << (id % 64);
+            for (size_t includer : includers[id]) {
+                bits[includer / 64] |= uint64_t(1) << (includer % 64);
+                size_t from = component[includer];
+                if (from == c) continue;
+                std::vector<uint64_t>& inherited = reachedBy[from];
+                for (size_t w = 0; w < words; ++w) bits[w] |= inherited[w];
+                if (--pendingReads[from] == 0) std::vector<uint64_t>().swap(inherited);
+            }
+        }
+        int64_t count = 0;
+        for (uint64_t word : bits) count += static_cast<int64_t>(std::bitset<64>(word).count());
+        for (size_t id : members[c]) {
+            fanIn[id] = members[c].size() > 1 ? count - 1 : count;  // not itself
+        }
+        if (pendingReads[c] == 0) std::vector<uint64_t>().swap(bits);
+    }
+    return fanIn;
+}
+
+} // namespace
+
+IncludeAnalyzer::IncludeAnalyzer() = default;
+IncludeAnalyzer::~IncludeAnalyzer() = default;
+
+std::vector<HeaderCost> IncludeAnalyzer::rankHeaders(const std::vector<HeaderInfo>& headers) const {
+    // Main files' inclusive counts add up to everything that was parsed
+    int64_t totalTokens = 0;
+    for (const auto& header : headers) {
+        if (header.isMainFile) {
+            totalTokens += header.inclusiveTokens;
+        }
+    }
+
+    std::vector<int64_t> fanIn = transitiveFanIn(headers);
+    std::vector<HeaderCost> ranking;
+    for (size_t id = 0; id < headers.size(); ++id) {
+        const HeaderInfo& header = headers[id];
+        if (header.isMainFile) continue;
+        double share = totalTokens > 0 ? static_cast<double>(header.inclusiveTokens) / totalTokens : 0.0;
+        ranking.push_back({&header, share, fanIn[id]});
+    }
+
+    std::stable_sort(ranking.begin(), ranking.end(), [](const HeaderCost& a, const HeaderCost& b) {
+        return a.header->inclusiveTokens > b.header->inclusiveTokens;
+    });
+    return ranking;
+}
+
+std::string IncludeAnalyzer::generateReport(const std::vector<HeaderInfo>& headers, size_t limit) const {
+    std::stringstream ss;
+    auto ranking = rankHeaders(headers);
+
+    int translationUnits = 0;
+    int64_t totalTokens = 0;
+    for (const auto& header : headers) {
+        if (header.isMainFile) {
+            ++translationUnits;
+            totalTokens += header.inclusiveTokens;
+        }
+    }
+
+    ss << "Header Parse Cost:\n";
+    ss << "  Translation units: " << translationUnits << ", headers: " << ranking.size()
+       << ", tokens parsed: " << totalTokens << "\n\n";
+    ss << "  " << std::setw(4) << "#" << std::setw(14) << "inclusive" << std::setw(8) << "share"
+       << std::setw(12) << "own" << std::setw(6) << "TUs" << std::setw(8) << "direct"
+       << std::setw(8) << "fan-in" << "  header\n";
+
+    for (size_t i = 0; i < ranking.size() && i < limit; ++i) {
+        const HeaderInfo& header = *ranking[i].header;
+        ss << "  " << std::setw(4) << i + 1
+           << std::setw(14) << header.inclusiveTokens
+           << std::setw(7) << std::fixed << std::setprecision(1) << ranking[i].share * 100.0 << "%"
+           << std::setw(12) << header.tokens
+           << std::setw(6) << header.translationUnits
+           << std::setw(8) << header.includedBy.size()
+           << std::setw(8) << ranking[i].fanIn
+           << "  " << header.path << (header.isSystem ? " (system)" : "") << "\n";
+    }
+
+    return ss.str();
+}
+
+} // namespace cpp_diagram
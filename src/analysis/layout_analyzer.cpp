@@ -0,0 +1,172 @@
+#include "analysis/layout_analyzer.h"
+#include <algorithm>
+#include <set>
+#include <sstream>
+
+namespace cpp_diagram {
+
+namespace {
+
+int64_t alignUp(int64_t value, int64_t alignment) {
+    if (alignment <= 1) return value;
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+bool straddles(int64_t offset, int64_t size) {
+    return size > 0 && size <= LayoutAnalyzer::kCacheLineSize &&
+           offset / LayoutAnalyzer::kCacheLineSize !=
+           (offset + size - 1) / LayoutAnalyzer::kCacheLineSize;
+}
+
+// Fields may sit in a base's tail padding, before where the parser saw the
+// bases end; the header never reaches past the first field
+int64_t fieldsStart(const ClassInfo& classInfo) {
+    int64_t start = classInfo.fieldsStart;
+    for (const auto& field : classInfo.fields) {
+        if (!field.isStatic && field.offset >= 0) start = std::min(start, field.offset);
+    }
+    return start;
+}
+
+} // namespace
+
+LayoutAnalyzer::LayoutAnalyzer() = default;
+LayoutAnalyzer::~LayoutAnalyzer() = default;
+
+bool LayoutAnalyzer::analyzeClass(const ClassInfo& classInfo, ClassLayout& layout) const {
+    if (!classInfo.hasLayout) {
+        return false;
+    }
+
+    layout.className = classInfo.qualifiedName;
+    layout.size = classInfo.size;
+    layout.alignment = classInfo.alignment;
+    layout.cacheLines = static_cast<int>((classInfo.size + kCacheLineSize - 1) / kCacheLineSize);
+
+    // Fields and virtual bases in offset order
+    std::vector<LayoutSlot> parts;
+    for (const auto& field : classInfo.fields) {
+        if (!field.isStatic && field.offset >= 0) {
+            parts.push_back({LayoutSlotKind::Field, field.name, field.type, field.offset, field.size,
+                             straddles(field.offset, field.size)});
+        }
+    }
+    for (const auto& base : classInfo.virtualBases) {
+        parts.push_back({LayoutSlotKind::VirtualBase, base.name, "virtual base", base.offset, base.size, false});
+    }
+    std::stable_sort(parts.begin(), parts.end(),
+                     [](const LayoutSlot& a, const LayoutSlot& b) { return a.offset < b.offset; });
+
+    int64_t cursor = 0;
+    int64_t start = fieldsStart(classInfo);
+    if (start > 0) {
+        layout.slots.push_back({LayoutSlotKind::Header, "(vptr/bases)", "", 0, start, false});
+        cursor = start;
+    }
+
+    // Bit-fields may share bytes, so the cursor only ever moves forward
+    for (auto& part : parts) {
+        if (part.offset > cursor) {
+            layout.slots.push_back({LayoutSlotKind::Padding, "(padding)", "", cursor, part.offset - cursor, false});
+            layout.paddingBytes += part.offset - cursor;
+        }
+        int64_t end = part.offset + part.size;
+        layout.slots.push_back(std::move(part));
+        cursor = std::max(cursor, end);
+    }
+    if (layout.size > cursor && !parts.empty()) {
+        layout.slots.push_back({LayoutSlotKind::Padding, "(tail padding)", "", cursor, layout.size - cursor, false});
+        layout.paddingBytes += layout.size - cursor;
+    }
+
+    suggestReordering(classInfo, layout);
+    return true;
+}
+
+void LayoutAnalyzer::suggestReordering(const ClassInfo& classInfo, ClassLayout& layout) const {
+    std::vector<const FieldInfo*> fields;
+    for (const auto& field : classInfo.fields) {
+        if (field.isStatic || field.offset < 0) continue;
+        // Bit-fields are packed by the compiler; leave such classes alone
+        if (field.isBitField) return;
+        fields.push_back(&field);
+    }
+    if (fields.size() < 2 || layout.paddingBytes == 0) {
+        return;
+    }
+
+    // Largest alignment first removes all interior padding between fields
+    std::stable_sort(fields.begin(), fields.end(), [](const FieldInfo* a, const FieldInfo* b) {
+        if (a->alignment != b->alignment) return a->alignment > b->alignment;
+        return a->size > b->size;
+    });
+
+    int64_t cursor = fieldsStart(classInfo);
+    for (const FieldInfo* field : fields) {
+        cursor = alignUp(cursor, field->alignment) + field->size;
+    }
+    // Virtual bases keep their order after the fields
+    for (const auto& base : classInfo.virtualBases) {
+        cursor = alignUp(cursor, base.alignment) + base.size;
+    }
+    int64_t size = std::max<int64_t>(alignUp(cursor, classInfo.alignment), 1);
+
+    if (size < layout.size) {
+        layout.suggestedSize = size;
+        for (const FieldInfo* field : fields) {
+            layout.suggestedOrder.push_back(field->name);
+        }
+    }
+}
+
+std::vector<ClassLayout> LayoutAnalyzer::analyze(const std::vector<ClassInfo>& classes) const {
+    std::vector<ClassLayout> layouts;
+    std::set<std::string> seen;
+    for (const auto& classInfo : classes) {
+        // Standard library internals are not the user's to reorder
+        if (isSystemEntity(classInfo) || !seen.insert(classInfo.qualifiedName).second) {
+            continue;
+        }
+        ClassLayout layout;
+        if (analyzeClass(classInfo, layout)) {
+            layouts.push_back(std::move(layout));
+        }
+    }
+
+    std::stable_sort(layouts.begin(), layouts.end(), [](const ClassLayout& a, const ClassLayout& b) {
+        return a.paddingBytes > b.paddingBytes;
+    });
+    return layouts;
+}
+
+std::string LayoutAnalyzer::generateReport(const std::vector<ClassLayout>& layouts) const {
+    std::stringstream ss;
+
+    ss << "Memory Layout (cache line = " << kCacheLineSize << " bytes):\n\n";
+    for (const auto& layout : layouts) {
+        ss << layout.className << ": size " << layout.size << ", align " << layout.alignment
+           << ", padding " << layout.paddingBytes << ", cache lines " << layout.cacheLines << "\n";
+
+        for (const auto& slot : layout.slots) {
+            ss << "  [" << slot.offset << ".." << slot.offset + slot.size << ") ";
+            ss << slot.name;
+            if (!slot.type.empty()) ss << " : " << slot.type;
+            if (slot.straddlesCacheLine) ss << "  <-- straddles cache line";
+            ss << "\n";
+        }
+
+        if (!layout.suggestedOrder.empty()) {
+            ss << "  Suggested order (" << layout.suggestedSize << " bytes, saves "
+               << layout.size - layout.suggestedSize << "):";
+            for (const auto& name : layout.suggestedOrder) {
+                ss << " " << name;
+            }
+            ss << "\n";
+        }
+        ss << "\n";
+    }
+
+    return ss.str();
+}
+
+} // namespace cpp_diagram
@@ -0,0 +1,455 @@
+#include "analysis/model_diff.h"
+#include <algorithm>
+#include <sstream>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace cpp_diagram {
+
+namespace {
+
+// 64-bit FNV-1a; every item ends with a separator so ("ab", "c") and
+// ("a", "bc") hash differently
+class SignatureHash {
+public:
+    SignatureHash& add(const std::string& text) {
+        for (unsigned char c : text) mix(c);
+        mix(0xff);
+        return *this;
+    }
+    SignatureHash& add(int64_t value) {
+        for (int shift = 0; shift < 64; shift += 8) mix(static_cast<unsigned char>(value >> shift));
+        return *this;
+    }
+    SignatureHash& add(const std::vector<std::string>& items) {
+        for (const auto& item : items) add(item);
+        mix(0xfe);
+        return *this;
+    }
+    uint64_t value() const { return hash_; }
+
+private:
+    void mix(unsigned char c) {
+        hash_ ^= c;
+        hash_ *= 1099511628211ull;
+    }
+    uint64_t hash_ = 1469598103934665603ull;
+};
+
+// One hash per aspect, so a modified class can say what changed
+struct ClassSignature {
+    uint64_t declaration;
+    uint64_t bases;
+    uint64_t fields;
+    uint64_t methods;
+    uint64_t layout;
+};
+
+uint64_t functionSignature(const FunctionInfo& function) {
+    return SignatureHash()
+        .add(function.returnType)
+        .add(static_cast<int64_t>(function.isTemplate))
+        .add(function.templateParameters)
+        .value();
+}
+
+uint64_t methodSignature(const MethodInfo& method) {
+    int64_t flags = method.isVirtual | method.isPureVirtual << 1 | method.isStatic << 2 |
+                    method.isConst << 3 | method.isDeleted << 4 | method.isOverride << 5 |
+                    method.isFinal << 6;
+    return SignatureHash()
+        .add(static_cast<int64_t>(functionSignature(method)))
+        .add(static_cast<int64_t>(method.access))
+        .add(flags)
+        .value();
+}
+
+ClassSignature classSignature(const ClassInfo& classInfo) {
+    ClassSignature signature;
+    signature.declaration = SignatureHash()
+        .add(static_cast<int64_t>(classInfo.isAbstract))
+        .add(static_cast<int64_t>(classInfo.isTemplate))
+        .add(static_cast<int64_t>(classInfo.isFinal))
+        .add(classInfo.templateParameters)
+        .value();
+    signature.bases = SignatureHash().add(classInfo.baseClasses).value();
+
+    SignatureHash fields;
+    for (const auto& field : classInfo.fields) {
+        fields.add(field.name).add(field.type).add(static_cast<int64_t>(field.access))
+              .add(static_cast<int64_t>(field.isStatic)).add(static_cast<int64_t>(field.isBitField));
+    }
+    signature.fields = fields.value();
+
+    // Declaration order of methods is not an architectural change
+    signature.methods = 0;
+    for (const auto& method : classInfo.methods) {
+        signature.methods += SignatureHash()
+            .add(method.qualifiedName)
+            .add(ModelDiffer::parameterList(method))
+            .add(static_cast<int64_t>(methodSignature(method)))
+            .value();
+    }
+
+    signature.layout = SignatureHash()
+        .add(static_cast<int64_t>(classInfo.hasLayout))
+        .add(classInfo.size)
+        .add(classInfo.alignment)
+        .value();
+    return signature;
+}
+
+const char* relationshipName(RelationshipType type) {
+    switch (type) {
+        case RelationshipType::Inheritance: return "inheritance";
+        case RelationshipType::Composition: return "composition";
+        case RelationshipType::Aggregation: return "aggregation";
+        case RelationshipType::Association: return "association";
+        case RelationshipType::Dependency: return "dependency";
+    }
+    return "unknown";
+}
+
+// Names are joined with a byte that cannot appear in C++ identifiers
+std::string edgeKey(const std::string& from, const std::string& to, const std::string& label) {
+    return from + '\x1f' + to + '\x1f' + label;
+}
+
+// One side of the comparison, indexed by name; the first definition of a
+// class wins, as in ModelIndex
+struct ModelSide {
+    std::unordered_map<std::string, const ClassInfo*> classes;
+    std::unordered_map<std::string, const FunctionInfo*> freeFunctions;  // by name and parameters
+    std::unordered_map<std::string, EdgeChange> relationships;           // by edgeKey
+    std::unordered_map<std::string, EdgeChange> calls;                   // by edgeKey
+
+    ModelSide(const std::vector<ClassInfo>& classList,
+              const std::vector<FunctionInfo>& functionList,
+              const std::vector<RelationshipInfo>& relationshipList) {
+        std::unordered_set<std::string> methodNames;
+        for (const auto& classInfo : classList) {
+            if (classes.emplace(classInfo.qualifiedName, &classInfo).second) {
+                for (const auto& method : classInfo.methods) {
+                    methodNames.insert(method.qualifiedName);
+                }
+            }
+        }
+
+        for (const auto& function : functionList) {
+            if (!methodNames.count(function.qualifiedName)) {
+                freeFunctions.emplace(function.qualifiedName + ModelDiffer::parameterList(function), &function);
+            }
+            for (const auto& callee : function.calledFunctions) {
+                calls.emplace(edgeKey(function.qualifiedName, callee, ""),
+                              EdgeChange{ChangeKind::Unchanged, function.qualifiedName, callee, "calls"});
+            }
+        }
+
+        for (const auto& relationship : relationshipList) {
+            std::string label = relationshipName(relationship.type);
+            if (!relationship.label.empty()) label += " " + relationship.label;
+            relationships.emplace(edgeKey(relationship.fromClass, relationship.toClass, label),
+                                  EdgeChange{ChangeKind::Unchanged, relationship.fromClass,
+                                             relationship.toClass, label});
+        }
+    }
+};
+
+// Keyed edges present on one side only, in a stable order
+void diffEdges(const std::vector<std::string>& baseOrder, const std::unordered_map<std::string, EdgeChange>& base,
+               const std::vector<std::string>& headOrder, const std::unordered_map<std::string, EdgeChange>& head,
+               std::vector<EdgeChange>& changes) {
+    std::unordered_set<std::string> reported;
+    for (const auto& key : headOrder) {
+        if (!base.count(key) && reported.insert(key).second) {
+            EdgeChange change = head.at(key);
+            change.kind = ChangeKind::Added;
+            changes.push_back(change);
+        }
+    }
+    for (const auto& key : baseOrder) {
+        if (!head.count(key) && reported.insert(key).second) {
+            EdgeChange change = base.at(key);
+            change.kind = ChangeKind::Removed;
+            changes.push_back(change);
+        }
+    }
+}
+
+// Insertion-ordered set of names
+struct NameSet {
+    std::vector<std::string> order;
+    std::unordered_set<std::string> members;
+
+    bool insert(const std::string& name) {
+        if (!members.insert(name).second) return false;
+        order.push_back(name);
+        return true;
+    }
+    bool contains(const std::string& name) const { return members.count(name) > 0; }
+};
+
+// Edges present on both sides whose endpoints are both shown
+void addContextEdges(const ModelSide& base, const ModelSide& head, bool calls,
+                     const NameSet& nodes, std::vector<EdgeChange>& edges) {
+    const auto& headEdges = calls ? head.calls : head.relationships;
+    const auto& baseEdges = calls ? base.calls : base.relationships;
+    std::vector<EdgeChange> context;
+    for (const auto& [key, edge] : headEdges) {
+        if (baseEdges.count(key) && nodes.contains(edge.from) && nodes.contains(edge.to)) {
+            context.push_back(edge);
+        }
+    }
+    // Hash map order is unspecified; keep the output reproducible
+    std::sort(context.begin(), context.end(), [](const EdgeChange& a, const EdgeChange& b) {
+        return std::tie(a.from, a.to, a.label) < std::tie(b.from, b.to, b.label);
+    });
+    edges.insert(edges.end(), context.begin(), context.end());
+}
+
+char kindSymbol(ChangeKind kind) {
+    switch (kind) {
+        case ChangeKind::Added: return '+';
+        case ChangeKind::Removed: return '-';
+        case ChangeKind::Modified: return '~';
+        case ChangeKind::Unchanged: return ' ';
+    }
+    return ' ';
+}
+
+} // namespace
+
+size_t ModelDiff::changeCount() const {
+    size_t count = 0;
+    for (const auto& change : classes) count += change.kind != ChangeKind::Unchanged;
+    for (const auto& change : methods) count += change.kind != ChangeKind::Unchanged;
+    for (const auto& change : functions) count += change.kind != ChangeKind::Unchanged;
+    for (const auto& change : relationships) count += change.kind != ChangeKind::Unchanged;
+    for (const auto& change : calls) count += change.kind != ChangeKind::Unchanged;
+    return count;
+}
+
+ModelDiffer::ModelDiffer() = default;
+ModelDiffer::~ModelDiffer() = default;
+
+std::string ModelDiffer::parameterList(const FunctionInfo& function) {
+    std::string list = "(";
+    for (size_t i = 0; i < function.parameters.size(); ++i) {
+        if (i > 0) list += ", ";
+        list += function.parameters[i];
+    }
+    return list + ")";
+}
+
+ModelDiff ModelDiffer::compare(const std::vector<ClassInfo>& baseClasses,
+                               const std::vector<FunctionInfo>& baseFunctions,
+                               const std::vector<RelationshipInfo>& baseRelationships,
+                               const std::vector<ClassInfo>& headClasses,
+                               const std::vector<FunctionInfo>& headFunctions,
+                               const std::vector<RelationshipInfo>& headRelationships) const {
+    ModelSide base(baseClasses, baseFunctions, baseRelationships);
+    ModelSide head(headClasses, headFunctions, headRelationships);
+    ModelDiff diff;
+
+    // Classes, and the methods of classes present on both sides
+    for (const auto& classInfo : headClasses) {
+        if (head.classes.at(classInfo.qualifiedName) != &classInfo) continue;
+        auto baseIt = base.classes.find(classInfo.qualifiedName);
+        if (baseIt == base.classes.end()) {
+            diff.classes.push_back({ChangeKind::Added, classInfo.qualifiedName, "", "", {}});
+            continue;
+        }
+
+        const ClassInfo& previous = *baseIt->second;
+        ClassSignature before = classSignature(previous);
+        ClassSignature after = classSignature(classInfo);
+        EntityChange change{ChangeKind::Modified, classInfo.qualifiedName, "", "", {}};
+        if (before.declaration != after.declaration) change.details.push_back("declaration");
+        if (before.bases != after.bases) change.details.push_back("bases");
+        if (before.fields != after.fields) change.details.push_back("fields");
+        if (before.methods != after.methods) change.details.push_back("methods");
+        if (before.layout != after.layout) change.details.push_back("layout");
+        if (change.details.empty()) continue;
+        diff.classes.push_back(change);
+
+        if (before.methods == after.methods) continue;
+        std::unordered_map<std::string, const MethodInfo*> previousMethods;
+        for (const auto& method : previous.methods) {
+            previousMethods.emplace(method.qualifiedName + parameterList(method), &method);
+        }
+        std::unordered_set<std::string> currentMethods;
+        for (const auto& method : classInfo.methods) {
+            std::string parameters = parameterList(method);
+            currentMethods.insert(method.qualifiedName + parameters);
+            auto methodIt = previousMethods.find(method.qualifiedName + parameters);
+            if (methodIt == previousMethods.end()) {
+                diff.methods.push_back({ChangeKind::Added, method.qualifiedName, parameters,
+                                        classInfo.qualifiedName, {}});
+            } else if (methodSignature(*methodIt->second) != methodSignature(method)) {
+                diff.methods.push_back({ChangeKind::Modified, method.qualifiedName, parameters,
+                                        classInfo.qualifiedName, {}});
+            }
+        }
+        for (const auto& method : previous.methods) {
+            std::string parameters = parameterList(method);
+            if (!currentMethods.count(method.qualifiedName + parameters)) {
+                diff.methods.push_back({ChangeKind::Removed, method.qualifiedName, parameters,
+                                        classInfo.qualifiedName, {}});
+            }
+        }
+    }
+    for (const auto& classInfo : baseClasses) {
+        if (base.classes.at(classInfo.qualifiedName) == &classInfo && !head.classes.count(classInfo.qualifiedName)) {
+            diff.classes.push_back({ChangeKind::Removed, classInfo.qualifiedName, "", "", {}});
+        }
+    }
+
+    // Free functions
+    for (const auto& function : headFunctions) {
+        std::string parameters = parameterList(function);
+        auto headIt = head.freeFunctions.find(function.qualifiedName + parameters);
+        if (headIt == head.freeFunctions.end() || headIt->second != &function) continue;
+        auto baseIt = base.freeFunctions.find(headIt->first);
+        if (baseIt == base.freeFunctions.end()) {
+            diff.functions.push_back({ChangeKind::Added, function.qualifiedName, parameters, "", {}});
+        } else if (functionSignature(*baseIt->second) != functionSignature(function)) {
+            diff.functions.push_back({ChangeKind::Modified, function.qualifiedName, parameters, "", {}});
+        }
+    }
+    for (const auto& function : baseFunctions) {
+        std::string parameters = parameterList(function);
+        auto baseIt = base.freeFunctions.find(function.qualifiedName + parameters);
+        if (baseIt != base.freeFunctions.end() && baseIt->second == &function &&
+            !head.freeFunctions.count(baseIt->first)) {
+            diff.functions.push_back({ChangeKind::Removed, function.qualifiedName, parameters, "", {}});
+        }
+    }
+
+    // Relationships and call edges, in model order
+    std::vector<std::string> baseOrder;
+    std::vector<std::string> headOrder;
+    auto relationshipOrder = [](const std::vector<RelationshipInfo>& relationships,
+                                std::vector<std::string>& order) {
+        order.clear();
+        for (const auto& relationship : relationships) {
+            std::string label = relationshipName(relationship.type);
+            if (!relationship.label.empty()) label += " " + relationship.label;
+            order.push_back(edgeKey(relationship.fromClass, relationship.toClass, label));
+        }
+    };
+    relationshipOrder(baseRelationships, baseOrder);
+    relationshipOrder(headRelationships, headOrder);
+    diffEdges(baseOrder, base.relationships, headOrder, head.relationships, diff.relationships);
+
+    auto callOrder = [](const std::vector<FunctionInfo>& functions, std::vector<std::string>& order) {
+        order.clear();
+        std::unordered_set<std::string> seen;
+        for (const auto& function : functions) {
+            for (const auto& callee : function.calledFunctions) {
+                std::string key = edgeKey(function.qualifiedName, callee, "");
+                if (seen.insert(key).second) order.push_back(key);
+            }
+        }
+    };
+    callOrder(baseFunctions, baseOrder);
+    callOrder(headFunctions, headOrder);
+    diffEdges(baseOrder, base.calls, headOrder, head.calls, diff.calls);
+
+    // One-hop class context: unchanged endpoints of changed relationships,
+    // then the neighbours of every changed class on either side
+    NameSet changedClasses;
+    for (const auto& change : diff.classes) changedClasses.insert(change.name);
+    NameSet shownClasses = changedClasses;
+    auto showClass = [&](const std::string& name) {
+        if ((head.classes.count(name) || base.classes.count(name)) && shownClasses.insert(name)) {
+            diff.classes.push_back({ChangeKind::Unchanged, name, "", "", {}});
+        }
+    };
+    for (const auto& edge : diff.relationships) {
+        showClass(edge.from);
+        showClass(edge.to);
+    }
+    for (const auto* relationships : {&baseRelationships, &headRelationships}) {
+        for (const auto& relationship : *relationships) {
+            if (changedClasses.contains(relationship.fromClass)) showClass(relationship.toClass);
+            if (changedClasses.contains(relationship.toClass)) showClass(relationship.fromClass);
+        }
+    }
+    addContextEdges(base, head, false, shownClasses, diff.relationships);
+
+    // Same for functions over the call graph; only functions that changed
+    // themselves pull in their callers and callees
+    NameSet changedFunctions;
+    for (const auto& change : diff.functions) {
+        if (change.kind != ChangeKind::Unchanged) changedFunctions.insert(change.name);
+    }
+    NameSet shownFunctions;
+    for (const auto& change : diff.functions) shownFunctions.insert(change.name);
+    auto showFunction = [&](const std::string& name) {
+        if (shownFunctions.insert(name)) {
+            diff.functions.push_back({ChangeKind::Unchanged, name, "", "", {}});
+        }
+    };
+    for (const auto& edge : diff.calls) {
+        showFunction(edge.from);
+        showFunction(edge.to);
+    }
+    for (const auto* functions : {&baseFunctions, &headFunctions}) {
+        for (const auto& function : *functions) {
+            for (const auto& callee : function.calledFunctions) {
+                if (changedFunctions.contains(function.qualifiedName)) showFunction(callee);
+                if (changedFunctions.contains(callee)) showFunction(function.qualifiedName);
+            }
+        }
+    }
+    addContextEdges(base, head, true, shownFunctions, diff.calls);
+
+    return diff;
+}
+
+std::string ModelDiffer::generateReport(const ModelDiff& diff) const {
+    std::stringstream ss;
+    ss << "Model Diff:\n";
+    ss << "  " << diff.changeCount() << " changes (+ added, - removed, ~ modified)\n";
+
+    auto section = [&](const char* title, const std::vector<EntityChange>& changes) {
+        ss << "\n" << title << ":\n";
+        size_t shown = 0;
+        for (const auto& change : changes) {
+            if (change.kind == ChangeKind::Unchanged) continue;
+            ss << "  " << kindSymbol(change.kind) << " " << change.name << change.parameters;
+            if (!change.details.empty()) {
+                ss << " (";
+                for (size_t i = 0; i < change.details.size(); ++i) {
+                    if (i > 0) ss << ", ";
+                    ss << change.details[i];
+                }
+                ss << ")";
+            }
+            ss << "\n";
+            ++shown;
+        }
+        if (shown == 0) ss << "  (none)\n";
+    };
+    auto edgeSection = [&](const char* title, const std::vector<EdgeChange>& changes) {
+        ss << "\n" << title << ":\n";
+        size_t shown = 0;
+        for (const auto& change : changes) {
+            if (change.kind == ChangeKind::Unchanged) continue;
+            ss << "  " << kindSymbol(change.kind) << " " << change.from << " -> " << change.to
+               << " [" << change.label << "]\n";
+            ++shown;
+        }
+        if (shown == 0) ss << "  (none)\n";
+    };
+
+    section("Classes", diff.classes);
+    section("Methods", diff.methods);
+    section("Functions", diff.functions);
+    edgeSection("Relationships", diff.relationships);
+    edgeSection("Calls", diff.calls);
+    return ss.str();
+}
+
+} // namespace cpp_diagram
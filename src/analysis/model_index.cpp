@@ -0,0 +1,148 @@
+#include "analysis/model_index.h"
+#include <algorithm>
+#include <unordered_set>
+
+namespace cpp_diagram {
+
+ModelIndex::ModelIndex(const std::vector<ClassInfo>& classes,
+                       const std::vector<FunctionInfo>& functions,
+                       const std::vector<RelationshipInfo>& relationships)
+    : classes_(classes), functions_(functions), relationships_(relationships) {
+    // Classes defined in headers show up once per translation unit; the
+    // first definition wins
+    classIds_.reserve(classes_.size());
+    canonicalClasses_.resize(classes_.size());
+    for (size_t id = 0; id < classes_.size(); ++id) {
+        canonicalClasses_[id] = classIds_.emplace(classes_[id].qualifiedName, id).second;
+    }
+
+    functionIds_.reserve(functions_.size());
+    canonicalFunctions_.resize(functions_.size());
+    for (size_t id = 0; id < functions_.size(); ++id) {
+        canonicalFunctions_[id] = functionIds_.emplace(functions_[id].qualifiedName, id).second;
+    }
+
+    // Build the hierarchy from the canonical definition of each class
+    bases_.resize(classes_.size());
+    derived_.resize(classes_.size());
+    for (size_t id = 0; id < classes_.size(); ++id) {
+        if (!canonicalClasses_[id]) {
+            continue;
+        }
+        for (const auto& baseName : classes_[id].baseClasses) {
+            size_t baseId = findClass(baseName);
+            if (baseId != npos && baseId != id) {
+                bases_[id].push_back(baseId);
+                derived_[baseId].push_back(id);
+            }
+        }
+    }
+
+    owners_.assign(functions_.size(), npos);
+    for (size_t id = 0; id < classes_.size(); ++id) {
+        if (!canonicalClasses_[id]) {
+            continue;
+        }
+        const auto& methods = classes_[id].methods;
+        for (size_t methodIndex = 0; methodIndex < methods.size(); ++methodIndex) {
+            auto& refs = methodIds_[methods[methodIndex].qualifiedName];
+            if (refs.empty()) {
+                size_t functionId = findFunction(methods[methodIndex].qualifiedName);
+                if (functionId != npos) owners_[functionId] = id;
+            }
+            refs.push_back({id, methodIndex});
+        }
+    }
+
+    outgoing_.resize(classes_.size());
+    incoming_.resize(classes_.size());
+    for (size_t index = 0; index < relationships_.size(); ++index) {
+        size_t fromId = findClass(relationships_[index].fromClass);
+        if (fromId != npos) {
+            outgoing_[fromId].push_back(index);
+        }
+        size_t toId = findClass(relationships_[index].toClass);
+        if (toId != npos) {
+            incoming_[toId].push_back(index);
+        }
+    }
+
+    // Calls per canonical caller, sorted and deduplicated, then flattened;
+    // the reverse direction is filled by counting callers per callee
+    std::vector<std::pair<size_t, size_t>> calls;
+    for (size_t id = 0; id < functions_.size(); ++id) {
+        size_t callerId = findFunction(functions_[id].qualifiedName);
+        for (const auto& called : functions_[id].calledFunctions) {
+            size_t calleeId = findFunction(called);
+            if (calleeId != npos) {
+                calls.push_back({callerId, calleeId});
+            }
+        }
+    }
+    std::sort(calls.begin(), calls.end());
+    calls.erase(std::unique(calls.begin(), calls.end()), calls.end());
+
+    calleeOffsets_.assign(functions_.size() + 1, 0);
+    callerOffsets_.assign(functions_.size() + 1, 0);
+    for (const auto& [callerId, calleeId] : calls) {
+        ++calleeOffsets_[callerId + 1];
+        ++callerOffsets_[calleeId + 1];
+    }
+    for (size_t id = 0; id < functions_.size(); ++id) {
+        calleeOffsets_[id + 1] += calleeOffsets_[id];
+        callerOffsets_[id + 1] += callerOffsets_[id];
+    }
+    calleeIds_.resize(calls.size());
+    callerIds_.resize(calls.size());
+    std::vector<size_t> nextCaller(callerOffsets_.begin(), callerOffsets_.end() - 1);
+    for (size_t i = 0; i < calls.size(); ++i) {
+        calleeIds_[i] = calls[i].second;
+        callerIds_[nextCaller[calls[i].second]++] = calls[i].first;
+    }
+}
+
+size_t ModelIndex::findClass(const std::string& qualifiedName) const {
+    auto it = classIds_.find(qualifiedName);
+    return it != classIds_.end() ? it->second : npos;
+}
+
+size_t ModelIndex::findFunction(const std::string& qualifiedName) const {
+    auto it = functionIds_.find(qualifiedName);
+    return it != functionIds_.end() ? it->second : npos;
+}
+
+const std::vector<ModelIndex::MethodRef>& ModelIndex::findMethods(const std::string& qualifiedName) const {
+    static const std::vector<MethodRef> none;
+    auto it = methodIds_.find(qualifiedName);
+    return it != methodIds_.end() ? it->second : none;
+}
+
+std::string ModelIndex::signature(const MethodInfo& method) {
+    std::string signature = method.name + "(";
+    for (size_t i = 0; i < method.parameters.size(); ++i) {
+        if (i > 0) signature += ", ";
+        signature += method.parameters[i];
+    }
+    signature += ")";
+    if (method.isConst) signature += " const";
+    return signature;
+}
+
+bool ModelIndex::isSubclassOf(size_t id, size_t baseId) const {
+    std::vector<size_t> pending(bases_[id]);
+    std::unordered_set<size_t> visited;
+    while (!pending.empty()) {
+        size_t current = pending.back();
+        pending.pop_back();
+        if (current == baseId) {
+            return true;
+        }
+        if (!visited.insert(current).second) {
+            continue;
+        }
+        pending.insert(pending.end(), bases_[current].begin(), bases_[current].end());
+    }
+    return false;
+}
+
+} // namespace cpp_diagram
@@ -0,0 +1,268 @@
+#include "analysis/pattern_engine.h"
+#include <algorithm>
+
+namespace cpp_diagram {
+
+namespace {
+
+bool takesParameterOfType(const ClassInfo& classInfo, const std::string& type) {
+    for (const auto& method : classInfo.methods) {
+        if (std::find(method.parameterRecordTypes.begin(), method.parameterRecordTypes.end(),
+                      type) != method.parameterRecordTypes.end()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// An implementation pointer targets a class nested inside the owner, or a
+// forward-declared "...Impl" class whose definition was never parsed
+bool isOpaqueImplType(const ModelIndex& index, const ClassInfo& owner, const std::string& type) {
+    std::string nestedPrefix = owner.qualifiedName + "::";
+    if (type.compare(0, nestedPrefix.size(), nestedPrefix) == 0) {
+        return true;
+    }
+    const std::string suffix = "Impl";
+    return index.findClass(type) == ModelIndex::npos &&
+           type.size() > suffix.size() &&
+           type.compare(type.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// Classes visited by virtual single-argument methods, e.g. visit(Circle&)
+std::vector<std::string> visitedElements(const ModelIndex& index, const ClassInfo& classInfo) {
+    std::vector<std::string> elements;
+    for (const auto& method : classInfo.methods) {
+        if (!method.isVirtual || method.parameterRecordTypes.size() != 1) {
+            continue;
+        }
+        const auto& element = method.parameterRecordTypes[0];
+        if (element.empty() || element == classInfo.qualifiedName ||
+            index.findClass(element) == ModelIndex::npos) {
+            continue;
+        }
+        if (std::find(elements.begin(), elements.end(), element) == elements.end()) {
+            elements.push_back(element);
+        }
+    }
+    return elements;
+}
+
+void addParticipant(PatternMatch& match, const std::string& name) {
+    if (std::find(match.participants.begin(), match.participants.end(), name) ==
+        match.participants.end()) {
+        match.participants.push_back(name);
+    }
+}
+
+} // namespace
+
+PatternEngine::PatternEngine() {
+    addRule({"Singleton", FeatureNonPublicConstructors | FeatureStaticSelfInstance, nullptr});
+
+    addRule({"Factory", FeatureCreatesAbstract,
+        [](const ModelIndex& index, size_t id, PatternMatch& match) {
+            for (const auto& method : index.classAt(id).methods) {
+                size_t product = index.findClass(method.returnRecordType);
+                if (method.isStatic && product != ModelIndex::npos && product != id &&
+                    index.classAt(product).isAbstract) {
+                    addParticipant(match, method.returnRecordType);
+                }
+            }
+            return true;
+        }});
+
+    addRule({"Observer", FeatureObserverRegistry,
+        [](const ModelIndex& index, size_t id, PatternMatch& match) {
+            const ClassInfo& subject = index.classAt(id);
+            for (const auto& field : subject.fields) {
+                size_t observer = index.findClass(field.recordType);
+                if (field.isContainer && observer != ModelIndex::npos &&
+                    index.classAt(observer).isAbstract &&
+                    takesParameterOfType(subject, field.recordType)) {
+                    addParticipant(match, field.recordType);
+                }
+            }
+            return !match.participants.empty();
+        }});
+
+    // Concrete visitors share the interface's shape, so only the abstract
+    // root is reported, and only if some element accepts it
+    addRule({"Visitor", FeatureVisitorInterface | FeatureAbstract,
+        [](const ModelIndex& index, size_t id, PatternMatch& match) {
+            const ClassInfo& visitor = index.classAt(id);
+            for (const auto& element : visitedElements(index, visitor)) {
+                size_t elementId = index.findClass(element);
+                bool accepts = takesParameterOfType(index.classAt(elementId), visitor.qualifiedName);
+                for (size_t baseId : index.baseClasses(elementId)) {
+                    accepts = accepts || takesParameterOfType(index.classAt(baseId), visitor.qualifiedName);
+                }
+                if (accepts) {
+                    addParticipant(match, element);
+                }
+            }
+            return !match.participants.empty();
+        }});
+
+    addRule({"Composite", FeatureAggregatesBase,
+        [](const ModelIndex& index, size_t id, PatternMatch& match) {
+            for (const auto& field : index.classAt(id).fields) {
+                size_t component = index.findClass(field.recordType);
+                if (field.isContainer && component != ModelIndex::npos &&
+                    index.isSubclassOf(id, component)) {
+                    addParticipant(match, field.recordType);
+                }
+            }
+            return true;
+        }});
+
+    addRule({"CRTP", FeatureCrtpBase,
+        [](const ModelIndex& index, size_t id, PatternMatch& match) {
+            const ClassInfo& derived = index.classAt(id);
+            for (size_t relIndex : index.outgoingRelationships(id)) {
+                const auto& relationship = index.relationshipAt(relIndex);
+                if (relationship.type == RelationshipType::Inheritance &&
+                    std::find(relationship.templateArguments.begin(),
+                              relationship.templateArguments.end(),
+                              derived.qualifiedName) != relationship.templateArguments.end()) {
+                    addParticipant(match, relationship.toClass);
+                }
+            }
+            return true;
+        }});
+
+    addRule({"Pimpl", FeatureOpaqueImpl,
+        [](const ModelIndex& index, size_t id, PatternMatch& match) {
+            const ClassInfo& owner = index.classAt(id);
+            for (const auto& field : owner.fields) {
+                if (!field.isStatic && field.isIndirect && !field.isContainer &&
+                    field.access == AccessSpecifier::Private && !field.recordType.empty() &&
+                    isOpaqueImplType(index, owner, field.recordType)) {
+                    addParticipant(match, field.recordType);
+                }
+            }
+            return true;
+        }});
+}
+
+PatternEngine::~PatternEngine() = default;
+
+void PatternEngine::addRule(PatternRule rule) {
+    rules_.push_back(std::move(rule));
+}
+
+std::vector<PatternMatch> PatternEngine::classify(const ModelIndex& index) const {
+    std::vector<PatternMatch> matches;
+    std::vector<uint32_t> features = computeFeatures(index);
+
+    for (size_t id = 0; id < index.classCount(); ++id) {
+        // Skip duplicate definitions and classes no rule can match
+        if (features[id] == 0 || index.findClass(index.classAt(id).qualifiedName) != id) {
+            continue;
+        }
+
+        for (const auto& rule : rules_) {
+            if ((features[id] & rule.requiredFeatures) != rule.requiredFeatures) {
+                continue;
+            }
+
+            PatternMatch match;
+            match.pattern = rule.name;
+            match.className = index.classAt(id).qualifiedName;
+            if (!rule.verify || rule.verify(index, id, match)) {
+                matches.push_back(std::move(match));
+            }
+        }
+    }
+
+    return matches;
+}
+
+std::vector<uint32_t> PatternEngine::computeFeatures(const ModelIndex& index) const {
+    std::vector<uint32_t> features(index.classCount(), 0);
+    for (size_t id = 0; id < index.classCount(); ++id) {
+        features[id] = classFeatures(index, id);
+    }
+    return features;
+}
+
+uint32_t PatternEngine::classFeatures(const ModelIndex& index, size_t id) const {
+    const ClassInfo& classInfo = index.classAt(id);
+    uint32_t features = 0;
+
+    if (classInfo.isAbstract) {
+        features |= FeatureAbstract;
+    }
+
+    // Methods
+    bool hasConstructor = false;
+    bool hasPublicConstructor = false;
+    for (const auto& method : classInfo.methods) {
+        if (method.isConstructor) {
+            hasConstructor = true;
+            if (method.access == AccessSpecifier::Public && !method.isDeleted) {
+                hasPublicConstructor = true;
+            }
+            continue;
+        }
+        if (!method.isStatic || method.returnRecordType.empty()) {
+            continue;
+        }
+        if (method.returnRecordType == classInfo.qualifiedName) {
+            features |= FeatureStaticSelfInstance;
+        } else {
+            size_t product = index.findClass(method.returnRecordType);
+            if (product != ModelIndex::npos && index.classAt(product).isAbstract) {
+                features |= FeatureCreatesAbstract;
+            }
+        }
+    }
+    if (hasConstructor && !hasPublicConstructor) {
+        features |= FeatureNonPublicConstructors;
+    }
+    if (visitedElements(index, classInfo).size() >= 2) {
+        features |= FeatureVisitorInterface;
+    }
+
+    // Fields
+    for (const auto& field : classInfo.fields) {
+        if (field.recordType.empty()) {
+            continue;
+        }
+        if (field.isStatic) {
+            if (field.recordType == classInfo.qualifiedName) {
+                features |= FeatureStaticSelfInstance;
+            }
+            continue;
+        }
+
+        size_t fieldClass = index.findClass(field.recordType);
+        if (field.isContainer && fieldClass != ModelIndex::npos) {
+            if (index.isSubclassOf(id, fieldClass)) {
+                features |= FeatureAggregatesBase;
+            } else if (index.classAt(fieldClass).isAbstract &&
+                       takesParameterOfType(classInfo, field.recordType)) {
+                features |= FeatureObserverRegistry;
+            }
+        }
+        if (field.isIndirect && !field.isContainer &&
+            field.access == AccessSpecifier::Private &&
+            isOpaqueImplType(index, classInfo, field.recordType)) {
+            features |= FeatureOpaqueImpl;
+        }
+    }
+
+    // Relationships
+    for (size_t relIndex : index.outgoingRelationships(id)) {
+        const auto& relationship = index.relationshipAt(relIndex);
+        if (relationship.type == RelationshipType::Inheritance &&
+            std::find(relationship.templateArguments.begin(),
+                      relationship.templateArguments.end(),
+                      classInfo.qualifiedName) != relationship.templateArguments.end()) {
+            features |= FeatureCrtpBase;
+        }
+    }
+
+    return features;
+}
+
+} // namespace cpp_diagram
@@ -0,0 +1,149 @@
+#include "analysis/perf_lint_analyzer.h"
+#include <algorithm>
+#include <cstdio>
+#include <iterator>
+#include <map>
+#include <set>
+#include <sstream>
+#include <tuple>
+
+namespace cpp_diagram {
+
+namespace {
+
+constexpr PerfIssue kIssues[] = {
+    PerfIssue::AllocationInLoop, PerfIssue::GrowthWithoutReserve, PerfIssue::LargeByValue,
+    PerfIssue::ThrowingMove, PerfIssue::StdFunctionParameter
+};
+
+std::string escapeJson(const std::string& text) {
+    std::string escaped;
+    escaped.reserve(text.size());
+    for (char c : text) {
+        switch (c) {
+            case '"': escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\t': escaped += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buffer[8];
+                    std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                    escaped += buffer;
+                } else {
+                    escaped += c;
+                }
+        }
+    }
+    return escaped;
+}
+
+} // namespace
+
+PerfLintAnalyzer::PerfLintAnalyzer() = default;
+PerfLintAnalyzer::~PerfLintAnalyzer() = default;
+
+void PerfLintAnalyzer::setHotFunctions(const std::vector<std::string>& hotFunctions) {
+    hotFunctions_.clear();
+    hotFunctions_.insert(hotFunctions.begin(), hotFunctions.end());
+}
+
+const char* PerfLintAnalyzer::issueName(PerfIssue issue) {
+    switch (issue) {
+        case PerfIssue::AllocationInLoop: return "allocation-in-loop";
+        case PerfIssue::GrowthWithoutReserve: return "growth-without-reserve";
+        case PerfIssue::LargeByValue: return "large-by-value";
+        case PerfIssue::ThrowingMove: return "throwing-move";
+        case PerfIssue::StdFunctionParameter: return "std-function-parameter";
+    }
+    return "unknown";
+}
+
+std::vector<PerfLintEntry> PerfLintAnalyzer::analyze(const std::vector<ClassInfo>& classes,
+                                                     const std::vector<FunctionInfo>& functions) const {
+    std::vector<PerfLintEntry> entries;
+    // A header seen by several TUs yields the same finding once per TU
+    std::set<std::tuple<std::string, int, int, std::string>> seen;
+    auto add = [&](const PerfFinding& finding, const std::string& owner, const std::string& file, bool isClass) {
+        bool isHot = hotFunctions_.count(owner) > 0;
+        if (finding.issue == PerfIssue::StdFunctionParameter && !hotFunctions_.empty() && !isHot) {
+            return;
+        }
+        if (!seen.emplace(owner, static_cast<int>(finding.issue), finding.line, finding.message).second) {
+            return;
+        }
+        entries.push_back({finding, owner, file, isClass, isHot});
+    };
+
+    for (const auto& classInfo : classes) {
+        for (const auto& finding : classInfo.perfFindings) {
+            add(finding, classInfo.qualifiedName, classInfo.file, true);
+        }
+    }
+    for (const auto& function : functions) {
+        for (const auto& finding : function.perfFindings) {
+            add(finding, function.qualifiedName, function.file, false);
+        }
+    }
+
+    std::stable_sort(entries.begin(), entries.end(), [](const PerfLintEntry& a, const PerfLintEntry& b) {
+        if (a.isHot != b.isHot) return a.isHot;
+        return std::tie(a.file, a.finding.line) < std::tie(b.file, b.finding.line);
+    });
+    return entries;
+}
+
+std::string PerfLintAnalyzer::generateReport(const std::vector<PerfLintEntry>& entries) const {
+    std::map<PerfIssue, int> counts;
+    for (const auto& entry : entries) {
+        ++counts[entry.finding.issue];
+    }
+
+    std::stringstream ss;
+    ss << "Performance Lint:\n";
+    ss << "  Findings: " << entries.size();
+    if (!entries.empty()) {
+        ss << " (";
+        bool first = true;
+        for (const auto& [issue, count] : counts) {
+            ss << (first ? "" : ", ") << issueName(issue) << " " << count;
+            first = false;
+        }
+        ss << ")";
+    }
+    ss << "\n\n";
+
+    for (const auto& entry : entries) {
+        ss << "  " << (entry.isHot ? "[hot] " : "") << entry.file;
+        if (entry.finding.line > 0) ss << ":" << entry.finding.line;
+        ss << "  " << entry.owner << "  " << issueName(entry.finding.issue) << ": "
+           << entry.finding.message << "\n";
+    }
+    return ss.str();
+}
+
+std::string PerfLintAnalyzer::generateJson(const std::vector<PerfLintEntry>& entries) const {
+    std::stringstream ss;
+    ss << "{\"counts\":{";
+    for (size_t i = 0; i < std::size(kIssues); ++i) {
+        int count = static_cast<int>(std::count_if(entries.begin(), entries.end(), [&](const PerfLintEntry& entry) {
+            return entry.finding.issue == kIssues[i];
+        }));
+        ss << (i > 0 ? "," : "") << "\"" << issueName(kIssues[i]) << "\":" << count;
+    }
+    ss << "},\"findings\":[";
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const PerfLintEntry& entry = entries[i];
+        ss << (i > 0 ? "," : "") << "\n{\"issue\":\"" << issueName(entry.finding.issue) << "\""
+           << ",\"owner\":\"" << escapeJson(entry.owner) << "\""
+           << ",\"kind\":\"" << (entry.isClass ? "class" : "function") << "\""
+           << ",\"file\":\"" << escapeJson(entry.file) << "\""
+           << ",\"line\":" << entry.finding.line
+           << ",\"hot\":" << (entry.isHot ? "true" : "false")
+           << ",\"message\":\"" << escapeJson(entry.finding.message) << "\"}";
+    }
+    ss << "\n]}\n";
+    return ss.str();
+}
+
+} // namespace cpp_diagram
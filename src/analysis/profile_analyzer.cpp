@@ -0,0 +1,232 @@
+#include "analysis/profile_analyzer.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <sstream>
+
+namespace cpp_diagram {
+
+namespace {
+
+bool endsWith(const std::string& text, const std::string& suffix) {
+    return text.size() >= suffix.size() &&
+           text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+std::string trim(const std::string& text) {
+    size_t begin = text.find_first_not_of(" \t\r");
+    if (begin == std::string::npos) return "";
+    size_t end = text.find_last_not_of(" \t\r");
+    return text.substr(begin, end - begin + 1);
+}
+
+// "  55d4c3a1 ns::foo(int)+0x1f (/usr/bin/app)" -> "ns::foo(int)+0x1f"
+std::string perfFrameSymbol(const std::string& line) {
+    std::string frame = trim(line);
+    size_t space = frame.find(' ');
+    if (space == std::string::npos) return "";
+    frame = frame.substr(space + 1);
+    size_t dso = frame.rfind(" (");
+    if (dso != std::string::npos && !frame.empty() && frame.back() == ')') {
+        frame = frame.substr(0, dso);
+    }
+    return frame;
+}
+
+} // namespace
+
+ProfileAnalyzer::ProfileAnalyzer() = default;
+ProfileAnalyzer::~ProfileAnalyzer() = default;
+
+std::string ProfileAnalyzer::normalizeSymbol(const std::string& symbol) {
+    std::string text = trim(symbol);
+    size_t offset = text.rfind("+0x");
+    if (offset != std::string::npos) {
+        text = text.substr(0, offset);
+    }
+
+    // Keep the name at nesting depth zero: template arguments and the
+    // parameter list are dropped, operator names and anonymous namespaces kept
+    std::string name;
+    int depth = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        char c = text[i];
+        if (depth == 0 && endsWith(name, "operator")) {
+            // operator(), operator<<=, operator-> ... are part of the name
+            if (text.compare(i, 2, "()") == 0) {
+                name += "()";
+                ++i;
+                continue;
+            }
+            const std::string symbolChars = "<>=!+-*/%&|^~[],";
+            size_t end = i;
+            while (end < text.size() && symbolChars.find(text[end]) != std::string::npos) ++end;
+            if (end > i) {
+                name += text.substr(i, end - i);
+                i = end - 1;
+                continue;
+            }
+        }
+        if (depth == 0 && c == '(' && text.compare(i, 21, "(anonymous namespace)") == 0) {
+            name += "(anonymous namespace)";
+            i += 20;
+        } else if (c == '<') {
+            ++depth;
+        } else if (c == '>' && depth > 0) {
+            --depth;
+        } else if (c == '(' && depth == 0) {
+            break;
+        } else if (depth == 0) {
+            name += c;
+        }
+    }
+    return trim(name);
+}
+
+void ProfileAnalyzer::addStack(const std::vector<std::string>& frames, int64_t samples,
+                               const std::map<std::string, std::string>& known,
+                               ProfileData& profile) const {
+    profile.totalSamples += samples;
+
+    std::vector<const std::string*> path;
+    for (const auto& frame : frames) {
+        auto it = known.find(normalizeSymbol(frame));
+        if (it != known.end() && (path.empty() || *path.back() != it->second)) {
+            path.push_back(&it->second);
+        }
+    }
+    if (path.empty()) {
+        profile.unmatchedSamples += samples;
+        return;
+    }
+
+    // Recursion puts a function on the stack more than once; count it once.
+    // Time spent in unknown code is charged to its nearest known caller.
+    std::set<std::string> seen;
+    for (const std::string* function : path) {
+        if (seen.insert(*function).second) {
+            profile.functions[*function].inclusiveSamples += samples;
+        }
+    }
+    profile.functions[*path.back()].selfSamples += samples;
+
+    std::set<std::pair<std::string, std::string>> seenCalls;
+    for (size_t i = 1; i < path.size(); ++i) {
+        auto call = std::make_pair(*path[i - 1], *path[i]);
+        if (seenCalls.insert(call).second) {
+            profile.calls[call] += samples;
+        }
+    }
+}
+
+bool ProfileAnalyzer::load(const std::string& path, const std::vector<FunctionInfo>& functions,
+                           ProfileData& profile) const {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Error: Cannot open profile " << path << std::endl;
+        return false;
+    }
+
+    // Profiles name functions the way the compiler demangles them; match on
+    // the normalized form of both sides
+    std::map<std::string, std::string> known;
+    for (const auto& function : functions) {
+        known.emplace(normalizeSymbol(function.qualifiedName), function.qualifiedName);
+    }
+
+    std::vector<std::string> lines;
+    std::string line;
+    bool perfScript = false;
+    while (std::getline(file, line)) {
+        if (!line.empty() && (line[0] == ' ' || line[0] == '\t')) {
+            perfScript = true;
+        }
+        lines.push_back(line);
+    }
+
+    if (perfScript) {
+        // One sample per block: an event header, then frames innermost first
+        std::vector<std::string> frames;
+        auto flush = [&]() {
+            if (!frames.empty()) {
+                std::reverse(frames.begin(), frames.end());
+                addStack(frames, 1, known, profile);
+                frames.clear();
+            }
+        };
+        for (const auto& text : lines) {
+            if (trim(text).empty()) {
+                flush();
+            } else if (text[0] == ' ' || text[0] == '\t') {
+                std::string symbol = perfFrameSymbol(text);
+                if (!symbol.empty() && symbol != "[unknown]") {
+                    frames.push_back(symbol);
+                }
+            } else {
+                flush();
+            }
+        }
+        flush();
+    } else {
+        // "outer;middle;inner count"
+        for (const auto& text : lines) {
+            std::string stack = trim(text);
+            if (stack.empty() || stack[0] == '#') continue;
+            size_t space = stack.find_last_of(' ');
+            if (space == std::string::npos) continue;
+
+            int64_t samples = 0;
+            try {
+                samples = std::stoll(stack.substr(space + 1));
+            } catch (const std::exception&) {
+                continue;
+            }
+
+            std::vector<std::string> frames;
+            std::stringstream ss(stack.substr(0, space));
+            std::string frame;
+            while (std::getline(ss, frame, ';')) {
+                frames.push_back(frame);
+            }
+            addStack(frames, samples, known, profile);
+        }
+    }
+
+    if (profile.totalSamples == 0) {
+        std::cerr << "Error: No samples found in profile " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+std::string ProfileAnalyzer::generateReport(const ProfileData& profile, size_t limit) const {
+    std::vector<std::pair<std::string, FunctionCost>> ranking(profile.functions.begin(),
+                                                              profile.functions.end());
+    std::stable_sort(ranking.begin(), ranking.end(), [](const auto& a, const auto& b) {
+        return a.second.inclusiveSamples > b.second.inclusiveSamples;
+    });
+
+    std::stringstream ss;
+    ss << "Profile Hot Paths:\n";
+    ss << "  Samples: " << profile.totalSamples << ", matched functions: " << ranking.size()
+       << ", unmatched samples: " << profile.unmatchedSamples << " ("
+       << std::fixed << std::setprecision(1) << profile.share(profile.unmatchedSamples) * 100.0
+       << "%)\n\n";
+    ss << "  " << std::setw(4) << "#" << std::setw(10) << "incl" << std::setw(10) << "self"
+       << std::setw(12) << "samples" << "  function\n";
+
+    for (size_t i = 0; i < ranking.size() && i < limit; ++i) {
+        const FunctionCost& cost = ranking[i].second;
+        ss << "  " << std::setw(4) << i + 1
+           << std::setw(9) << profile.share(cost.inclusiveSamples) * 100.0 << "%"
+           << std::setw(9) << profile.share(cost.selfSamples) * 100.0 << "%"
+           << std::setw(12) << cost.inclusiveSamples
+           << "  " << ranking[i].first << "\n";
+    }
+
+    return ss.str();
+}
+
+} // namespace cpp_diagram
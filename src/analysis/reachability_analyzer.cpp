@@ -0,0 +1,471 @@
+#include "analysis/reachability_analyzer.h"
+#include "analysis/graph_query.h"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <unordered_map>
+
+namespace cpp_diagram {
+
+namespace {
+
+constexpr size_t kNone = ModelIndex::npos;
+
+// Direct calls and dispatched virtual calls in one flat edge array. Without
+// virtual calls to dispatch, the index's own call graph is used as is.
+struct CallGraph {
+    const ModelIndex* index = nullptr;
+    std::vector<size_t> offsets;
+    std::vector<size_t> targets;
+
+    const size_t* begin(size_t id) const {
+        return offsets.empty() ? index->callees(id).begin() : targets.data() + offsets[id];
+    }
+    const size_t* end(size_t id) const {
+        return offsets.empty() ? index->callees(id).end() : targets.data() + offsets[id + 1];
+    }
+    size_t size() const { return index->functionCount(); }
+};
+
+// Overrides in subclasses of each virtual method, by the qualified name
+// callers use. Each class walks its own ancestors once, so the cost follows
+// the hierarchy rather than the number of classes sharing a signature.
+std::unordered_map<std::string, std::vector<size_t>> overridesByMethod(const ModelIndex& index) {
+    auto key = [](size_t classId, const std::string& signature) {
+        return std::to_string(classId) + '\x1f' + signature;
+    };
+    std::unordered_map<std::string, const std::string*> declared;
+    for (size_t id = 0; id < index.classCount(); ++id) {
+        if (!index.isCanonicalClass(id)) continue;
+        for (const auto& method : index.classAt(id).methods) {
+            if (method.isVirtual && !method.isDestructor) {
+                declared.emplace(key(id, ModelIndex::signature(method)), &method.qualifiedName);
+            }
+        }
+    }
+
+    std::unordered_map<std::string, std::vector<size_t>> overrides;
+    if (declared.empty()) return overrides;
+
+    std::vector<size_t> visitedBy(index.classCount(), kNone);
+    std::vector<size_t> ancestors;
+    for (size_t id = 0; id < index.classCount(); ++id) {
+        if (!index.isCanonicalClass(id) || index.baseClasses(id).empty()) continue;
+        bool collected = false;
+        for (const auto& method : index.classAt(id).methods) {
+            if (!method.isVirtual || method.isDestructor || method.isPureVirtual) continue;
+            size_t functionId = index.findFunction(method.qualifiedName);
+            if (functionId == kNone) continue;
+
+            if (!collected) {
+                ancestors.assign(index.baseClasses(id).begin(), index.baseClasses(id).end());
+                for (size_t i = 0; i < ancestors.size(); ++i) {
+                    size_t ancestor = ancestors[i];
+                    if (visitedBy[ancestor] == id) {
+                        ancestors[i] = kNone;
+                        continue;
+                    }
+                    visitedBy[ancestor] = id;
+                    const auto& bases = index.baseClasses(ancestor);
+                    ancestors.insert(ancestors.end(), bases.begin(), bases.end());
+                }
+                collected = true;
+            }
+
+            std::string signature = ModelIndex::signature(method);
+            for (size_t ancestor : ancestors) {
+                if (ancestor == kNone) continue;
+                auto it = declared.find(key(ancestor, signature));
+                if (it != declared.end()) overrides[*it->second].push_back(functionId);
+            }
+        }
+    }
+    return overrides;
+}
+
+// Bucket the dispatched edges by caller with a counting pass, drop repeats
+// within each caller, then lay them out after the index's direct callees
+CallGraph buildCallGraph(const ModelIndex& index, size_t& directEdges, size_t& virtualEdges) {
+    size_t count = index.functionCount();
+    auto overrides = overridesByMethod(index);
+
+    CallGraph graph;
+    graph.index = &index;
+    directEdges = 0;
+    virtualEdges = 0;
+    for (size_t id = 0; id < count; ++id) directEdges += index.callees(id).size();
+
+    std::vector<std::pair<size_t, size_t>> dispatched;
+    if (!overrides.empty()) {
+        for (size_t id = 0; id < count; ++id) {
+            const FunctionInfo& function = index.functionAt(id);
+            size_t callerId = kNone;
+            for (const auto& called : function.calledFunctions) {
+                auto it = overrides.find(called);
+                if (it == overrides.end()) continue;
+                if (callerId == kNone) callerId = index.findFunction(function.qualifiedName);
+                for (size_t target : it->second) dispatched.push_back({callerId, target});
+            }
+        }
+    }
+    if (dispatched.empty()) return graph;
+
+    std::vector<size_t> dispatchOffsets(count + 1, 0);
+    for (const auto& edge : dispatched) ++dispatchOffsets[edge.first + 1];
+    for (size_t id = 0; id < count; ++id) dispatchOffsets[id + 1] += dispatchOffsets[id];
+    std::vector<size_t> dispatchTargets(dispatched.size());
+    std::vector<size_t> next(dispatchOffsets.begin(), dispatchOffsets.end() - 1);
+    for (const auto& edge : dispatched) dispatchTargets[next[edge.first]++] = edge.second;
+
+    graph.offsets.assign(count + 1, 0);
+    graph.targets.reserve(directEdges + dispatched.size());
+    std::vector<size_t> seen(count, kNone);
+    for (size_t id = 0; id < count; ++id) {
+        for (size_t target : index.callees(id)) {
+            seen[target] = id;
+            graph.targets.push_back(target);
+        }
+        for (size_t i = dispatchOffsets[id]; i < dispatchOffsets[id + 1]; ++i) {
+            size_t target = dispatchTargets[i];
+            if (seen[target] == id) continue;
+            seen[target] = id;
+            graph.targets.push_back(target);
+            ++virtualEdges;
+        }
+        graph.offsets[id + 1] = graph.targets.size();
+    }
+    return graph;
+}
+
+// Strongly connected components with Tarjan's algorithm, iteratively so deep
+// call chains cannot overflow the stack. Components are numbered callees
+// first, so every edge leaving a component points to a lower number.
+size_t stronglyConnected(const CallGraph& graph, const std::vector<size_t>& nodes,
+                         std::vector<size_t>& component) {
+    // One cache line per visit; a node is on the stack while it has an
+    // order but no component yet
+    struct Visit {
+        size_t order = kNone;
+        size_t low = 0;
+        size_t component = kNone;
+    };
+    std::vector<Visit> visits(graph.size());
+    std::vector<size_t> stack;
+    std::vector<std::pair<size_t, const size_t*>> work;  // node, next edge
+    size_t nextOrder = 0;
+    size_t nextComponent = 0;
+
+    for (size_t root : nodes) {
+        if (visits[root].order != kNone) continue;
+        visits[root].order = visits[root].low = nextOrder++;
+        stack.push_back(root);
+        work.push_back({root, graph.begin(root)});
+        while (!work.empty()) {
+            auto& [node, edge] = work.back();
+            if (edge != graph.end(node)) {
+                Visit& next = visits[*edge];
+                if (next.order == kNone) {
+                    next.order = next.low = nextOrder++;
+                    stack.push_back(*edge);
+                    work.push_back({*edge, graph.begin(*edge)});
+                    ++work[work.size() - 2].second;
+                } else {
+                    if (next.component == kNone) {
+                        visits[node].low = std::min(visits[node].low, next.order);
+                    }
+                    ++edge;
+                }
+                continue;
+            }
+
+            size_t done = node;
+            work.pop_back();
+            if (!work.empty()) {
+                Visit& caller = visits[work.back().first];
+                caller.low = std::min(caller.low, visits[done].low);
+            }
+            if (visits[done].low == visits[done].order) {
+                size_t member;
+                do {
+                    member = stack.back();
+                    stack.pop_back();
+                    visits[member].component = nextComponent;
+                } while (member != done);
+                ++nextComponent;
+            }
+        }
+    }
+
+    component.assign(graph.size(), kNone);
+    for (size_t id : nodes) component[id] = visits[id].component;
+    return nextComponent;
+}
+
+// Statements in a class's method bodies; overloads share a name and so a
+// function id, which is counted once
+int64_t classStatements(const ModelIndex& index, size_t classId) {
+    int64_t statements = 0;
+    std::vector<size_t> counted;
+    for (const auto& method : index.classAt(classId).methods) {
+        size_t functionId = index.findFunction(method.qualifiedName);
+        if (functionId == kNone || index.ownerClass(functionId) != classId ||
+            std::find(counted.begin(), counted.end(), functionId) != counted.end()) {
+            continue;
+        }
+        counted.push_back(functionId);
+        statements += index.functionAt(functionId).statements;
+    }
+    return statements;
+}
+
+} // namespace
+
+ReachabilityAnalyzer::ReachabilityAnalyzer() : roots_({"main", "*::TestBody"}) {}
+ReachabilityAnalyzer::~ReachabilityAnalyzer() = default;
+
+void ReachabilityAnalyzer::setRoots(const std::vector<std::string>& roots) {
+    roots_ = roots;
+}
+
+ReachabilityResult ReachabilityAnalyzer::analyze(const ModelIndex& index) const {
+    ReachabilityResult result;
+    size_t count = index.functionCount();
+    CallGraph graph = buildCallGraph(index, result.callEdges, result.virtualEdges);
+
+    result.depth.assign(count, -1);
+    result.parent.assign(count, kNone);
+    result.liveClasses.assign(index.classCount(), 0);
+
+    // Breadth first, so depth is the fewest calls from any root
+    std::vector<size_t> queue;
+    auto reach = [&](size_t id, size_t from, int depth) {
+        if (id == kNone || result.depth[id] >= 0) return false;
+        result.depth[id] = depth;
+        result.parent[id] = from;
+        queue.push_back(id);
+        return true;
+    };
+
+    // Constructing a class constructs its bases and members, and whoever
+    // constructs it also destroys it
+    std::vector<size_t> pendingClasses;
+    auto keepAlive = [&](size_t classId, size_t from, int depth) {
+        pendingClasses.push_back(classId);
+        while (!pendingClasses.empty()) {
+            size_t id = pendingClasses.back();
+            pendingClasses.pop_back();
+            if (id == kNone || result.liveClasses[id]) continue;
+            result.liveClasses[id] = 1;
+            const ClassInfo& classInfo = index.classAt(id);
+            for (const auto& method : classInfo.methods) {
+                if (method.isConstructor || method.isDestructor) {
+                    reach(index.findFunction(method.qualifiedName), from, depth);
+                }
+            }
+            for (size_t base : index.baseClasses(id)) {
+                pendingClasses.push_back(base);
+            }
+            for (const auto& field : classInfo.fields) {
+                if (!field.isStatic && !field.recordType.empty()) {
+                    pendingClasses.push_back(index.findClass(field.recordType));
+                }
+            }
+        }
+    };
+
+    for (const auto& root : roots_) {
+        bool matched = false;
+        if (root.find('*') == std::string::npos) {
+            size_t id = index.findFunction(root);
+            matched = id != kNone;
+            if (reach(id, kNone, 0)) result.roots.push_back(id);
+        } else {
+            for (size_t id = 0; id < count; ++id) {
+                if (!index.isCanonicalFunction(id) || !globMatch(root, index.functionAt(id).qualifiedName)) {
+                    continue;
+                }
+                matched = true;
+                if (reach(id, kNone, 0)) result.roots.push_back(id);
+            }
+        }
+        if (!matched) result.unmatchedRoots.push_back(root);
+    }
+
+    for (size_t head = 0; head < queue.size(); ++head) {
+        size_t id = queue[head];
+        int next = result.depth[id] + 1;
+        const FunctionInfo& function = index.functionAt(id);
+        keepAlive(index.ownerClass(id), id, next);
+        if (!function.returnRecordType.empty()) {
+            keepAlive(index.findClass(function.returnRecordType), id, next);
+        }
+        for (const auto& recordType : function.parameterRecordTypes) {
+            if (!recordType.empty()) keepAlive(index.findClass(recordType), id, next);
+        }
+        for (const size_t* callee = graph.begin(id); callee != graph.end(id); ++callee) {
+            reach(*callee, id, next);
+        }
+    }
+
+    // Everything a reachable function calls is reachable, so the components
+    // of the reached nodes are closed under their edges
+    size_t components = stronglyConnected(graph, queue, result.component);
+    std::vector<size_t> memberOffsets(components + 1, 0);
+    for (size_t id : queue) ++memberOffsets[result.component[id] + 1];
+    for (size_t c = 0; c < components; ++c) memberOffsets[c + 1] += memberOffsets[c];
+    std::vector<size_t> members(queue.size());
+    std::vector<size_t> nextMember(memberOffsets.begin(), memberOffsets.end() - 1);
+    for (size_t id : queue) members[nextMember[result.component[id]]++] = id;
+
+    // Longest chain per component in numbering order, callees first
+    std::vector<size_t> height(components, 1);
+    std::vector<size_t> successor(components, kNone);
+    for (size_t c = 0; c < components; ++c) {
+        size_t size = memberOffsets[c + 1] - memberOffsets[c];
+        bool recursive = size > 1;
+        for (size_t i = memberOffsets[c]; i < memberOffsets[c + 1]; ++i) {
+            size_t id = members[i];
+            for (const size_t* callee = graph.begin(id); callee != graph.end(id); ++callee) {
+                size_t target = result.component[*callee];
+                if (target == c) {
+                    recursive = recursive || *callee == id;
+                } else if (height[target] + 1 > height[c]) {
+                    height[c] = height[target] + 1;
+                    successor[c] = *callee;
+                }
+            }
+        }
+        if (recursive) {
+            result.cycles.emplace_back(members.begin() + memberOffsets[c], members.begin() + memberOffsets[c + 1]);
+        }
+    }
+
+    size_t start = kNone;
+    for (size_t root : result.roots) {
+        if (start == kNone || height[result.component[root]] > height[result.component[start]]) start = root;
+    }
+    for (size_t id = start; id != kNone; id = successor[result.component[id]]) {
+        result.longestChain.push_back(id);
+    }
+
+    return result;
+}
+
+std::string ReachabilityAnalyzer::generateReport(const ModelIndex& index, const ReachabilityResult& result,
+                                                 size_t limit) const {
+    // (statements, id), largest first once sorted
+    std::vector<std::pair<int64_t, size_t>> deadFunctions;
+    size_t liveFunctions = 0;
+    int64_t deadStatements = 0;
+    int maxDepth = 0;
+    std::vector<size_t> depths;
+    for (size_t id = 0; id < index.functionCount(); ++id) {
+        if (!index.isCanonicalFunction(id) || isSystemEntity(index.functionAt(id))) continue;
+        int depth = result.depth[id];
+        if (depth < 0) {
+            deadFunctions.push_back({index.functionAt(id).statements, id});
+            deadStatements += deadFunctions.back().first;
+            continue;
+        }
+        ++liveFunctions;
+        maxDepth = std::max(maxDepth, depth);
+        if (depths.size() <= static_cast<size_t>(depth)) depths.resize(depth + 1, 0);
+        ++depths[depth];
+    }
+
+    std::vector<std::pair<int64_t, size_t>> deadClasses;
+    size_t liveClasses = 0;
+    for (size_t id = 0; id < index.classCount(); ++id) {
+        if (!index.isCanonicalClass(id) || isSystemEntity(index.classAt(id))) continue;
+        if (result.liveClasses[id]) {
+            ++liveClasses;
+        } else {
+            deadClasses.push_back({classStatements(index, id), id});
+        }
+    }
+
+    // Only the first entries are listed
+    auto largestFirst = [limit](std::vector<std::pair<int64_t, size_t>>& entries) {
+        auto middle = entries.begin() + std::min(limit, entries.size());
+        std::partial_sort(entries.begin(), middle, entries.end(), [](const auto& a, const auto& b) {
+            return a.first != b.first ? a.first > b.first : a.second < b.second;
+        });
+    };
+    largestFirst(deadFunctions);
+    largestFirst(deadClasses);
+
+    std::stringstream ss;
+    ss << "Reachability:\n";
+    ss << "  Roots:";
+    for (const auto& root : roots_) ss << " " << root;
+    ss << " (" << result.roots.size() << " functions)\n";
+    if (!result.unmatchedRoots.empty()) {
+        ss << "  Not found:";
+        for (const auto& root : result.unmatchedRoots) ss << " " << root;
+        ss << "\n";
+    }
+    ss << "  Functions: " << liveFunctions << " reachable, " << deadFunctions.size() << " unreachable ("
+       << deadStatements << " statements)\n";
+    ss << "  Classes: " << liveClasses << " live, " << deadClasses.size() << " unreachable\n";
+    ss << "  Call edges: " << result.callEdges << ", plus " << result.virtualEdges
+       << " to overrides of virtual methods\n";
+    ss << "  Max depth: " << maxDepth << ", longest call chain: " << result.longestChain.size()
+       << " (recursion collapsed), recursive cycles: " << result.cycles.size() << "\n";
+
+    ss << "\nUnreachable Functions:\n";
+    ss << "  " << std::setw(10) << "statements" << "  function\n";
+    for (size_t i = 0; i < deadFunctions.size() && i < limit; ++i) {
+        const FunctionInfo& function = index.functionAt(deadFunctions[i].second);
+        ss << "  " << std::setw(10) << function.statements << "  " << function.qualifiedName;
+        if (!function.file.empty()) ss << "  (" << function.file << ")";
+        ss << "\n";
+    }
+    if (deadFunctions.size() > limit) ss << "  ... and " << deadFunctions.size() - limit << " more\n";
+
+    ss << "\nUnreachable Classes:\n";
+    ss << "  " << std::setw(10) << "statements" << std::setw(8) << "bytes" << "  class\n";
+    for (size_t i = 0; i < deadClasses.size() && i < limit; ++i) {
+        const ClassInfo& classInfo = index.classAt(deadClasses[i].second);
+        ss << "  " << std::setw(10) << deadClasses[i].first << std::setw(8);
+        if (classInfo.hasLayout) {
+            ss << classInfo.size;
+        } else {
+            ss << "-";
+        }
+        ss << "  " << classInfo.qualifiedName;
+        if (!classInfo.file.empty()) ss << "  (" << classInfo.file << ")";
+        ss << "\n";
+    }
+    if (deadClasses.size() > limit) ss << "  ... and " << deadClasses.size() - limit << " more\n";
+
+    ss << "\nRecursion:\n";
+    if (result.cycles.empty()) ss << "  (none)\n";
+    for (size_t i = 0; i < result.cycles.size() && i < limit; ++i) {
+        const auto& cycle = result.cycles[i];
+        int depth = result.depth[cycle.front()];
+        for (size_t id : cycle) depth = std::min(depth, result.depth[id]);
+        ss << "  depth " << depth << ", size " << cycle.size() << ":";
+        for (size_t j = 0; j < cycle.size() && j < limit; ++j) {
+            ss << (j > 0 ? ", " : " ") << index.functionAt(cycle[j]).qualifiedName;
+        }
+        if (cycle.size() > limit) ss << ", ...";
+        ss << "\n";
+    }
+    if (result.cycles.size() > limit) ss << "  ... and " << result.cycles.size() - limit << " more\n";
+
+    ss << "\nLongest Call Chain:\n";
+    if (result.longestChain.empty()) ss << "  (none)\n";
+    for (size_t i = 0; i < result.longestChain.size(); ++i) {
+        ss << "  " << (i > 0 ? "-> " : "") << index.functionAt(result.longestChain[i]).qualifiedName << "\n";
+    }
+
+    ss << "\nCall Depth:\n";
+    ss << "  " << std::setw(6) << "depth" << std::setw(10) << "functions" << "\n";
+    for (size_t depth = 0; depth < depths.size(); ++depth) {
+        ss << "  " << std::setw(6) << depth << std::setw(10) << depths[depth] << "\n";
+    }
+
+    return ss.str();
+}
+
+} // namespace cpp_diagram
@@ -0,0 +1,59 @@
+#include "analysis/template_analyzer.h"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace cpp_diagram {
+
+TemplateAnalyzer::TemplateAnalyzer() = default;
+TemplateAnalyzer::~TemplateAnalyzer() = default;
+
+std::vector<TemplateCost> TemplateAnalyzer::rankTemplates(const std::vector<TemplateInfo>& templates) const {
+    int64_t totalNodes = 0;
+    for (const auto& info : templates) {
+        totalNodes += info.astNodes;
+    }
+
+    std::vector<TemplateCost> ranking;
+    for (const auto& info : templates) {
+        double share = totalNodes > 0 ? static_cast<double>(info.astNodes) / totalNodes : 0.0;
+        ranking.push_back({&info, share});
+    }
+
+    std::stable_sort(ranking.begin(), ranking.end(), [](const TemplateCost& a, const TemplateCost& b) {
+        return a.info->astNodes > b.info->astNodes;
+    });
+    return ranking;
+}
+
+std::string TemplateAnalyzer::generateReport(const std::vector<TemplateInfo>& templates, size_t limit) const {
+    std::stringstream ss;
+    auto ranking = rankTemplates(templates);
+
+    int instantiations = 0;
+    int64_t totalNodes = 0;
+    for (const auto& info : templates) {
+        instantiations += info.instantiations;
+        totalNodes += info.astNodes;
+    }
+
+    ss << "Template Instantiation Cost:\n";
+    ss << "  Templates: " << templates.size() << ", instantiations: " << instantiations
+       << ", instantiated AST nodes: " << totalNodes << "\n\n";
+    ss << "  " << std::setw(4) << "#" << std::setw(12) << "AST nodes" << std::setw(8) << "share"
+       << std::setw(8) << "inst" << std::setw(10) << "distinct" << "  template\n";
+
+    for (size_t i = 0; i < ranking.size() && i < limit; ++i) {
+        const TemplateInfo& info = *ranking[i].info;
+        ss << "  " << std::setw(4) << i + 1
+           << std::setw(12) << info.astNodes
+           << std::setw(7) << std::fixed << std::setprecision(1) << ranking[i].share * 100.0 << "%"
+           << std::setw(8) << info.instantiations
+           << std::setw(10) << info.arguments.size()
+           << "  " << info.name << (info.isClassTemplate ? " (class)" : " (function)") << "\n";
+    }
+
+    return ss.str();
+}
+
+} // namespace cpp_diagram
@@ -1,26 +1,229 @@
 #include <iostream>
+#include <fstream>
+#include <memory>
 #include <string>
 #include <vector>
+#include <algorithm>
 #include <filesystem>
 #include <cxxopts.hpp>
 #include "parser/ast_parser.h"
+#include "parser/preamble_cache.h"
 #include "visualizer/diagram_generator.h"
 #include "analysis/code_analyzer.h"
+#include "analysis/devirtualization_analyzer.h"
+#include "analysis/layout_analyzer.h"
+#include "analysis/concurrency_analyzer.h"
+#include "analysis/include_analyzer.h"
+#include "analysis/template_analyzer.h"
+#include "analysis/profile_analyzer.h"
+#include "analysis/model_diff.h"
+#include "analysis/component_analyzer.h"
+#include "analysis/perf_lint_analyzer.h"
+#include "analysis/graph_query.h"
+#include "analysis/reachability_analyzer.h"
+#include "analysis/model_index.h"
+#include "profiling/tracer.h"
+#include "model/model_file.h"
+#include "model/model_merger.h"
 
 namespace fs = std::filesystem;
 
+// Write a text report next to the diagrams
+static bool writeReport(const fs::path& path, const std::string& text) {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Error: Cannot write " << path.string() << std::endl;
+        return false;
+    }
+    file << text;
+    return true;
+}
+
+// Where the shared precompiled preamble is cached, empty if turned off
+static std::string preambleCache(const cxxopts::ParseResult& result) {
+    if (result["no-pch"].as<bool>()) {
+        return "";
+    }
+    if (result.count("pch-cache")) {
+        return result["pch-cache"].as<std::string>();
+    }
+    return cpp_diagram::PreambleCache::defaultDirectory();
+}
+
+// Parse "i/N" into a zero-based shard index and a shard count
+static bool parseShard(const std::string& text, size_t& index, size_t& count) {
+    size_t slash = text.find('/');
+    if (slash == std::string::npos) {
+        return false;
+    }
+    try {
+        index = std::stoul(text.substr(0, slash));
+        count = std::stoul(text.substr(slash + 1));
+    } catch (const std::exception&) {
+        return false;
+    }
+    return count > 0 && index < count;
+}
+
+// Parse this shard's share of the inputs and save it as a partial model.
+// Files are sorted before being dealt out round-robin, so every runner
+// computes the same partition whatever order its shell lists them in.
+static int runShard(const cxxopts::ParseResult& result) {
+    size_t index = 0;
+    size_t count = 0;
+    if (!parseShard(result["shard"].as<std::string>(), index, count)) {
+        std::cerr << "Error: --shard expects i/N with 0 <= i < N" << std::endl;
+        return 1;
+    }
+    if (!result.count("input") || !result.count("save-model")) {
+        std::cerr << "Error: --shard needs --input and --save-model" << std::endl;
+        return 1;
+    }
+
+    auto inputFiles = result["input"].as<std::vector<std::string>>();
+    std::sort(inputFiles.begin(), inputFiles.end());
+    inputFiles.erase(std::unique(inputFiles.begin(), inputFiles.end()), inputFiles.end());
+    std::vector<std::string> shardFiles;
+    for (size_t i = index; i < inputFiles.size(); i += count) {
+        shardFiles.push_back(inputFiles[i]);
+    }
+
+    std::unique_ptr<cpp_diagram::Tracer> tracer;
+    if (result.count("trace")) {
+        tracer = std::make_unique<cpp_diagram::Tracer>();
+    }
+
+    // A shard can be empty when there are more shards than files
+    cpp_diagram::ASTParser parser;
+    parser.setTracer(tracer.get());
+    // Throwing-move findings pair facts from different files, so a shard
+    // only reports them when both facts land in its own files
+    parser.setCollectPerfLint(result["lint"].as<bool>(), result["lint-copy-size"].as<int>());
+    parser.setPreambleCache(preambleCache(result));
+    if (!shardFiles.empty() && !parser.parseFiles(shardFiles)) {
+        std::cerr << "Error: Failed to parse input files" << std::endl;
+        return 1;
+    }
+    if (!cpp_diagram::ModelFile::save(result["save-model"].as<std::string>(), parser.getClassInfo(),
+                                      parser.getFunctionInfo(), parser.getRelationships())) {
+        return 1;
+    }
+
+    std::cout << "Shard " << index << "/" << count << ": parsed " << shardFiles.size()
+              << " of " << inputFiles.size() << " files" << std::endl;
+
+    if (tracer) {
+        std::string tracePath = result["trace"].as<std::string>();
+        if (!tracer->writeChromeTrace(tracePath)) {
+            std::cerr << "Error: Cannot write trace file " << tracePath << std::endl;
+            return 1;
+        }
+        std::cout << tracer->generateSummary();
+    }
+    return 0;
+}
+
+// merge: combine shard models into one model file
+static int runMerge(int argc, char* argv[]) {
+    cxxopts::Options options("cpp_diagram_visualizer merge",
+                           "Merge partial models written with --shard");
+    options.add_options()
+        ("o,output", "Merged model file", cxxopts::value<std::string>())
+        ("models", "Shard model files", cxxopts::value<std::vector<std::string>>())
+        ("h,help", "Print usage");
+    options.parse_positional({"models"});
+    options.positional_help("SHARD_MODEL...");
+
+    auto result = options.parse(argc, argv);
+    if (result.count("help")) {
+        std::cout << options.help() << std::endl;
+        return 0;
+    }
+    if (!result.count("output") || !result.count("models")) {
+        std::cerr << "Error: Missing required arguments" << std::endl;
+        std::cout << options.help() << std::endl;
+        return 1;
+    }
+
+    cpp_diagram::ModelMerger merger;
+    for (const auto& path : result["models"].as<std::vector<std::string>>()) {
+        std::vector<cpp_diagram::ClassInfo> classes;
+        std::vector<cpp_diagram::FunctionInfo> functions;
+        std::vector<cpp_diagram::RelationshipInfo> relationships;
+        cpp_diagram::ModelFile modelFile;
+        if (!modelFile.open(path) || !modelFile.load(classes, functions, relationships)) {
+            std::cerr << "Error: Failed to load model " << path << std::endl;
+            return 1;
+        }
+        merger.add(std::move(classes), std::move(functions), std::move(relationships));
+    }
+
+    if (!cpp_diagram::ModelFile::save(result["output"].as<std::string>(), merger.classes(),
+                                      merger.functions(), merger.relationships())) {
+        return 1;
+    }
+    std::cout << "Merged " << merger.classes().size() << " classes, " << merger.functions().size()
+              << " functions and " << merger.relationships().size() << " relationships" << std::endl;
+    return 0;
+}
+
 int main(int argc, char* argv[]) {
     try {
+        if (argc > 1 && std::string(argv[1]) == "merge") {
+            return runMerge(argc - 1, argv + 1);
+        }
+
         cxxopts::Options options("cpp_diagram_visualizer",
                                "C++ Code to Diagram Visualization Tool");
 
         options.add_options()
             ("i,input", "Input C++ source files", cxxopts::value<std::vector<std::string>>())
             ("o,output", "Output directory for diagrams", cxxopts::value<std::string>())
-            ("t,type", "Diagram type (class, call, component)", cxxopts::value<std::string>())
+            ("t,type", "Diagram type (class, call, component, layout, concurrency, include, devirt, reach, diff)", cxxopts::value<std::string>())
             ("f,format", "Output format (png, svg, pdf)", cxxopts::value<std::string>()->default_value("png"))
             ("s,style", "Diagram style", cxxopts::value<std::string>()->default_value("default"))
-            ("d,detail", "Detail level (1-3)", cxxopts::value<int>()->default_value("2"))
+            ("d,detail", "Detail level (1-3): names only, public API, or every member. Node labels show every member unless given",
+             cxxopts::value<int>()->default_value("2"))
+            ("member-limit", "Members listed per class node before the rest are folded (0 for all)",
+             cxxopts::value<int>()->default_value("0"))
+            ("templates", "Profile template instantiations and shade them in class and call diagrams",
+             cxxopts::value<bool>()->default_value("false"))
+            ("trace", "Write a Chrome trace-event JSON file of phase timings and print a summary",
+             cxxopts::value<std::string>())
+            ("save-model", "Save the parsed model to a memory-mappable file",
+             cxxopts::value<std::string>())
+            ("load-model", "Load a model saved with --save-model instead of parsing",
+             cxxopts::value<std::string>())
+            ("group", "Derive components from source directories or namespaces (directory, namespace)",
+             cxxopts::value<std::string>()->default_value("directory"))
+            ("component-depth", "Leading directory or namespace parts that name a component (0 for all)",
+             cxxopts::value<int>()->default_value("0"))
+            ("layers", "Component layers from top to bottom; lower layers must not depend on higher ones (comma separated)",
+             cxxopts::value<std::vector<std::string>>())
+            ("base-model", "Saved model to compare against for diff", cxxopts::value<std::string>())
+            ("base-input", "Source files to compare against for diff", cxxopts::value<std::vector<std::string>>())
+            ("profile", "Overlay a sampled profile (collapsed stacks or perf script output) on the call graph",
+             cxxopts::value<std::string>())
+            ("profile-threshold", "Prune call graph functions below this inclusive sample share, in percent",
+             cxxopts::value<double>()->default_value("0"))
+            ("shard", "Parse only shard i of N (zero-based, e.g. 2/8) and save it with --save-model",
+             cxxopts::value<std::string>())
+            ("lint", "Flag allocations in loops, large by-value copies, throwing moves and std::function parameters",
+             cxxopts::value<bool>()->default_value("false"))
+            ("lint-copy-size", "Parameters copied by value above this many bytes are flagged by --lint",
+             cxxopts::value<int>()->default_value("16"))
+            ("write-threshold", "Fields written at this many sites count as frequently written in concurrency diagrams",
+             cxxopts::value<int>()->default_value("2"))
+            ("pch-cache", "Directory for the precompiled include block shared by all inputs (default: ~/.cache/cpp_diagram/preamble)",
+             cxxopts::value<std::string>())
+            ("no-pch", "Parse every input's includes from scratch instead of using a shared precompiled preamble",
+             cxxopts::value<bool>()->default_value("false"))
+            ("q,query", "Only diagram what a query matches, e.g. \"classes where derives(Shape) and calls(Logger::log)\"",
+             cxxopts::value<std::string>())
+            ("roots", "Entry points for reach, by qualified name or glob (comma separated)",
+             cxxopts::value<std::vector<std::string>>()->default_value("main,*::TestBody"))
+            ("hot", "Hot functions to weight performance reports (comma separated)",
+             cxxopts::value<std::vector<std::string>>())
             ("h,help", "Print usage");
 
         auto result = options.parse(argc, argv);
@@ -30,7 +233,12 @@ int main(int argc, char* argv[]) {
             return 0;
         }
 
-        if (!result.count("input") || !result.count("output") || !result.count("type")) {
+        if (result.count("shard")) {
+            return runShard(result);
+        }
+
+        bool loadModel = result.count("load-model") > 0;
+        if ((!result.count("input") && !loadModel) || !result.count("output") || !result.count("type")) {
             std::cerr << "Error: Missing required arguments" << std::endl;
             std::cout << options.help() << std::endl;
             return 1;
@@ -47,46 +255,242 @@ int main(int argc, char* argv[]) {
         cpp_diagram::DiagramGenerator diagramGenerator;
         cpp_diagram::CodeAnalyzer analyzer;
 
-        // Parse input files
-        auto inputFiles = result["input"].as<std::vector<std::string>>();
-        if (!parser.parseFiles(inputFiles)) {
-            std::cerr << "Error: Failed to parse input files" << std::endl;
-            return 1;
+        // Optional phase instrumentation
+        std::unique_ptr<cpp_diagram::Tracer> tracer;
+        if (result.count("trace")) {
+            tracer = std::make_unique<cpp_diagram::Tracer>();
+            parser.setTracer(tracer.get());
+            diagramGenerator.setTracer(tracer.get());
         }
 
-        // Get parsed information
-        auto classes = parser.getClassInfo();
-        auto functions = parser.getFunctionInfo();
-        auto relationships = parser.getRelationships();
+        // Preprocessor instrumentation is only paid for when it is used
+        std::string diagramType = result["type"].as<std::string>();
+        parser.setCollectIncludes(diagramType == "include");
+        bool profileTemplates = result["templates"].as<bool>();
+        parser.setCollectTemplates(profileTemplates);
+        bool perfLint = result["lint"].as<bool>();
+        parser.setCollectPerfLint(perfLint, result["lint-copy-size"].as<int>());
+        parser.setPreambleCache(preambleCache(result));
+
+        std::vector<cpp_diagram::ClassInfo> classes;
+        std::vector<cpp_diagram::FunctionInfo> functions;
+        std::vector<cpp_diagram::RelationshipInfo> relationships;
+
+        if (loadModel) {
+            // Header and template data are only collected while parsing
+            if (diagramType == "include" || profileTemplates) {
+                std::cerr << "Error: Include graphs and --templates need the sources, not a saved model" << std::endl;
+                return 1;
+            }
+            cpp_diagram::TraceScope scope(tracer.get(), "loadModel", "load");
+            cpp_diagram::ModelFile modelFile;
+            if (!modelFile.open(result["load-model"].as<std::string>()) ||
+                !modelFile.load(classes, functions, relationships)) {
+                std::cerr << "Error: Failed to load model" << std::endl;
+                return 1;
+            }
+        } else {
+            // Parse input files
+            auto inputFiles = result["input"].as<std::vector<std::string>>();
+            if (!parser.parseFiles(inputFiles)) {
+                std::cerr << "Error: Failed to parse input files" << std::endl;
+                return 1;
+            }
+
+            // Get parsed information
+            classes = parser.getClassInfo();
+            functions = parser.getFunctionInfo();
+            relationships = parser.getRelationships();
+        }
+
+        if (result.count("save-model")) {
+            cpp_diagram::TraceScope scope(tracer.get(), "saveModel", "save");
+            if (!cpp_diagram::ModelFile::save(result["save-model"].as<std::string>(),
+                                              classes, functions, relationships)) {
+                return 1;
+            }
+        }
+
+        // Narrow the model to a query's matches; every diagram and report
+        // below then works on that subset
+        cpp_diagram::GraphQuery query;
+        if (result.count("query")) {
+            cpp_diagram::TraceScope scope(tracer.get(), "query", "analysis");
+            if (!query.compile(result["query"].as<std::string>())) {
+                std::cerr << "Error: Invalid query: " << query.error() << std::endl;
+                return 1;
+            }
+            cpp_diagram::ModelIndex index(classes, functions, relationships);
+            cpp_diagram::QueryResult matches = query.run(index);
+            scope.setCounter("matches", static_cast<int64_t>(matches.ids.size()));
+            writeReport(outputDir / "query.txt", query.generateReport(index, matches));
+            cpp_diagram::GraphQuery::select(index, matches, classes, functions, relationships);
+        }
 
         // Set diagram style and format
         diagramGenerator.setStyle(result["style"].as<std::string>());
         diagramGenerator.setOutputFormat(result["format"].as<std::string>());
+        // Node labels keep every member unless asked otherwise; the default
+        // detail level only shapes summary.txt
+        if (result.count("detail") || result.count("member-limit")) {
+            diagramGenerator.setDetailLevel(result.count("detail") ? result["detail"].as<int>() : 3,
+                                            static_cast<size_t>(std::max(result["member-limit"].as<int>(), 0)));
+        }
+
+        if (profileTemplates) {
+            auto templates = parser.getTemplateInfo();
+            cpp_diagram::TemplateAnalyzer templateAnalyzer;
+            diagramGenerator.setTemplateCosts(templates);
+            writeReport(outputDir / "templates.txt", templateAnalyzer.generateReport(templates, 50));
+        }
+
+        if (result.count("profile")) {
+            cpp_diagram::TraceScope scope(tracer.get(), "loadProfile", "analysis");
+            cpp_diagram::ProfileAnalyzer profileAnalyzer;
+            cpp_diagram::ProfileData profile;
+            if (!profileAnalyzer.load(result["profile"].as<std::string>(), functions, profile)) {
+                return 1;
+            }
+            diagramGenerator.setProfile(profile, result["profile-threshold"].as<double>() / 100.0);
+            writeReport(outputDir / "profile.txt", profileAnalyzer.generateReport(profile, 50));
+        }
+
+        // Findings were attached while parsing, or saved with the model
+        std::vector<cpp_diagram::PerfLintEntry> lintEntries;
+        cpp_diagram::PerfLintAnalyzer lintAnalyzer;
+        if (perfLint) {
+            if (result.count("hot")) {
+                lintAnalyzer.setHotFunctions(result["hot"].as<std::vector<std::string>>());
+            }
+            lintEntries = lintAnalyzer.analyze(classes, functions);
+            diagramGenerator.setPerfFindings(lintEntries);
+            writeReport(outputDir / "lint.json", lintAnalyzer.generateJson(lintEntries));
+        }
 
         // Generate requested diagram type
-        std::string diagramType = result["type"].as<std::string>();
         std::string outputFile = (outputDir / (diagramType + "." + result["format"].as<std::string>())).string();
 
+        auto generateScope = std::make_unique<cpp_diagram::TraceScope>(
+            tracer.get(), "generate " + diagramType, "diagram");
+        generateScope->setCounter("classes", static_cast<int64_t>(classes.size()));
+        generateScope->setCounter("functions", static_cast<int64_t>(functions.size()));
+        generateScope->setCounter("relationships", static_cast<int64_t>(relationships.size()));
+
         bool success = false;
         if (diagramType == "class") {
             success = diagramGenerator.generateClassDiagram(classes, relationships, outputFile);
         } else if (diagramType == "call") {
             success = diagramGenerator.generateCallGraph(functions, outputFile);
         } else if (diagramType == "component") {
-            success = diagramGenerator.generateComponentDiagram(classes, outputFile);
+            cpp_diagram::ComponentAnalyzer componentAnalyzer;
+            if (!componentAnalyzer.setGrouping(result["group"].as<std::string>(),
+                                               result["component-depth"].as<int>())) {
+                std::cerr << "Error: Unknown component grouping: " << result["group"].as<std::string>() << std::endl;
+                return 1;
+            }
+            if (result.count("layers")) {
+                componentAnalyzer.setLayers(result["layers"].as<std::vector<std::string>>());
+            }
+            auto components = componentAnalyzer.analyze(classes, functions, relationships);
+            success = diagramGenerator.generateComponentDiagram(components, outputFile) &&
+                      writeReport(outputDir / "components.txt", componentAnalyzer.generateReport(components));
+        } else if (diagramType == "layout") {
+            cpp_diagram::LayoutAnalyzer layoutAnalyzer;
+            auto layouts = layoutAnalyzer.analyze(classes);
+            success = diagramGenerator.generateLayoutDiagram(layouts, outputFile) &&
+                      writeReport(outputDir / "layout.txt", layoutAnalyzer.generateReport(layouts));
+        } else if (diagramType == "concurrency") {
+            cpp_diagram::ConcurrencyAnalyzer concurrencyAnalyzer;
+            concurrencyAnalyzer.setWriteThreshold(result["write-threshold"].as<int>());
+            auto layouts = concurrencyAnalyzer.analyze(classes, functions);
+            success = diagramGenerator.generateConcurrencyDiagram(layouts, outputFile) &&
+                      writeReport(outputDir / "concurrency.txt", concurrencyAnalyzer.generateReport(layouts));
+        } else if (diagramType == "include") {
+            auto headers = parser.getHeaderInfo();
+            cpp_diagram::IncludeAnalyzer includeAnalyzer;
+            success = diagramGenerator.generateIncludeDiagram(headers, outputFile) &&
+                      writeReport(outputDir / "includes.txt", includeAnalyzer.generateReport(headers, 50));
+        } else if (diagramType == "devirt") {
+            cpp_diagram::ModelIndex index(classes, functions, relationships);
+            cpp_diagram::DevirtualizationAnalyzer devirtualizer;
+            if (result.count("hot")) {
+                devirtualizer.setHotFunctions(result["hot"].as<std::vector<std::string>>());
+            }
+            auto candidates = devirtualizer.analyze(index);
+            success = writeReport(outputDir / "devirtualization.txt",
+                                  devirtualizer.generateReport(candidates, devirtualizer.hierarchyStats(index)));
+        } else if (diagramType == "reach") {
+            cpp_diagram::ModelIndex index(classes, functions, relationships);
+            cpp_diagram::ReachabilityAnalyzer reachability;
+            reachability.setRoots(result["roots"].as<std::vector<std::string>>());
+            auto reached = reachability.analyze(index);
+            if (reached.roots.empty()) {
+                std::cerr << "Warning: No function matches --roots; everything is reported unreachable" << std::endl;
+            }
+            generateScope->setCounter("reachable", static_cast<int64_t>(
+                std::count_if(reached.depth.begin(), reached.depth.end(), [](int depth) { return depth >= 0; })));
+            success = writeReport(outputDir / "reachability.txt", reachability.generateReport(index, reached, 100));
+        } else if (diagramType == "diff") {
+            // The model loaded above is the head; the base comes from a
+            // second saved model or a second set of sources
+            std::vector<cpp_diagram::ClassInfo> baseClasses;
+            std::vector<cpp_diagram::FunctionInfo> baseFunctions;
+            std::vector<cpp_diagram::RelationshipInfo> baseRelationships;
+            if (result.count("base-model")) {
+                cpp_diagram::ModelFile baseModel;
+                if (!baseModel.open(result["base-model"].as<std::string>()) ||
+                    !baseModel.load(baseClasses, baseFunctions, baseRelationships)) {
+                    std::cerr << "Error: Failed to load base model" << std::endl;
+                    return 1;
+                }
+            } else if (result.count("base-input")) {
+                cpp_diagram::ASTParser baseParser;
+                baseParser.setTracer(tracer.get());
+                baseParser.setPreambleCache(preambleCache(result));
+                if (!baseParser.parseFiles(result["base-input"].as<std::vector<std::string>>())) {
+                    std::cerr << "Error: Failed to parse base input files" << std::endl;
+                    return 1;
+                }
+                baseClasses = baseParser.getClassInfo();
+                baseFunctions = baseParser.getFunctionInfo();
+                baseRelationships = baseParser.getRelationships();
+            } else {
+                std::cerr << "Error: diff needs --base-model or --base-input" << std::endl;
+                return 1;
+            }
+            // Narrow the base like the head so the diff compares like with like
+            if (result.count("query")) {
+                cpp_diagram::ModelIndex baseIndex(baseClasses, baseFunctions, baseRelationships);
+                cpp_diagram::GraphQuery::select(baseIndex, query.run(baseIndex),
+                                                baseClasses, baseFunctions, baseRelationships);
+            }
+
+            cpp_diagram::ModelDiffer differ;
+            auto diff = differ.compare(baseClasses, baseFunctions, baseRelationships,
+                                       classes, functions, relationships);
+            success = diagramGenerator.generateDiffDiagram(diff, outputFile) &&
+                      writeReport(outputDir / "diff.txt", differ.generateReport(diff));
         } else {
             std::cerr << "Error: Unknown diagram type: " << diagramType << std::endl;
             return 1;
         }
 
+        generateScope.reset();
+
         if (!success) {
             std::cerr << "Error: Failed to generate diagram" << std::endl;
             return 1;
         }
 
         // Generate code analysis summary
-        auto summary = analyzer.analyzeCodebase(classes, functions);
+        auto analysisScope = std::make_unique<cpp_diagram::TraceScope>(
+            tracer.get(), "analyzeCodebase", "analysis");
+        auto summary = analyzer.analyzeCodebase(classes, functions, relationships);
         std::string summaryText = analyzer.generateSummary(summary, result["detail"].as<int>());
+        if (perfLint) {
+            summaryText += lintAnalyzer.generateReport(lintEntries);
+        }
+        analysisScope.reset();
 
         // Write summary to file
         std::ofstream summaryFile(outputDir / "summary.txt");
@@ -96,6 +500,15 @@ int main(int argc, char* argv[]) {
         }
 
         std::cout << "Successfully generated " << diagramType << " diagram and analysis summary" << std::endl;
+
+        if (tracer) {
+            std::string tracePath = result["trace"].as<std::string>();
+            if (!tracer->writeChromeTrace(tracePath)) {
+                std::cerr << "Error: Cannot write trace file " << tracePath << std::endl;
+                return 1;
+            }
+            std::cout << tracer->generateSummary();
+        }
         return 0;
 
     } catch (const cxxopts::OptionException& e) {
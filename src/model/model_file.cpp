@@ -0,0 +1,531 @@
+#include "model/model_file.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace cpp_diagram {
+
+using namespace model_format;
+
+// Records are written and mapped as raw bytes; their layout must not change
+// without bumping kVersion
+static_assert(sizeof(StringRef) == 16, "StringRef layout changed");
+static_assert(sizeof(Range) == 16, "Range layout changed");
+static_assert(sizeof(Header) == 152, "Header layout changed");
+static_assert(sizeof(FunctionRecord) == 192, "FunctionRecord layout changed");
+static_assert(sizeof(FieldRecord) == 80, "FieldRecord layout changed");
+static_assert(sizeof(ClassRecord) == 176, "ClassRecord layout changed");
+static_assert(sizeof(RelationshipRecord) == 72, "RelationshipRecord layout changed");
+static_assert(sizeof(FindingRecord) == 24, "FindingRecord layout changed");
+
+namespace {
+
+constexpr uint64_t kSectionAlignment = 8;
+
+uint64_t alignUp(uint64_t value) {
+    return (value + kSectionAlignment - 1) / kSectionAlignment * kSectionAlignment;
+}
+
+// Flattens a model into the file's sections, interning each distinct
+// string once
+class ModelBuilder {
+public:
+    StringRef intern(const std::string& text) {
+        auto it = stringOffsets_.find(text);
+        if (it == stringOffsets_.end()) {
+            it = stringOffsets_.emplace(text, strings.size()).first;
+            strings += text;
+        }
+        return {it->second, text.size()};
+    }
+
+    Range addList(const std::vector<std::string>& items) {
+        Range range{stringLists.size(), items.size()};
+        for (const auto& item : items) {
+            stringLists.push_back(intern(item));
+        }
+        return range;
+    }
+
+    Range addFindings(const std::vector<PerfFinding>& items) {
+        Range range{findings.size(), items.size()};
+        for (const auto& item : items) {
+            findings.push_back({intern(item.message), static_cast<uint32_t>(item.issue),
+                                static_cast<uint32_t>(item.line)});
+        }
+        return range;
+    }
+
+    FunctionRecord function(const FunctionInfo& function) {
+        FunctionRecord record{};
+        record.name = intern(function.name);
+        record.qualifiedName = intern(function.qualifiedName);
+        record.returnType = intern(function.returnType);
+        record.returnRecordType = intern(function.returnRecordType);
+        record.parameters = addList(function.parameters);
+        record.parameterRecordTypes = addList(function.parameterRecordTypes);
+        record.templateParameters = addList(function.templateParameters);
+        record.calledFunctions = addList(function.calledFunctions);
+        record.writtenFields = addList(function.writtenFields);
+        record.perfFindings = addFindings(function.perfFindings);
+        record.file = intern(function.file);
+        record.flags = function.isTemplate ? static_cast<uint32_t>(FunctionTemplate) : 0u;
+        if (function.isSystem) record.flags |= FunctionSystem;
+        record.statements = function.statements;
+        return record;
+    }
+
+    FunctionRecord method(const MethodInfo& method) {
+        FunctionRecord record = function(method);
+        if (method.isVirtual) record.flags |= FunctionVirtual;
+        if (method.isPureVirtual) record.flags |= FunctionPureVirtual;
+        if (method.isStatic) record.flags |= FunctionStatic;
+        if (method.isConst) record.flags |= FunctionConst;
+        if (method.isConstructor) record.flags |= FunctionConstructor;
+        if (method.isDestructor) record.flags |= FunctionDestructor;
+        if (method.isDeleted) record.flags |= FunctionDeleted;
+        if (method.isOverride) record.flags |= FunctionOverride;
+        if (method.isFinal) record.flags |= FunctionFinal;
+        record.access = static_cast<uint32_t>(method.access);
+        return record;
+    }
+
+    FieldRecord field(const FieldInfo& field) {
+        FieldRecord record{};
+        record.name = intern(field.name);
+        record.type = intern(field.type);
+        record.recordType = intern(field.recordType);
+        record.offset = field.offset;
+        record.size = field.size;
+        record.alignment = field.alignment;
+        if (field.isStatic) record.flags |= FieldStatic;
+        if (field.isIndirect) record.flags |= FieldIndirect;
+        if (field.isContainer) record.flags |= FieldContainer;
+        if (field.isBitField) record.flags |= FieldBitField;
+        if (field.sync == SyncKind::Atomic) record.flags |= FieldAtomic;
+        if (field.sync == SyncKind::Mutex) record.flags |= FieldMutex;
+        if (field.sync == SyncKind::Condition) record.flags |= FieldCondition;
+        record.access = static_cast<uint32_t>(field.access);
+        return record;
+    }
+
+    void addClass(const ClassInfo& classInfo) {
+        ClassRecord record{};
+        record.name = intern(classInfo.name);
+        record.qualifiedName = intern(classInfo.qualifiedName);
+        record.templateParameters = addList(classInfo.templateParameters);
+        record.baseClasses = addList(classInfo.baseClasses);
+        record.methods = {methods.size(), classInfo.methods.size()};
+        for (const auto& method : classInfo.methods) {
+            methods.push_back(this->method(method));
+        }
+        record.fields = {fields.size(), classInfo.fields.size()};
+        for (const auto& field : classInfo.fields) {
+            fields.push_back(this->field(field));
+        }
+        record.virtualBases = {fields.size(), classInfo.virtualBases.size()};
+        for (const auto& base : classInfo.virtualBases) {
+            FieldRecord baseRecord{};
+            baseRecord.name = intern(base.name);
+            baseRecord.offset = base.offset;
+            baseRecord.size = base.size;
+            baseRecord.alignment = base.alignment;
+            fields.push_back(baseRecord);
+        }
+        record.size = classInfo.size;
+        record.alignment = classInfo.alignment;
+        record.file = intern(classInfo.file);
+        record.perfFindings = addFindings(classInfo.perfFindings);
+        record.fieldsStart = classInfo.fieldsStart;
+        if (classInfo.isAbstract) record.flags |= ClassAbstract;
+        if (classInfo.isTemplate) record.flags |= ClassTemplate;
+        if (classInfo.isFinal) record.flags |= ClassFinal;
+        if (classInfo.hasLayout) record.flags |= ClassHasLayout;
+        if (classInfo.isSystem) record.flags |= ClassSystem;
+        classes.push_back(record);
+    }
+
+    void addRelationship(const RelationshipInfo& relationship) {
+        RelationshipRecord record{};
+        record.fromClass = intern(relationship.fromClass);
+        record.toClass = intern(relationship.toClass);
+        record.label = intern(relationship.label);
+        record.templateArguments = addList(relationship.templateArguments);
+        record.type = static_cast<uint32_t>(relationship.type);
+        record.isBidirectional = relationship.isBidirectional ? 1 : 0;
+        relationships.push_back(record);
+    }
+
+    std::string strings;
+    std::vector<StringRef> stringLists;
+    std::vector<ClassRecord> classes;
+    std::vector<FunctionRecord> methods;
+    std::vector<FieldRecord> fields;
+    std::vector<FunctionRecord> functions;
+    std::vector<RelationshipRecord> relationships;
+    std::vector<FindingRecord> findings;
+
+private:
+    std::unordered_map<std::string, uint64_t> stringOffsets_;
+};
+
+// Append a section at the next aligned offset
+template <typename Record>
+Section writeSection(std::ofstream& out, uint64_t& position, const Record* data, uint64_t count,
+                     uint64_t bytes) {
+    uint64_t offset = alignUp(position);
+    static const char zeros[kSectionAlignment] = {};
+    out.write(zeros, static_cast<std::streamsize>(offset - position));
+    out.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+    position = offset + bytes;
+    return {offset, count};
+}
+
+template <typename Record>
+Section writeSection(std::ofstream& out, uint64_t& position, const std::vector<Record>& records) {
+    return writeSection(out, position, records.data(), records.size(), records.size() * sizeof(Record));
+}
+
+// True if count records of recordSize fit at offset inside the file
+bool sectionFits(const Section& section, uint64_t recordSize, uint64_t fileSize) {
+    if (section.offset % kSectionAlignment != 0 || section.offset > fileSize) {
+        return false;
+    }
+    return section.count <= (fileSize - section.offset) / recordSize;
+}
+
+// Enum values are checked against the last enumerator before the cast, so
+// a corrupt or newer file cannot produce values the switches don't handle
+constexpr uint32_t kLastAccess = static_cast<uint32_t>(AccessSpecifier::Private);
+constexpr uint32_t kLastRelationshipType = static_cast<uint32_t>(RelationshipType::Dependency);
+constexpr uint32_t kLastPerfIssue = static_cast<uint32_t>(PerfIssue::StdFunctionParameter);
+
+} // namespace
+
+ModelFile::ModelFile() = default;
+
+ModelFile::~ModelFile() {
+    close();
+}
+
+bool ModelFile::save(const std::string& path,
+                     const std::vector<ClassInfo>& classes,
+                     const std::vector<FunctionInfo>& functions,
+                     const std::vector<RelationshipInfo>& relationships) {
+    ModelBuilder builder;
+    for (const auto& classInfo : classes) {
+        builder.addClass(classInfo);
+    }
+    for (const auto& function : functions) {
+        builder.functions.push_back(builder.function(function));
+    }
+    for (const auto& relationship : relationships) {
+        builder.addRelationship(relationship);
+    }
+
+    // Readers may have the old file mapped, and a write that fails halfway
+    // must not leave a truncated model behind
+    std::string temp = path + "." + std::to_string(::getpid()) + ".tmp";
+    std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        std::cerr << "Error: Cannot write model file " << path << std::endl;
+        return false;
+    }
+
+    // The header is rewritten once the section offsets are known
+    Header header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.byteOrderMark = kByteOrderMark;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    uint64_t position = sizeof(header);
+    header.strings = writeSection(out, position, builder.strings.data(),
+                                  builder.strings.size(), builder.strings.size());
+    header.stringLists = writeSection(out, position, builder.stringLists);
+    header.classes = writeSection(out, position, builder.classes);
+    header.methods = writeSection(out, position, builder.methods);
+    header.fields = writeSection(out, position, builder.fields);
+    header.functions = writeSection(out, position, builder.functions);
+    header.relationships = writeSection(out, position, builder.relationships);
+    header.findings = writeSection(out, position, builder.findings);
+    header.fileSize = position;
+
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.close();
+    std::error_code error;
+    if (!out.good()) {
+        std::cerr << "Error: Failed writing model file " << path << std::endl;
+        std::filesystem::remove(temp, error);
+        return false;
+    }
+    std::filesystem::rename(temp, path, error);
+    if (error) {
+        std::cerr << "Error: Cannot replace model file " << path << ": " << error.message() << std::endl;
+        std::filesystem::remove(temp, error);
+        return false;
+    }
+    return true;
+}
+
+bool ModelFile::open(const std::string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Error: Cannot open model file " << path << std::endl;
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(Header)) {
+        std::cerr << "Error: Not a model file: " << path << std::endl;
+        ::close(fd);
+        return false;
+    }
+
+    // Read-only shared mapping: concurrent jobs share the page cache
+    mappingSize_ = static_cast<size_t>(info.st_size);
+    mapping_ = mmap(nullptr, mappingSize_, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping_ == MAP_FAILED) {
+        mapping_ = nullptr;
+        std::cerr << "Error: Cannot map model file " << path << std::endl;
+        return false;
+    }
+
+    const auto* header = static_cast<const Header*>(mapping_);
+    const char* base = static_cast<const char*>(mapping_);
+    if (std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0) {
+        std::cerr << "Error: Not a model file: " << path << std::endl;
+        close();
+        return false;
+    }
+    if (header->byteOrderMark != kByteOrderMark || header->version != kVersion) {
+        std::cerr << "Error: Model file " << path << " was written by an incompatible version" << std::endl;
+        close();
+        return false;
+    }
+    if (header->fileSize != mappingSize_ ||
+        !sectionFits(header->strings, 1, mappingSize_) ||
+        !sectionFits(header->stringLists, sizeof(StringRef), mappingSize_) ||
+        !sectionFits(header->classes, sizeof(ClassRecord), mappingSize_) ||
+        !sectionFits(header->methods, sizeof(FunctionRecord), mappingSize_) ||
+        !sectionFits(header->fields, sizeof(FieldRecord), mappingSize_) ||
+        !sectionFits(header->functions, sizeof(FunctionRecord), mappingSize_) ||
+        !sectionFits(header->relationships, sizeof(RelationshipRecord), mappingSize_) ||
+        !sectionFits(header->findings, sizeof(FindingRecord), mappingSize_)) {
+        std::cerr << "Error: Model file " << path << " is truncated or corrupt" << std::endl;
+        close();
+        return false;
+    }
+
+    header_ = header;
+    strings_ = base + header->strings.offset;
+    stringLists_ = reinterpret_cast<const StringRef*>(base + header->stringLists.offset);
+    classes_ = reinterpret_cast<const ClassRecord*>(base + header->classes.offset);
+    methods_ = reinterpret_cast<const FunctionRecord*>(base + header->methods.offset);
+    fields_ = reinterpret_cast<const FieldRecord*>(base + header->fields.offset);
+    functions_ = reinterpret_cast<const FunctionRecord*>(base + header->functions.offset);
+    relationships_ = reinterpret_cast<const RelationshipRecord*>(base + header->relationships.offset);
+    findings_ = reinterpret_cast<const FindingRecord*>(base + header->findings.offset);
+    return true;
+}
+
+void ModelFile::close() {
+    if (mapping_) {
+        munmap(mapping_, mappingSize_);
+    }
+    mapping_ = nullptr;
+    mappingSize_ = 0;
+    header_ = nullptr;
+    strings_ = nullptr;
+    stringLists_ = nullptr;
+    classes_ = nullptr;
+    methods_ = nullptr;
+    fields_ = nullptr;
+    functions_ = nullptr;
+    relationships_ = nullptr;
+    findings_ = nullptr;
+}
+
+std::string_view ModelFile::str(const StringRef& ref) const {
+    uint64_t size = header_ ? header_->strings.count : 0;
+    if (ref.offset > size || ref.length > size - ref.offset) {
+        return {};
+    }
+    return std::string_view(strings_ + ref.offset, ref.length);
+}
+
+std::string_view ModelFile::listItem(const Range& range, size_t index) const {
+    if (!header_ || index >= range.count || !validRange(range, header_->stringLists.count)) {
+        return {};
+    }
+    return str(stringLists_[range.first + index]);
+}
+
+std::vector<std::string> ModelFile::list(const Range& range) const {
+    std::vector<std::string> items;
+    items.reserve(range.count);
+    for (uint64_t i = 0; i < range.count; ++i) {
+        items.emplace_back(str(stringLists_[range.first + i]));
+    }
+    return items;
+}
+
+bool ModelFile::findingList(const Range& range, std::vector<PerfFinding>& items) const {
+    items.reserve(range.count);
+    for (uint64_t i = 0; i < range.count; ++i) {
+        const FindingRecord& record = findings_[range.first + i];
+        if (record.issue > kLastPerfIssue) return false;
+        items.push_back({static_cast<PerfIssue>(record.issue), std::string(str(record.message)),
+                         static_cast<int>(record.line)});
+    }
+    return true;
+}
+
+bool ModelFile::validFunction(const FunctionRecord& record) const {
+    uint64_t lists = header_->stringLists.count;
+    return validRange(record.parameters, lists) && validRange(record.parameterRecordTypes, lists) &&
+           validRange(record.templateParameters, lists) && validRange(record.calledFunctions, lists) &&
+           validRange(record.writtenFields, lists) &&
+           validRange(record.perfFindings, header_->findings.count);
+}
+
+bool ModelFile::loadFunction(const FunctionRecord& record, FunctionInfo& function) const {
+    function.name = str(record.name);
+    function.qualifiedName = str(record.qualifiedName);
+    function.returnType = str(record.returnType);
+    function.returnRecordType = str(record.returnRecordType);
+    function.parameters = list(record.parameters);
+    function.parameterRecordTypes = list(record.parameterRecordTypes);
+    function.templateParameters = list(record.templateParameters);
+    function.calledFunctions = list(record.calledFunctions);
+    function.writtenFields = list(record.writtenFields);
+    function.file = str(record.file);
+    function.isTemplate = record.flags & FunctionTemplate;
+    function.isSystem = record.flags & FunctionSystem;
+    function.statements = record.statements;
+    return findingList(record.perfFindings, function.perfFindings);
+}
+
+bool ModelFile::load(std::vector<ClassInfo>& classes,
+                     std::vector<FunctionInfo>& functions,
+                     std::vector<RelationshipInfo>& relationships) const {
+    if (!header_) {
+        return false;
+    }
+    uint64_t lists = header_->stringLists.count;
+
+    classes.reserve(classes.size() + classCount());
+    for (size_t id = 0; id < classCount(); ++id) {
+        const ClassRecord& record = classes_[id];
+        if (!validRange(record.templateParameters, lists) || !validRange(record.baseClasses, lists) ||
+            !validRange(record.methods, header_->methods.count) ||
+            !validRange(record.fields, header_->fields.count) ||
+            !validRange(record.virtualBases, header_->fields.count) ||
+            !validRange(record.perfFindings, header_->findings.count)) {
+            return false;
+        }
+
+        ClassInfo classInfo;
+        classInfo.name = str(record.name);
+        classInfo.qualifiedName = str(record.qualifiedName);
+        classInfo.isAbstract = record.flags & ClassAbstract;
+        classInfo.isTemplate = record.flags & ClassTemplate;
+        classInfo.isFinal = record.flags & ClassFinal;
+        classInfo.hasLayout = record.flags & ClassHasLayout;
+        classInfo.isSystem = record.flags & ClassSystem;
+        classInfo.templateParameters = list(record.templateParameters);
+        classInfo.baseClasses = list(record.baseClasses);
+        classInfo.size = record.size;
+        classInfo.alignment = record.alignment;
+        classInfo.fieldsStart = record.fieldsStart;
+        classInfo.file = str(record.file);
+        if (!findingList(record.perfFindings, classInfo.perfFindings)) return false;
+
+        classInfo.methods.resize(record.methods.count);
+        for (uint64_t i = 0; i < record.methods.count; ++i) {
+            const FunctionRecord& methodRecord = methods_[record.methods.first + i];
+            if (!validFunction(methodRecord) || methodRecord.access > kLastAccess) return false;
+            MethodInfo& method = classInfo.methods[i];
+            if (!loadFunction(methodRecord, method)) return false;
+            method.access = static_cast<AccessSpecifier>(methodRecord.access);
+            method.isVirtual = methodRecord.flags & FunctionVirtual;
+            method.isPureVirtual = methodRecord.flags & FunctionPureVirtual;
+            method.isStatic = methodRecord.flags & FunctionStatic;
+            method.isConst = methodRecord.flags & FunctionConst;
+            method.isConstructor = methodRecord.flags & FunctionConstructor;
+            method.isDestructor = methodRecord.flags & FunctionDestructor;
+            method.isDeleted = methodRecord.flags & FunctionDeleted;
+            method.isOverride = methodRecord.flags & FunctionOverride;
+            method.isFinal = methodRecord.flags & FunctionFinal;
+        }
+
+        classInfo.fields.resize(record.fields.count);
+        for (uint64_t i = 0; i < record.fields.count; ++i) {
+            const FieldRecord& fieldRecord = fields_[record.fields.first + i];
+            if (fieldRecord.access > kLastAccess) return false;
+            FieldInfo& field = classInfo.fields[i];
+            field.name = str(fieldRecord.name);
+            field.type = str(fieldRecord.type);
+            field.recordType = str(fieldRecord.recordType);
+            field.access = static_cast<AccessSpecifier>(fieldRecord.access);
+            field.offset = fieldRecord.offset;
+            field.size = fieldRecord.size;
+            field.alignment = fieldRecord.alignment;
+            field.isStatic = fieldRecord.flags & FieldStatic;
+            field.isIndirect = fieldRecord.flags & FieldIndirect;
+            field.isContainer = fieldRecord.flags & FieldContainer;
+            field.isBitField = fieldRecord.flags & FieldBitField;
+            if (fieldRecord.flags & FieldAtomic) field.sync = SyncKind::Atomic;
+            if (fieldRecord.flags & FieldMutex) field.sync = SyncKind::Mutex;
+            if (fieldRecord.flags & FieldCondition) field.sync = SyncKind::Condition;
+        }
+
+        classInfo.virtualBases.resize(record.virtualBases.count);
+        for (uint64_t i = 0; i < record.virtualBases.count; ++i) {
+            const FieldRecord& baseRecord = fields_[record.virtualBases.first + i];
+            VirtualBaseInfo& base = classInfo.virtualBases[i];
+            base.name = str(baseRecord.name);
+            base.offset = baseRecord.offset;
+            base.size = baseRecord.size;
+            base.alignment = baseRecord.alignment;
+        }
+
+        classes.push_back(std::move(classInfo));
+    }
+
+    functions.reserve(functions.size() + functionCount());
+    for (size_t id = 0; id < functionCount(); ++id) {
+        if (!validFunction(functions_[id])) return false;
+        FunctionInfo function;
+        if (!loadFunction(functions_[id], function)) return false;
+        functions.push_back(std::move(function));
+    }
+
+    relationships.reserve(relationships.size() + relationshipCount());
+    for (size_t index = 0; index < relationshipCount(); ++index) {
+        const RelationshipRecord& record = relationships_[index];
+        if (!validRange(record.templateArguments, lists) || record.type > kLastRelationshipType) return false;
+        RelationshipInfo relationship;
+        relationship.fromClass = str(record.fromClass);
+        relationship.toClass = str(record.toClass);
+        relationship.label = str(record.label);
+        relationship.templateArguments = list(record.templateArguments);
+        relationship.type = static_cast<RelationshipType>(record.type);
+        relationship.isBidirectional = record.isBidirectional != 0;
+        relationships.push_back(std::move(relationship));
+    }
+
+    return true;
+}
+
+} // namespace cpp_diagram
@@ -0,0 +1,65 @@
+#include "model/model_merger.h"
+
+namespace cpp_diagram {
+
+namespace {
+
+// Overloads share a qualified name; the parameter list tells them apart
+std::string functionKey(const FunctionInfo& function) {
+    std::string key = function.qualifiedName + "(";
+    for (const auto& parameter : function.parameters) {
+        key += parameter + ",";
+    }
+    return key + ")";
+}
+
+std::string relationshipKey(const RelationshipInfo& relationship) {
+    std::string key = relationship.fromClass + '\x1f' + relationship.toClass + '\x1f' +
+                      std::to_string(static_cast<int>(relationship.type)) + '\x1f' + relationship.label;
+    for (const auto& argument : relationship.templateArguments) {
+        key += '\x1f' + argument;
+    }
+    return key;
+}
+
+} // namespace
+
+ModelMerger::ModelMerger() = default;
+ModelMerger::~ModelMerger() = default;
+
+void ModelMerger::add(std::vector<ClassInfo>&& classes,
+                      std::vector<FunctionInfo>&& functions,
+                      std::vector<RelationshipInfo>&& relationships) {
+    // Classes from shared headers are seen by every shard that includes them
+    for (auto& classInfo : classes) {
+        if (classNames_.insert(classInfo.qualifiedName).second) {
+            classes_.push_back(std::move(classInfo));
+        }
+    }
+
+    for (auto& function : functions) {
+        auto [it, inserted] = functionIds_.emplace(functionKey(function), functions_.size());
+        if (inserted) {
+            functions_.push_back(std::move(function));
+            continue;
+        }
+        auto& callees = functions_[it->second].calledFunctions;
+        auto [set, created] = calleeSets_.try_emplace(it->second);
+        if (created) {
+            set->second.insert(callees.begin(), callees.end());
+        }
+        for (auto& callee : function.calledFunctions) {
+            if (set->second.insert(callee).second) {
+                callees.push_back(std::move(callee));
+            }
+        }
+    }
+
+    for (auto& relationship : relationships) {
+        if (relationshipKeys_.insert(relationshipKey(relationship)).second) {
+            relationships_.push_back(std::move(relationship));
+        }
+    }
+}
+
+} // namespace cpp_diagram
@@ -1,13 +1,249 @@
 #include "parser/ast_parser.h"
 #include "parser/ast_types.h"
+#include "parser/preamble_cache.h"
+#include <clang/AST/RecordLayout.h>
+#include <clang/Lex/PPCallbacks.h>
+#include <clang/Lex/Preprocessor.h>
 #include <clang/Tooling/Tooling.h>
 #include <clang/Tooling/CommonOptionsParser.h>
 #include <llvm/Support/CommandLine.h>
+#include <llvm/Support/raw_ostream.h>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
 #include <iostream>
+#include <iterator>
+#include <set>
 
 namespace cpp_diagram {
 
-ASTParser::ASTParser() = default;
+namespace {
+
+// First block of each TU's arena; later blocks grow geometrically
+constexpr size_t kUnitArenaBytes = 256 * 1024;
+
+bool isSmartPointerTemplate(const std::string& name) {
+    static const std::set<std::string> smartPointers = {
+        "std::unique_ptr", "std::shared_ptr", "std::weak_ptr"
+    };
+    return smartPointers.count(name) > 0;
+}
+
+// Returns the index of the element type argument, or -1 if the template is
+// not a standard container
+int containerElementArgument(const std::string& name) {
+    static const std::set<std::string> sequences = {
+        "std::vector", "std::list", "std::forward_list", "std::deque",
+        "std::set", "std::multiset", "std::unordered_set", "std::unordered_multiset",
+        "std::array"
+    };
+    static const std::set<std::string> associative = {
+        "std::map", "std::multimap", "std::unordered_map", "std::unordered_multimap"
+    };
+    if (sequences.count(name)) return 0;
+    if (associative.count(name)) return 1;
+    return -1;
+}
+
+// How firmly a member holds its class: by value beats shared beats borrowed
+int holdStrength(RelationshipType type) {
+    switch (type) {
+        case RelationshipType::Composition: return 3;
+        case RelationshipType::Aggregation: return 2;
+        case RelationshipType::Association: return 1;
+        default: return 0;
+    }
+}
+
+// Synchronization primitive a record is, by name; user types named like a
+// mutex or spin lock count as one
+SyncKind syncKind(const std::string& name) {
+    static const std::set<std::string> atomics = {"std::atomic", "std::atomic_flag"};
+    static const std::set<std::string> conditions = {
+        "std::condition_variable", "std::condition_variable_any", "pthread_cond_t"
+    };
+    if (atomics.count(name)) return SyncKind::Atomic;
+    if (conditions.count(name)) return SyncKind::Condition;
+
+    std::string lower = name.substr(name.rfind(':') == std::string::npos ? 0 : name.rfind(':') + 1);
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return std::tolower(c); });
+    if (lower.find("mutex") != std::string::npos || lower.find("spinlock") != std::string::npos ||
+        lower == "pthread_rwlock_t") {
+        return SyncKind::Mutex;
+    }
+    return SyncKind::None;
+}
+
+// Line of a location, attributing macro expansions to where they are used
+int lineOf(const clang::SourceManager& sourceManager, clang::SourceLocation location) {
+    return location.isValid() ? static_cast<int>(sourceManager.getExpansionLineNumber(location)) : 0;
+}
+
+// Parameter name for messages; unnamed ones by position
+std::string parameterName(const clang::ParmVarDecl* param) {
+    std::string name = param->getNameAsString();
+    return name.empty() ? "#" + std::to_string(param->getFunctionScopeIndex() + 1) : name;
+}
+
+// Local variable a member call is made on, e.g. v in v.push_back(x)
+const clang::VarDecl* localObject(const clang::CXXMemberCallExpr* call) {
+    const clang::Expr* object = call->getImplicitObjectArgument();
+    const auto* ref = object ? llvm::dyn_cast<clang::DeclRefExpr>(object->IgnoreParenImpCasts()) : nullptr;
+    const auto* var = ref ? llvm::dyn_cast<clang::VarDecl>(ref->getDecl()) : nullptr;
+    return var && var->hasLocalStorage() && !llvm::isa<clang::ParmVarDecl>(var) ? var : nullptr;
+}
+
+// Approximate AST size: declarations plus statements in function bodies
+int64_t countAstNodes(const clang::Decl* root) {
+    int64_t nodes = 0;
+    std::vector<const clang::Decl*> decls = {root};
+    std::vector<const clang::Stmt*> stmts;
+
+    while (!decls.empty()) {
+        const clang::Decl* decl = decls.back();
+        decls.pop_back();
+        ++nodes;
+        if (const auto* function = llvm::dyn_cast<clang::FunctionDecl>(decl)) {
+            if (function->doesThisDeclarationHaveABody()) {
+                stmts.push_back(function->getBody());
+            }
+        }
+        if (const auto* context = llvm::dyn_cast<clang::DeclContext>(decl)) {
+            for (const auto* child : context->decls()) {
+                decls.push_back(child);
+            }
+        }
+    }
+
+    while (!stmts.empty()) {
+        const clang::Stmt* stmt = stmts.back();
+        stmts.pop_back();
+        if (!stmt) {
+            continue;
+        }
+        ++nodes;
+        for (const clang::Stmt* child : stmt->children()) {
+            stmts.push_back(child);
+        }
+    }
+
+    return nodes;
+}
+
+} // namespace
+
+// Tracks the stack of open files so each token and each #include can be
+// attributed to the file being lexed
+class ASTParser::IncludeRecorder : public clang::PPCallbacks {
+public:
+    IncludeRecorder(ASTParser& parser, clang::SourceManager& sourceManager)
+        : parser_(parser), sourceManager_(sourceManager) {}
+
+    void FileChanged(clang::SourceLocation loc, FileChangeReason reason,
+                     clang::SrcMgr::CharacteristicKind fileType,
+                     clang::FileID prevFID) override {
+        if (reason == EnterFile) {
+            OpenFile file;
+            file.path = sourceManager_.getFilename(loc).str();
+            file.isSystem = clang::SrcMgr::isSystem(fileType);
+            file.isMainFile = stack_.empty();
+            // Predefines and command-line buffers have names like <built-in>
+            file.isVirtual = file.path.empty() || file.path[0] == '<';
+            if (!file.isVirtual) {
+                recordInclude(file);
+            }
+            stack_.push_back(file);
+        } else if (reason == ExitFile && stack_.size() > 1) {
+            closeFile();
+        }
+    }
+
+    // A header skipped by its include guard or #pragma once is still
+    // included from the current file; its tokens were counted on entry
+    void FileSkipped(const clang::FileEntryRef& skippedFile, const clang::Token& filenameTok,
+                     clang::SrcMgr::CharacteristicKind fileType) override {
+        OpenFile file;
+        file.path = skippedFile.getName().str();
+        file.isSystem = clang::SrcMgr::isSystem(fileType);
+        if (!file.path.empty() && file.path[0] != '<') {
+            recordInclude(file);
+        }
+    }
+
+    void EndOfMainFile() override {
+        while (!stack_.empty()) {
+            closeFile();
+        }
+        seenInUnit_.clear();
+    }
+
+    void countToken() {
+        if (!stack_.empty()) {
+            ++stack_.back().tokens;
+        }
+    }
+
+private:
+    struct OpenFile {
+        std::string path;
+        bool isSystem = false;
+        bool isMainFile = false;
+        bool isVirtual = false;
+        int64_t tokens = 0;
+        int64_t nestedTokens = 0;
+    };
+
+    HeaderInfo& header(const OpenFile& file) {
+        auto it = parser_.headerIds_.find(file.path);
+        if (it == parser_.headerIds_.end()) {
+            it = parser_.headerIds_.emplace(file.path, parser_.headers_.size()).first;
+            parser_.headers_.emplace_back();
+            parser_.headers_.back().path = file.path;
+            parser_.headers_.back().isSystem = file.isSystem;
+        }
+        return parser_.headers_[it->second];
+    }
+
+    void recordInclude(const OpenFile& file) {
+        HeaderInfo& info = header(file);
+        info.isMainFile = info.isMainFile || file.isMainFile;
+        if (seenInUnit_.insert(file.path).second) {
+            ++info.translationUnits;
+        }
+
+        // Attribute the edge to the nearest real file on the stack, which
+        // does not hold the included file yet
+        for (auto it = stack_.rbegin(); it != stack_.rend(); ++it) {
+            if (it->isVirtual) continue;
+            if (std::find(info.includedBy.begin(), info.includedBy.end(), it->path) == info.includedBy.end()) {
+                info.includedBy.push_back(it->path);
+            }
+            break;
+        }
+    }
+
+    void closeFile() {
+        OpenFile file = stack_.back();
+        stack_.pop_back();
+        int64_t inclusive = file.tokens + file.nestedTokens;
+        if (!stack_.empty()) {
+            stack_.back().nestedTokens += inclusive;
+        }
+        if (!file.isVirtual) {
+            HeaderInfo& info = header(file);
+            info.tokens += file.tokens;
+            info.inclusiveTokens += inclusive;
+        }
+    }
+
+    ASTParser& parser_;
+    clang::SourceManager& sourceManager_;
+    std::vector<OpenFile> stack_;
+    std::set<std::string> seenInUnit_;
+};
+
+ASTParser::ASTParser() : preambleCache_(PreambleCache::defaultDirectory()) {}
 ASTParser::~ASTParser() = default;
 
 bool ASTParser::parseFile(const std::string& filename) {
@@ -17,21 +253,64 @@ bool ASTParser::parseFile(const std::string& filename) {
 
 bool ASTParser::parseFiles(const std::vector<std::string>& filenames) {
     try {
-        std::vector<const char*> args = {
-            "cpp_diagram_visualizer",
+        // Flags shared by every TU; ClangTool adds the tool name and the file
+        std::vector<std::string> args = {
             "-std=c++17",
             "-I/usr/include",
             "-I/usr/local/include"
         };
 
-        for (const auto& file : filenames) {
-            args.push_back(file.c_str());
-        }
-
         clang::tooling::FixedCompilationDatabase compilations(".", args);
         clang::tooling::ClangTool tool(compilations, filenames);
 
-        return tool.run(new clang::tooling::FrontendActionFactory<ASTFrontendAction>(*this));
+        TraceScope scope(tracer_, "parseFiles", "parse");
+        scope.setCounter("files", static_cast<int64_t>(filenames.size()));
+
+        // Each TU skips the include block all inputs start with and loads it
+        // precompiled instead of parsing the same headers again
+        PreambleCache preamble(preambleCache_);
+        bool usePreamble = !preambleCache_.empty() && !collectIncludes_ && preamble.scan(filenames) &&
+                           preamble.prepare(args, tracer_);
+        if (usePreamble) {
+            scope.setCounter("preamble directives", static_cast<int64_t>(preamble.directiveCount()));
+            tool.appendArgumentsAdjuster(
+                [&preamble](const clang::tooling::CommandLineArguments& commandLine, llvm::StringRef file) {
+                    size_t bytes = preamble.preambleBytes(file.str());
+                    if (bytes == 0) return commandLine;
+                    clang::tooling::CommandLineArguments adjusted = commandLine;
+                    adjusted.insert(adjusted.begin() + 1,
+                                    {"-include-pch", preamble.pchPath(), "-Xclang",
+                                     "-preamble-bytes=" + std::to_string(bytes) + ",1"});
+                    return adjusted;
+                });
+        }
+
+        parsedUnits_.clear();
+        ActionFactory factory(*this);
+        bool parsed = tool.run(&factory) == 0;
+
+        if (usePreamble && !parsed) {
+            // A TU that could not load the PCH (e.g. a header changed during
+            // the run) never reached the consumer; parse those from scratch
+            std::vector<std::string> missed;
+            bool clean = true;
+            for (const auto& file : filenames) {
+                std::error_code error;
+                std::string absolute = std::filesystem::absolute(file, error).lexically_normal().string();
+                auto unit = parsedUnits_.find(absolute);
+                if (unit == parsedUnits_.end()) {
+                    missed.push_back(file);
+                } else {
+                    clean = clean && unit->second;
+                }
+            }
+            if (!missed.empty()) {
+                clang::tooling::ClangTool retry(compilations, missed);
+                parsed = retry.run(&factory) == 0 && clean;
+            }
+        }
+        attachMoveFindings();
+        return parsed;
     } catch (const std::exception& e) {
         std::cerr << "Error parsing files: " << e.what() << std::endl;
         return false;
@@ -50,9 +329,126 @@ std::vector<RelationshipInfo> ASTParser::getRelationships() const {
     return relationships_;
 }
 
+void ASTParser::setTracer(Tracer* tracer) {
+    tracer_ = tracer;
+}
+
+void ASTParser::setCollectIncludes(bool collect) {
+    collectIncludes_ = collect;
+}
+
+std::vector<HeaderInfo> ASTParser::getHeaderInfo() const {
+    return headers_;
+}
+
+void ASTParser::setCollectTemplates(bool collect) {
+    collectTemplates_ = collect;
+}
+
+std::vector<TemplateInfo> ASTParser::getTemplateInfo() const {
+    return templates_;
+}
+
+void ASTParser::setCollectPerfLint(bool collect, int64_t copyThreshold) {
+    collectPerfLint_ = collect;
+    copyThreshold_ = copyThreshold;
+}
+
+void ASTParser::setPreambleCache(const std::string& directory) {
+    preambleCache_ = directory;
+}
+
+void ASTParser::attachMoveFindings() {
+    for (auto& classInfo : classes_) {
+        auto issue = moveIssues_.find(classInfo.qualifiedName);
+        auto holder = vectorElements_.find(classInfo.qualifiedName);
+        if (issue == moveIssues_.end() || holder == vectorElements_.end() ||
+            std::any_of(classInfo.perfFindings.begin(), classInfo.perfFindings.end(),
+                        [](const PerfFinding& finding) { return finding.issue == PerfIssue::ThrowingMove; })) {
+            continue;
+        }
+        classInfo.perfFindings.push_back({PerfIssue::ThrowingMove,
+                                          issue->second.first + "; " + holder->second +
+                                              " copies every element when it grows",
+                                          issue->second.second});
+    }
+}
+
 void ASTParser::ASTConsumer::HandleTranslationUnit(clang::ASTContext& context) {
-    ASTVisitor visitor(parser_);
+    // Clang has finished parsing the TU by the time the consumer is called
+    if (parser_.tracer_ && parser_.frontendOpen_) {
+        parser_.tracer_->end(parser_.frontendEvent_);
+        parser_.frontendOpen_ = false;
+    }
+
+    clang::SourceManager& sourceManager = context.getSourceManager();
+    std::error_code error;
+    std::string mainFile =
+        sourceManager.getFilename(sourceManager.getLocForStartOfFile(sourceManager.getMainFileID())).str();
+    parser_.parsedUnits_[std::filesystem::absolute(mainFile, error).lexically_normal().string()] =
+        !context.getDiagnostics().hasErrorOccurred();
+
+    TraceScope scope(parser_.tracer_, "ASTVisitor", "extract");
+
+    // Everything the visitor caches lives until the end of this TU only
+    std::pmr::monotonic_buffer_resource arena(kUnitArenaBytes);
+    ASTVisitor visitor(parser_, &arena);
     visitor.TraverseDecl(context.getTranslationUnitDecl());
+
+    scope.setCounter("classes", static_cast<int64_t>(visitor.classCount()));
+    scope.setCounter("functions", static_cast<int64_t>(visitor.functionCount()));
+    visitor.commit();
+}
+
+ASTParser::ASTVisitor::ASTVisitor(ASTParser& parser, std::pmr::memory_resource* arena)
+    : parser_(parser), arena_(arena),
+      typeSpellings_(arena), qualifiedNames_(arena), resolvedTypes_(arena), fileNames_(arena) {}
+
+void ASTParser::ASTVisitor::commit() {
+    parser_.classes_.reserve(parser_.classes_.size() + classes_.size());
+    std::move(classes_.begin(), classes_.end(), std::back_inserter(parser_.classes_));
+    parser_.functions_.reserve(parser_.functions_.size() + functions_.size());
+    std::move(functions_.begin(), functions_.end(), std::back_inserter(parser_.functions_));
+    parser_.relationships_.reserve(parser_.relationships_.size() + relationships_.size());
+    std::move(relationships_.begin(), relationships_.end(), std::back_inserter(parser_.relationships_));
+    classes_.clear();
+    functions_.clear();
+    relationships_.clear();
+}
+
+std::string_view ASTParser::ASTVisitor::intern(const std::string& text) {
+    char* bytes = static_cast<char*>(arena_->allocate(text.size() + 1, 1));
+    std::memcpy(bytes, text.c_str(), text.size() + 1);
+    return std::string_view(bytes, text.size());
+}
+
+std::string_view ASTParser::ASTVisitor::spell(clang::QualType type) {
+    // The opaque pointer keeps sugar and qualifiers, so equal keys spell alike
+    auto it = typeSpellings_.find(type.getAsOpaquePtr());
+    if (it == typeSpellings_.end()) {
+        it = typeSpellings_.emplace(type.getAsOpaquePtr(), intern(type.getAsString())).first;
+    }
+    return it->second;
+}
+
+std::string_view ASTParser::ASTVisitor::qualifiedName(const clang::NamedDecl* decl) {
+    auto it = qualifiedNames_.find(decl);
+    if (it == qualifiedNames_.end()) {
+        it = qualifiedNames_.emplace(decl, intern(decl->getQualifiedNameAsString())).first;
+    }
+    return it->second;
+}
+
+std::string_view ASTParser::ASTVisitor::fileName(const clang::Decl* decl) {
+    // Declarations written by a macro belong to the file that expands it
+    const clang::SourceManager& sourceManager = decl->getASTContext().getSourceManager();
+    clang::SourceLocation location = sourceManager.getExpansionLoc(decl->getLocation());
+    unsigned fileId = sourceManager.getFileID(location).getHashValue();
+    auto it = fileNames_.find(fileId);
+    if (it == fileNames_.end()) {
+        it = fileNames_.emplace(fileId, intern(sourceManager.getFilename(location).str())).first;
+    }
+    return it->second;
 }
 
 bool ASTParser::ASTVisitor::VisitCXXRecordDecl(clang::CXXRecordDecl* decl) {
@@ -60,11 +456,19 @@ bool ASTParser::ASTVisitor::VisitCXXRecordDecl(clang::CXXRecordDecl* decl) {
         return true;
     }
 
-    ClassInfo classInfo;
+    classes_.emplace_back();
+    ClassInfo& classInfo = classes_.back();
     classInfo.name = decl->getNameAsString();
-    classInfo.qualifiedName = decl->getQualifiedNameAsString();
+    classInfo.qualifiedName = qualifiedName(decl);
     classInfo.isAbstract = decl->isAbstract();
     classInfo.isTemplate = decl->isTemplated();
+    classInfo.isFinal = decl->hasAttr<clang::FinalAttr>();
+    classInfo.file = fileName(decl);
+    classInfo.isSystem = decl->getASTContext().getSourceManager().isInSystemHeader(decl->getLocation());
+    bool lint = parser_.collectPerfLint_ && !classInfo.isSystem;
+    if (lint) {
+        lintMoveConstructor(decl, classInfo);
+    }
 
     // Get template parameters if it's a template
     if (classInfo.isTemplate) {
@@ -78,27 +482,52 @@ bool ASTParser::ASTVisitor::VisitCXXRecordDecl(clang::CXXRecordDecl* decl) {
     // Get base classes
     for (const auto& base : decl->bases()) {
         if (auto* baseType = base.getType()->getAs<clang::RecordType>()) {
-            classInfo.baseClasses.push_back(baseType->getDecl()->getQualifiedNameAsString());
-            
+            classInfo.baseClasses.emplace_back(qualifiedName(baseType->getDecl()));
+
             // Add inheritance relationship
-            RelationshipInfo relationship;
+            relationships_.emplace_back();
+            RelationshipInfo& relationship = relationships_.back();
             relationship.fromClass = classInfo.qualifiedName;
-            relationship.toClass = baseType->getDecl()->getQualifiedNameAsString();
+            relationship.toClass = classInfo.baseClasses.back();
             relationship.type = RelationshipType::Inheritance;
             relationship.isBidirectional = false;
-            parser_.relationships_.push_back(relationship);
+
+            // Record class-typed template arguments, e.g. Derived in Base<Derived>
+            if (auto* spec = llvm::dyn_cast<clang::ClassTemplateSpecializationDecl>(baseType->getDecl())) {
+                for (const auto& arg : spec->getTemplateArgs().asArray()) {
+                    if (arg.getKind() != clang::TemplateArgument::Type) continue;
+                    if (auto* argDecl = arg.getAsType()->getAsCXXRecordDecl()) {
+                        relationship.templateArguments.emplace_back(qualifiedName(argDecl));
+                    }
+                }
+            }
         }
     }
 
     // Get methods
     for (const auto* method : decl->methods()) {
-        MethodInfo methodInfo;
+        // Skip special members the compiler declared on its own
+        if (method->isImplicit()) {
+            continue;
+        }
+
+        classInfo.methods.emplace_back();
+        MethodInfo& methodInfo = classInfo.methods.back();
         methodInfo.name = method->getNameAsString();
-        methodInfo.returnType = method->getReturnType().getAsString();
+        methodInfo.qualifiedName = qualifiedName(method);
+        methodInfo.isSystem = classInfo.isSystem;
+        methodInfo.returnType = spell(method->getReturnType());
+        methodInfo.returnRecordType = resolveRecordType(method->getReturnType()).record;
         methodInfo.isVirtual = method->isVirtual();
         methodInfo.isPureVirtual = method->isPureVirtual();
         methodInfo.isStatic = method->isStatic();
         methodInfo.isConst = method->isConst();
+        methodInfo.isConstructor = llvm::isa<clang::CXXConstructorDecl>(method);
+        methodInfo.isDestructor = llvm::isa<clang::CXXDestructorDecl>(method);
+        methodInfo.isDeleted = method->isDeleted();
+        methodInfo.isOverride = method->size_overridden_methods() > 0;
+        methodInfo.isFinal = method->hasAttr<clang::FinalAttr>();
+        methodInfo.file = classInfo.file;
 
         // Get access specifier
         if (method->getAccess() == clang::AS_public) {
@@ -110,19 +539,104 @@ bool ASTParser::ASTVisitor::VisitCXXRecordDecl(clang::CXXRecordDecl* decl) {
         }
 
         // Get parameters
+        methodInfo.parameters.reserve(method->param_size());
+        methodInfo.parameterRecordTypes.reserve(method->param_size());
         for (const auto* param : method->parameters()) {
-            methodInfo.parameters.push_back(param->getType().getAsString());
+            methodInfo.parameters.emplace_back(spell(param->getType()));
+            methodInfo.parameterRecordTypes.emplace_back(resolveRecordType(param->getType()).record);
+        }
+    }
+
+    // Get the record layout; dependent types have none until instantiated
+    clang::ASTContext& context = decl->getASTContext();
+    const clang::ASTRecordLayout* layout = nullptr;
+    if (!decl->isDependentType() && !decl->isInvalidDecl()) {
+        layout = &context.getASTRecordLayout(decl);
+        classInfo.hasLayout = true;
+        classInfo.size = layout->getSize().getQuantity();
+        classInfo.alignment = layout->getAlignment().getQuantity();
+
+        // The vtable pointer and non-virtual bases come before the fields.
+        // A base ends at its data size, so fields placed in its tail padding
+        // are not counted as part of it; a base's own virtual bases are laid
+        // out elsewhere, so those bases end at their non-virtual size
+        if (layout->hasOwnVFPtr()) {
+            classInfo.fieldsStart = context.getTypeSizeInChars(context.VoidPtrTy).getQuantity();
+        }
+        for (const auto& base : decl->bases()) {
+            const auto* baseDecl = base.getType()->getAsCXXRecordDecl();
+            if (base.isVirtual() || !baseDecl) {
+                continue;
+            }
+            const clang::ASTRecordLayout& baseLayout = context.getASTRecordLayout(baseDecl);
+            clang::CharUnits baseSize = baseDecl->getNumVBases() > 0 ? baseLayout.getNonVirtualSize()
+                                                                     : baseLayout.getDataSize();
+            int64_t baseEnd = layout->getBaseClassOffset(baseDecl).getQuantity() + baseSize.getQuantity();
+            classInfo.fieldsStart = std::max(classInfo.fieldsStart, baseEnd);
         }
 
-        classInfo.methods.push_back(methodInfo);
+        // Virtual bases, direct or not, follow the fields
+        for (const auto& base : decl->vbases()) {
+            const auto* baseDecl = base.getType()->getAsCXXRecordDecl();
+            if (!baseDecl || baseDecl->isEmpty()) {
+                continue;
+            }
+            const clang::ASTRecordLayout& baseLayout = context.getASTRecordLayout(baseDecl);
+            VirtualBaseInfo virtualBase;
+            virtualBase.name = qualifiedName(baseDecl);
+            virtualBase.offset = layout->getVBaseClassOffset(baseDecl).getQuantity();
+            virtualBase.size = baseLayout.getNonVirtualSize().getQuantity();
+            virtualBase.alignment = baseLayout.getNonVirtualAlignment().getQuantity();
+            classInfo.virtualBases.push_back(std::move(virtualBase));
+        }
+        std::sort(classInfo.virtualBases.begin(), classInfo.virtualBases.end(),
+                  [](const VirtualBaseInfo& a, const VirtualBaseInfo& b) { return a.offset < b.offset; });
     }
 
-    // Get fields
+    // Get fields, remembering their resolved types for the relationships
+    std::vector<std::pair<const ResolvedType*, size_t>> members;
     for (const auto* field : decl->fields()) {
-        FieldInfo fieldInfo;
+        classInfo.fields.emplace_back();
+        FieldInfo& fieldInfo = classInfo.fields.back();
         fieldInfo.name = field->getNameAsString();
-        fieldInfo.type = field->getType().getAsString();
-        fieldInfo.isStatic = field->isStatic();
+        fieldInfo.type = spell(field->getType());
+        if (layout) {
+            uint64_t offsetBits = layout->getFieldOffset(field->getFieldIndex());
+            fieldInfo.offset = static_cast<int64_t>(offsetBits / 8);
+            if (field->isBitField()) {
+                fieldInfo.isBitField = true;
+                fieldInfo.size = (offsetBits % 8 + field->getBitWidthValue(context) + 7) / 8;
+                fieldInfo.alignment = 1;
+            } else {
+                fieldInfo.size = context.getTypeSizeInChars(field->getType()).getQuantity();
+                fieldInfo.alignment = context.getTypeAlignInChars(field->getType()).getQuantity();
+            }
+        }
+        const ResolvedType& resolved = resolveRecordType(field->getType());
+        fieldInfo.recordType = resolved.record;
+        fieldInfo.isIndirect = resolved.isIndirect;
+        fieldInfo.isContainer = resolved.isContainer;
+        members.emplace_back(&resolved, classInfo.fields.size() - 1);
+
+        // Atomics and locks held by value, arrays of them included; C
+        // types such as pthread_mutex_t are anonymous records behind a typedef
+        if (const auto* record = context.getBaseElementType(field->getType())->getAsCXXRecordDecl()) {
+            if (record->getIdentifier()) {
+                fieldInfo.sync = syncKind(std::string(qualifiedName(record)));
+            } else if (const auto* typedefName = record->getTypedefNameForAnonDecl()) {
+                fieldInfo.sync = syncKind(typedefName->getNameAsString());
+            }
+        }
+
+        // Elements held by value in a vector are relocated when it grows
+        if (lint && resolved.isContainer && !resolved.isIndirect && !resolved.record.empty()) {
+            const auto* container = llvm::dyn_cast_or_null<clang::ClassTemplateSpecializationDecl>(
+                field->getType()->getAsCXXRecordDecl());
+            if (container && qualifiedName(container) == "std::vector") {
+                parser_.vectorElements_.emplace(std::string(resolved.record),
+                                                classInfo.qualifiedName + "::" + fieldInfo.name);
+            }
+        }
 
         // Get access specifier
         if (field->getAccess() == clang::AS_public) {
@@ -132,24 +646,124 @@ bool ASTParser::ASTVisitor::VisitCXXRecordDecl(clang::CXXRecordDecl* decl) {
         } else {
             fieldInfo.access = AccessSpecifier::Private;
         }
+    }
+
+    // Get static data members, which clang models as variables rather than fields
+    for (const auto* member : decl->decls()) {
+        const auto* var = llvm::dyn_cast<clang::VarDecl>(member);
+        if (!var || !var->isStaticDataMember()) {
+            continue;
+        }
 
-        classInfo.fields.push_back(fieldInfo);
+        classInfo.fields.emplace_back();
+        FieldInfo& fieldInfo = classInfo.fields.back();
+        fieldInfo.name = var->getNameAsString();
+        fieldInfo.type = spell(var->getType());
+        fieldInfo.isStatic = true;
+        const ResolvedType& resolved = resolveRecordType(var->getType());
+        fieldInfo.recordType = resolved.record;
+        fieldInfo.isIndirect = resolved.isIndirect;
+        fieldInfo.isContainer = resolved.isContainer;
+        members.emplace_back(&resolved, classInfo.fields.size() - 1);
+
+        if (var->getAccess() == clang::AS_public) {
+            fieldInfo.access = AccessSpecifier::Public;
+        } else if (var->getAccess() == clang::AS_protected) {
+            fieldInfo.access = AccessSpecifier::Protected;
+        } else {
+            fieldInfo.access = AccessSpecifier::Private;
+        }
     }
 
-    parser_.classes_.push_back(classInfo);
+    addMemberRelationships(decl, classInfo, members);
+
     return true;
 }
 
+void ASTParser::ASTVisitor::addMemberRelationships(
+    const clang::CXXRecordDecl* decl, const ClassInfo& classInfo,
+    const std::vector<std::pair<const ResolvedType*, size_t>>& members) {
+    // Relationships inside the standard library would swamp every diagram
+    const clang::SourceManager& sourceManager = decl->getASTContext().getSourceManager();
+    if (sourceManager.isInSystemHeader(decl->getLocation())) {
+        return;
+    }
+
+    // One edge per target class, of the strongest kind any member implies
+    // and labelled with those members; a class has few enough targets that
+    // a scan beats a map
+    size_t first = relationships_.size();
+    auto findTarget = [this, first](std::string_view target) -> RelationshipInfo* {
+        for (size_t i = first; i < relationships_.size(); ++i) {
+            if (relationships_[i].toClass == target) return &relationships_[i];
+        }
+        return nullptr;
+    };
+
+    for (const auto& [resolved, fieldIndex] : members) {
+        if (resolved->record.empty() || resolved->isSystem) {
+            continue;
+        }
+        const FieldInfo& field = classInfo.fields[fieldIndex];
+
+        // Static members belong to no instance, so they never own anything
+        RelationshipType type = field.isStatic ? RelationshipType::Association : resolved->ownership;
+        if (RelationshipInfo* existing = findTarget(resolved->record)) {
+            if (holdStrength(type) > holdStrength(existing->type)) {
+                existing->type = type;
+            }
+            existing->label += ", " + field.name;
+            continue;
+        }
+
+        relationships_.emplace_back();
+        RelationshipInfo& relationship = relationships_.back();
+        relationship.fromClass = classInfo.qualifiedName;
+        relationship.toClass = resolved->record;
+        relationship.type = type;
+        relationship.label = field.name;
+    }
+
+    // Classes a method takes or returns without the class holding them
+    auto addDependency = [&](clang::QualType type) {
+        const ResolvedType& resolved = resolveRecordType(type);
+        if (resolved.record.empty() || resolved.isSystem || resolved.record == classInfo.qualifiedName ||
+            findTarget(resolved.record) ||
+            std::find(classInfo.baseClasses.begin(), classInfo.baseClasses.end(), resolved.record) !=
+                classInfo.baseClasses.end()) {
+            return;
+        }
+        relationships_.emplace_back();
+        RelationshipInfo& relationship = relationships_.back();
+        relationship.fromClass = classInfo.qualifiedName;
+        relationship.toClass = resolved.record;
+        relationship.type = RelationshipType::Dependency;
+    };
+    for (const auto* method : decl->methods()) {
+        if (method->isImplicit()) {
+            continue;
+        }
+        addDependency(method->getReturnType());
+        for (const auto* param : method->parameters()) {
+            addDependency(param->getType());
+        }
+    }
+}
+
 bool ASTParser::ASTVisitor::VisitFunctionDecl(clang::FunctionDecl* decl) {
     if (!decl->isThisDeclarationADefinition()) {
         return true;
     }
 
-    FunctionInfo functionInfo;
+    functions_.emplace_back();
+    FunctionInfo& functionInfo = functions_.back();
     functionInfo.name = decl->getNameAsString();
-    functionInfo.qualifiedName = decl->getQualifiedNameAsString();
-    functionInfo.returnType = decl->getReturnType().getAsString();
+    functionInfo.qualifiedName = qualifiedName(decl);
+    functionInfo.returnType = spell(decl->getReturnType());
+    functionInfo.returnRecordType = resolveRecordType(decl->getReturnType()).record;
     functionInfo.isTemplate = decl->isTemplated();
+    functionInfo.file = fileName(decl);
+    functionInfo.isSystem = decl->getASTContext().getSourceManager().isInSystemHeader(decl->getLocation());
 
     // Get template parameters if it's a template
     if (functionInfo.isTemplate) {
@@ -161,23 +775,382 @@ bool ASTParser::ASTVisitor::VisitFunctionDecl(clang::FunctionDecl* decl) {
     }
 
     // Get parameters
+    functionInfo.parameters.reserve(decl->param_size());
+    functionInfo.parameterRecordTypes.reserve(decl->param_size());
     for (const auto* param : decl->parameters()) {
-        functionInfo.parameters.push_back(param->getType().getAsString());
+        functionInfo.parameters.emplace_back(spell(param->getType()));
+        functionInfo.parameterRecordTypes.emplace_back(resolveRecordType(param->getType()).record);
     }
 
     // Get called functions
-    if (auto* body = decl->getBody()) {
-        for (auto it = body->child_begin(); it != body->child_end(); ++it) {
-            if (auto* callExpr = llvm::dyn_cast<clang::CallExpr>(*it)) {
-                if (auto* callee = callExpr->getDirectCallee()) {
-                    functionInfo.calledFunctions.push_back(callee->getQualifiedNameAsString());
+    bool userCode = !functionInfo.isSystem;
+    if (decl->getBody()) {
+        collectCalls(decl, functionInfo, userCode);
+    }
+    if (parser_.collectPerfLint_ && userCode) {
+        lintParameters(decl, functionInfo);
+    }
+
+    return true;
+}
+
+bool ASTParser::ASTVisitor::VisitClassTemplateDecl(clang::ClassTemplateDecl* decl) {
+    // Redeclarations share one specialization list; count it once
+    if (!parser_.collectTemplates_ || !decl->isThisDeclarationADefinition()) {
+        return true;
+    }
+
+    for (const auto* spec : decl->specializations()) {
+        if (clang::isTemplateInstantiation(spec->getTemplateSpecializationKind()) &&
+            spec->isCompleteDefinition()) {
+            recordInstantiation(decl, spec, true);
+        }
+    }
+    return true;
+}
+
+bool ASTParser::ASTVisitor::VisitFunctionTemplateDecl(clang::FunctionTemplateDecl* decl) {
+    if (!parser_.collectTemplates_ || decl != decl->getCanonicalDecl()) {
+        return true;
+    }
+
+    for (const auto* function : decl->specializations()) {
+        if (function->isTemplateInstantiation() && function->doesThisDeclarationHaveABody()) {
+            recordInstantiation(decl, function, false);
+        }
+    }
+    return true;
+}
+
+void ASTParser::ASTVisitor::recordInstantiation(const clang::NamedDecl* primary,
+                                                const clang::NamedDecl* instantiation,
+                                                bool isClassTemplate) {
+    std::string name = primary->getQualifiedNameAsString();
+    auto it = parser_.templateIds_.find(name);
+    if (it == parser_.templateIds_.end()) {
+        it = parser_.templateIds_.emplace(name, parser_.templates_.size()).first;
+        parser_.templates_.emplace_back();
+        parser_.templates_.back().name = name;
+        parser_.templates_.back().isClassTemplate = isClassTemplate;
+    }
+    TemplateInfo& info = parser_.templates_[it->second];
+
+    // Spell the instantiation with its arguments, e.g. Container<int>
+    std::string spelling;
+    llvm::raw_string_ostream stream(spelling);
+    instantiation->getNameForDiagnostic(stream, instantiation->getASTContext().getPrintingPolicy(), true);
+    stream.flush();
+
+    ++info.instantiations;
+    info.astNodes += countAstNodes(instantiation);
+    if (std::find(info.arguments.begin(), info.arguments.end(), spelling) == info.arguments.end()) {
+        info.arguments.push_back(spelling);
+    }
+}
+
+void ASTParser::ASTVisitor::collectCalls(const clang::FunctionDecl* decl, FunctionInfo& functionInfo,
+                                         bool userCode) {
+    // Walk the whole body, not just top-level statements, so calls nested in
+    // loops, conditions and arguments are found too. The work list is reused
+    // across functions.
+    bool lint = parser_.collectPerfLint_ && userCode;
+    auto& pending = pendingStmts_;
+    pending.clear();
+    pending.push_back({decl->getBody(), false});
+    grownInLoop_.clear();
+    reserved_.clear();
+    const clang::SourceManager& sourceManager = decl->getASTContext().getSourceManager();
+
+    while (!pending.empty()) {
+        auto [stmt, inLoop] = pending.back();
+        pending.pop_back();
+        if (!stmt) {
+            continue;
+        }
+        ++functionInfo.statements;
+        if (userCode) {
+            collectFieldWrite(stmt, functionInfo);
+        }
+        if (const auto* callExpr = llvm::dyn_cast<clang::CallExpr>(stmt)) {
+            if (const auto* callee = callExpr->getDirectCallee()) {
+                functionInfo.calledFunctions.emplace_back(qualifiedName(callee));
+                if (lint) {
+                    lintCall(callExpr, callee, inLoop, functionInfo);
                 }
             }
+        } else if (const auto* newExpr = llvm::dyn_cast<clang::CXXNewExpr>(stmt)) {
+            if (lint && inLoop) {
+                functionInfo.perfFindings.push_back(
+                    {PerfIssue::AllocationInLoop,
+                     "new " + std::string(spell(newExpr->getAllocatedType())) + " inside a loop",
+                     lineOf(sourceManager, newExpr->getBeginLoc())});
+            }
+        }
+
+        // Only the parts of a loop that run on every iteration are inside
+        // it; the init statement and the range of a range-for run once
+        bool isLoop = llvm::isa<clang::ForStmt>(stmt) || llvm::isa<clang::CXXForRangeStmt>(stmt) ||
+                      llvm::isa<clang::WhileStmt>(stmt) || llvm::isa<clang::DoStmt>(stmt);
+        const clang::Stmt* once[4] = {};
+        if (const auto* forStmt = llvm::dyn_cast<clang::ForStmt>(stmt)) {
+            once[0] = forStmt->getInit();
+        } else if (const auto* rangeFor = llvm::dyn_cast<clang::CXXForRangeStmt>(stmt)) {
+            once[0] = rangeFor->getInit();
+            once[1] = rangeFor->getRangeStmt();
+            once[2] = rangeFor->getBeginStmt();
+            once[3] = rangeFor->getEndStmt();
+        }
+        for (const clang::Stmt* child : stmt->children()) {
+            bool childInLoop = inLoop || (isLoop && child && std::find(std::begin(once), std::end(once), child) ==
+                                                                  std::end(once));
+            pending.push_back({child, childInLoop});
         }
     }
 
-    parser_.functions_.push_back(functionInfo);
-    return true;
+    // A container reserved anywhere in the function is assumed sized right
+    for (const auto& [var, line] : grownInLoop_) {
+        if (std::find(reserved_.begin(), reserved_.end(), var) != reserved_.end()) {
+            continue;
+        }
+        functionInfo.perfFindings.push_back(
+            {PerfIssue::GrowthWithoutReserve,
+             "'" + var->getNameAsString() + "' grows inside a loop without reserve()", line});
+        reserved_.push_back(var);  // report each container once
+    }
+}
+
+void ASTParser::ASTVisitor::collectFieldWrite(const clang::Stmt* stmt, FunctionInfo& functionInfo) {
+    const clang::Expr* target = nullptr;
+    if (const auto* binary = llvm::dyn_cast<clang::BinaryOperator>(stmt)) {
+        if (binary->isAssignmentOp()) target = binary->getLHS();
+    } else if (const auto* unary = llvm::dyn_cast<clang::UnaryOperator>(stmt)) {
+        if (unary->isIncrementDecrementOp()) target = unary->getSubExpr();
+    } else if (const auto* op = llvm::dyn_cast<clang::CXXOperatorCallExpr>(stmt)) {
+        // Overloaded =, += and ++ on class-typed members such as atomics
+        clang::OverloadedOperatorKind kind = op->getOperator();
+        if ((op->isAssignmentOp() || kind == clang::OO_PlusPlus || kind == clang::OO_MinusMinus) &&
+            op->getNumArgs() > 0) {
+            target = op->getArg(0);
+        }
+    } else if (const auto* call = llvm::dyn_cast<clang::CXXMemberCallExpr>(stmt)) {
+        // store(), fetch_add(), lock(), push_back() ... all write the member
+        const auto* method = call->getMethodDecl();
+        if (method && !method->isConst() && !method->isStatic()) target = call->getImplicitObjectArgument();
+    }
+
+    const auto* member = target ? llvm::dyn_cast<clang::MemberExpr>(target->IgnoreParenImpCasts()) : nullptr;
+    const auto* field = member ? llvm::dyn_cast<clang::FieldDecl>(member->getMemberDecl()) : nullptr;
+    if (field) {
+        functionInfo.writtenFields.emplace_back(qualifiedName(field));
+    }
+}
+
+void ASTParser::ASTVisitor::lintCall(const clang::CallExpr* call, const clang::FunctionDecl* callee,
+                                     bool inLoop, FunctionInfo& functionInfo) {
+    const clang::SourceManager& sourceManager = callee->getASTContext().getSourceManager();
+    std::string_view name = qualifiedName(callee);
+    if (inLoop && (name == "std::make_shared" || name == "std::make_unique" || name == "std::allocate_shared")) {
+        functionInfo.perfFindings.push_back(
+            {PerfIssue::AllocationInLoop,
+             std::string(name) + " of " + std::string(spell(call->getType())) + " inside a loop",
+             lineOf(sourceManager, call->getBeginLoc())});
+        return;
+    }
+
+    // Growth and reservations of local vectors and strings
+    const auto* memberCall = llvm::dyn_cast<clang::CXXMemberCallExpr>(call);
+    const auto* method = memberCall ? memberCall->getMethodDecl() : nullptr;
+    if (!method) {
+        return;
+    }
+    std::string_view owner = qualifiedName(method->getParent());
+    if (owner != "std::vector" && owner != "std::basic_string") {
+        return;
+    }
+    const clang::VarDecl* var = localObject(memberCall);
+    if (!var) {
+        return;
+    }
+    std::string methodName = method->getNameAsString();
+    if (methodName == "reserve") {
+        reserved_.push_back(var);
+    } else if (inLoop && (methodName == "push_back" || methodName == "emplace_back")) {
+        grownInLoop_.emplace_back(var, lineOf(sourceManager, call->getBeginLoc()));
+    }
+}
+
+void ASTParser::ASTVisitor::lintParameters(const clang::FunctionDecl* decl, FunctionInfo& functionInfo) {
+    clang::ASTContext& context = decl->getASTContext();
+    const clang::SourceManager& sourceManager = context.getSourceManager();
+
+    std::vector<const clang::ParmVarDecl*> copied;
+    for (const auto* param : decl->parameters()) {
+        clang::QualType type = param->getType();
+        if (type->isDependentType()) {
+            continue;
+        }
+        const clang::CXXRecordDecl* record = type.getNonReferenceType()->getAsCXXRecordDecl();
+        if (!record) {
+            continue;
+        }
+        if (qualifiedName(record) == "std::function") {
+            functionInfo.perfFindings.push_back(
+                {PerfIssue::StdFunctionParameter,
+                 "parameter '" + parameterName(param) + "' is " + std::string(spell(type)) +
+                     "; each call is indirect and capturing callables may allocate",
+                 lineOf(sourceManager, param->getLocation())});
+            continue;
+        }
+        if (type->isReferenceType() || !record->hasDefinition() || type.isTriviallyCopyableType(context) ||
+            context.getTypeSizeInChars(type).getQuantity() <= parser_.copyThreshold_) {
+            continue;
+        }
+        copied.push_back(param);
+    }
+    if (copied.empty()) {
+        return;
+    }
+
+    // A by-value parameter that is moved from is a sink, not a copy; look
+    // for std::move in the body and in constructor initializers
+    std::vector<const clang::Stmt*> pending = {decl->getBody()};
+    if (const auto* constructor = llvm::dyn_cast<clang::CXXConstructorDecl>(decl)) {
+        for (const auto* init : constructor->inits()) {
+            pending.push_back(init->getInit());
+        }
+    }
+    while (!pending.empty() && !copied.empty()) {
+        const clang::Stmt* stmt = pending.back();
+        pending.pop_back();
+        if (!stmt) {
+            continue;
+        }
+        const auto* call = llvm::dyn_cast<clang::CallExpr>(stmt);
+        const auto* callee = call ? call->getDirectCallee() : nullptr;
+        if (callee && call->getNumArgs() == 1 && qualifiedName(callee) == "std::move") {
+            if (const auto* ref = llvm::dyn_cast<clang::DeclRefExpr>(call->getArg(0)->IgnoreParenImpCasts())) {
+                copied.erase(std::remove(copied.begin(), copied.end(), ref->getDecl()), copied.end());
+            }
+        }
+        for (const clang::Stmt* child : stmt->children()) {
+            pending.push_back(child);
+        }
+    }
+
+    for (const auto* param : copied) {
+        clang::QualType type = param->getType();
+        functionInfo.perfFindings.push_back(
+            {PerfIssue::LargeByValue,
+             "parameter '" + parameterName(param) + "' copies " + std::string(spell(type)) + " (" +
+                 std::to_string(context.getTypeSizeInChars(type).getQuantity()) + " bytes) by value",
+             lineOf(sourceManager, param->getLocation())});
+    }
+}
+
+void ASTParser::ASTVisitor::lintMoveConstructor(const clang::CXXRecordDecl* decl, const ClassInfo& classInfo) {
+    if (decl->isDependentType() || decl->isTriviallyCopyable()) {
+        return;
+    }
+
+    // Defaulted and implicit move constructors are as noexcept as the
+    // members; telling that needs Sema, so only written ones are judged
+    std::string reason;
+    const clang::CXXConstructorDecl* move = nullptr;
+    for (const auto* constructor : decl->ctors()) {
+        if (constructor->isMoveConstructor() && !constructor->isImplicit()) {
+            move = constructor;
+            break;
+        }
+    }
+    if (move) {
+        const auto* prototype = move->getType()->getAs<clang::FunctionProtoType>();
+        if (move->isDeleted()) {
+            reason = "move constructor is deleted";
+        } else if (!move->isDefaulted() && prototype && !prototype->isNothrow()) {
+            reason = "move constructor is not noexcept";
+        }
+    } else if (decl->hasUserDeclaredCopyConstructor() || decl->hasUserDeclaredCopyAssignment() ||
+               decl->hasUserDeclaredDestructor()) {
+        reason = "user-declared copy or destructor suppresses the implicit move constructor";
+    }
+    if (reason.empty()) {
+        return;
+    }
+
+    const clang::SourceManager& sourceManager = decl->getASTContext().getSourceManager();
+    parser_.moveIssues_.emplace(classInfo.qualifiedName,
+                                std::make_pair(reason, lineOf(sourceManager, decl->getLocation())));
+}
+
+const ASTParser::ASTVisitor::ResolvedType& ASTParser::ASTVisitor::resolveRecordType(clang::QualType type) {
+    const void* key = type.getAsOpaquePtr();
+    auto cached = resolvedTypes_.find(key);
+    if (cached != resolvedTypes_.end()) {
+        return cached->second;
+    }
+
+    bool indirect = false;
+    bool container = false;
+    bool system = false;
+    std::string_view result;
+
+    // Values and unique_ptr own their object; anything else along the way
+    // weakens the hold to shared (aggregation) or borrowed (association)
+    RelationshipType ownership = RelationshipType::Composition;
+    auto weaken = [&ownership](RelationshipType hold) {
+        if (holdStrength(hold) < holdStrength(ownership)) {
+            ownership = hold;
+        }
+    };
+
+    // Peel pointers, references, arrays, smart pointers and containers until
+    // we reach the class the type is really about
+    for (int depth = 0; depth < 8 && !type.isNull(); ++depth) {
+        type = type.getCanonicalType();
+        if (type->isReferenceType() || type->isPointerType()) {
+            indirect = true;
+            weaken(RelationshipType::Association);
+            type = type->getPointeeType();
+            continue;
+        }
+        if (const auto* array = type->getAsArrayTypeUnsafe()) {
+            container = true;
+            type = array->getElementType();
+            continue;
+        }
+
+        const auto* record = type->getAsCXXRecordDecl();
+        if (!record) {
+            break;
+        }
+
+        if (const auto* spec = llvm::dyn_cast<clang::ClassTemplateSpecializationDecl>(record)) {
+            std::string templateName = spec->getSpecializedTemplate()->getQualifiedNameAsString();
+            const auto& args = spec->getTemplateArgs();
+            int argIndex = isSmartPointerTemplate(templateName) ? 0 : containerElementArgument(templateName);
+            if (argIndex >= 0 && static_cast<unsigned>(argIndex) < args.size() &&
+                args[argIndex].getKind() == clang::TemplateArgument::Type) {
+                if (isSmartPointerTemplate(templateName)) {
+                    indirect = true;
+                    if (templateName == "std::shared_ptr") {
+                        weaken(RelationshipType::Aggregation);
+                    } else if (templateName == "std::weak_ptr") {
+                        weaken(RelationshipType::Association);
+                    }
+                } else {
+                    container = true;
+                }
+                type = args[argIndex].getAsType();
+                continue;
+            }
+        }
+
+        result = qualifiedName(record);
+        system = record->getASTContext().getSourceManager().isInSystemHeader(record->getLocation());
+        break;
+    }
+
+    return resolvedTypes_.emplace(key, ResolvedType{result, indirect, container, system, ownership}).first->second;
 }
 
 std::unique_ptr<clang::ASTConsumer> ASTParser::ASTFrontendAction::CreateASTConsumer(
@@ -185,4 +1158,39 @@ std::unique_ptr<clang::ASTConsumer> ASTParser::ASTFrontendAction::CreateASTConsu
     return std::make_unique<ASTConsumer>(parser_);
 }
 
+std::unique_ptr<clang::FrontendAction> ASTParser::ActionFactory::create() {
+    return std::make_unique<ASTFrontendAction>(parser_);
+}
+
+bool ASTParser::ASTFrontendAction::BeginSourceFileAction(clang::CompilerInstance& compiler) {
+    if (parser_.tracer_) {
+        unitEvent_ = parser_.tracer_->begin(getCurrentFile().str(), "tu");
+        parser_.frontendEvent_ = parser_.tracer_->begin("clang frontend", "clang");
+        parser_.frontendOpen_ = true;
+    }
+
+    if (parser_.collectIncludes_) {
+        clang::Preprocessor& preprocessor = compiler.getPreprocessor();
+        auto recorder = std::make_unique<IncludeRecorder>(parser_, compiler.getSourceManager());
+        IncludeRecorder* tokenCounter = recorder.get();
+        preprocessor.addPPCallbacks(std::move(recorder));
+        preprocessor.setTokenWatcher([tokenCounter](const clang::Token&) {
+            tokenCounter->countToken();
+        });
+    }
+    return true;
+}
+
+void ASTParser::ASTFrontendAction::EndSourceFileAction() {
+    if (parser_.tracer_) {
+        // A TU that failed before reaching the consumer still closes its
+        // frontend event, so every begin in the trace has its end
+        if (parser_.frontendOpen_) {
+            parser_.tracer_->end(parser_.frontendEvent_);
+            parser_.frontendOpen_ = false;
+        }
+        parser_.tracer_->end(unitEvent_);
+    }
+}
+
 } // namespace cpp_diagram 
\ No newline at end of file
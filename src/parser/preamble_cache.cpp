@@ -0,0 +1,403 @@
+#include "parser/preamble_cache.h"
+#include <clang/Basic/Version.h>
+#include <clang/Frontend/FrontendActions.h>
+#include <clang/Tooling/CompilationDatabase.h>
+#include <clang/Tooling/Tooling.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+namespace cpp_diagram {
+
+namespace {
+
+constexpr uint64_t kFnvOffset = 1469598103934665603ull;
+constexpr uint64_t kFnvPrime = 1099511628211ull;
+
+// 64-bit FNV-1a over the parts that make a PCH incompatible: compiler,
+// flags and the include block itself
+uint64_t preambleHash(const std::vector<std::string>& parts) {
+    uint64_t hash = kFnvOffset;
+    for (const auto& part : parts) {
+        for (unsigned char c : part) {
+            hash ^= c;
+            hash *= kFnvPrime;
+        }
+        hash ^= 0xff;
+        hash *= kFnvPrime;
+    }
+    return hash;
+}
+
+// FNV-1a over the contents of the files, in order; false if one is unreadable
+bool contentsHash(const std::vector<std::string>& paths, uint64_t& hash) {
+    hash = kFnvOffset;
+    std::vector<char> buffer(1 << 16);
+    for (const auto& path : paths) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in.is_open()) return false;
+        while (in) {
+            in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            for (std::streamsize i = 0; i < in.gcount(); ++i) {
+                hash ^= static_cast<unsigned char>(buffer[i]);
+                hash *= kFnvPrime;
+            }
+        }
+        hash ^= 0xff;
+        hash *= kFnvPrime;
+    }
+    return true;
+}
+
+std::string hexString(uint64_t value) {
+    std::stringstream text;
+    text << std::hex << value;
+    return text.str();
+}
+
+std::string readText(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::stringstream contents;
+    if (in.is_open()) contents << in.rdbuf();
+    return contents.str();
+}
+
+std::string normalizedPath(const fs::path& path) {
+    std::error_code error;
+    fs::path absolute = fs::absolute(path, error);
+    return (error ? path : absolute).lexically_normal().string();
+}
+
+// Key of an "#include <...>" or "#include \"...\"" line, empty if the line
+// is anything else
+std::string includeKey(const std::string& line, const std::string& directory) {
+    size_t pos = 1;
+    while (pos < line.size() && (line[pos] == ' ' || line[pos] == '\t')) ++pos;
+    if (line.compare(pos, 7, "include") != 0) return "";
+    pos += 7;
+    while (pos < line.size() && (line[pos] == ' ' || line[pos] == '\t')) ++pos;
+    if (pos >= line.size() || (line[pos] != '<' && line[pos] != '"')) return "";
+
+    char close = line[pos] == '<' ? '>' : '"';
+    size_t end = line.find(close, pos + 1);
+    if (end == std::string::npos) return "";
+    std::string name = line.substr(pos + 1, end - pos - 1);
+
+    // Only a trailing line comment may follow
+    size_t rest = line.find_first_not_of(" \t\r", end + 1);
+    if (rest != std::string::npos && line.compare(rest, 2, "//") != 0) return "";
+
+    if (close == '>') {
+        return "<" + name + ">";
+    }
+    std::error_code error;
+    fs::path local = fs::path(directory) / name;
+    if (fs::exists(local, error)) {
+        return "\"" + normalizedPath(local) + "\"";
+    }
+    return "\"" + name + "\"";
+}
+
+// Prerequisites of a Makefile dependency file as written by -MD
+std::vector<std::string> dependencyPaths(const std::string& contents) {
+    std::vector<std::string> paths;
+    size_t colon = contents.find(": ");
+    if (colon == std::string::npos) return paths;
+
+    std::string current;
+    for (size_t i = colon + 2; i < contents.size(); ++i) {
+        char c = contents[i];
+        if (c == '\\' && i + 1 < contents.size() && contents[i + 1] == ' ') {
+            current += ' ';
+            ++i;
+        } else if (c == '\\' && i + 1 < contents.size() && contents[i + 1] == '\n') {
+            ++i;
+        } else if (c == '$' && i + 1 < contents.size() && contents[i + 1] == '$') {
+            current += '$';
+            ++i;
+        } else if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+            if (!current.empty()) paths.push_back(std::move(current));
+            current.clear();
+        } else {
+            current += c;
+        }
+    }
+    if (!current.empty()) paths.push_back(std::move(current));
+    return paths;
+}
+
+} // namespace
+
+PreambleCache::PreambleCache(std::string directory) : directory_(std::move(directory)) {}
+PreambleCache::~PreambleCache() = default;
+
+std::string PreambleCache::defaultDirectory() {
+    const char* cacheHome = std::getenv("XDG_CACHE_HOME");
+    if (cacheHome && *cacheHome) {
+        return (fs::path(cacheHome) / "cpp_diagram" / "preamble").string();
+    }
+    const char* home = std::getenv("HOME");
+    if (home && *home) {
+        return (fs::path(home) / ".cache" / "cpp_diagram" / "preamble").string();
+    }
+    return "";
+}
+
+std::vector<IncludeDirective> PreambleCache::scanDirectives(const std::string& contents,
+                                                           const std::string& directory) {
+    std::vector<IncludeDirective> directives;
+    bool inComment = false;
+    size_t start = 0;
+    while (start < contents.size()) {
+        size_t newline = contents.find('\n', start);
+        size_t end = newline == std::string::npos ? contents.size() : newline + 1;
+        std::string line = contents.substr(start, end - start);
+        start = end;
+
+        if (inComment) {
+            size_t close = line.find("*/");
+            if (close == std::string::npos) continue;
+            inComment = false;
+            line = line.substr(close + 2);
+        }
+
+        size_t first = line.find_first_not_of(" \t\r\n");
+        if (first == std::string::npos || line.compare(first, 2, "//") == 0) continue;
+        line = line.substr(first);
+        while (!line.empty() && (line.back() == '\n' || line.back() == '\r')) line.pop_back();
+
+        if (line.compare(0, 2, "/*") == 0) {
+            size_t close = line.find("*/", 2);
+            if (close == std::string::npos) {
+                inComment = true;
+                continue;
+            }
+            if (line.find_first_not_of(" \t", close + 2) == std::string::npos) continue;
+            break;
+        }
+
+        // A continued line could be anything once joined
+        if (line[0] != '#' || line.back() == '\\') break;
+        std::string key = includeKey(line, directory);
+        if (key.empty()) break;
+        directives.push_back({key, end});
+    }
+    return directives;
+}
+
+bool PreambleCache::scan(const std::vector<std::string>& files) {
+    shared_.clear();
+    bytes_.clear();
+
+    std::vector<std::pair<std::string, std::vector<IncludeDirective>>> scanned;
+    size_t common = static_cast<size_t>(-1);
+    for (const auto& file : files) {
+        std::ifstream in(file, std::ios::binary);
+        if (!in.is_open()) return false;
+        std::stringstream contents;
+        contents << in.rdbuf();
+
+        std::string absolute = normalizedPath(file);
+        std::vector<IncludeDirective> directives =
+            scanDirectives(contents.str(), fs::path(absolute).parent_path().string());
+
+        // Shorten the shared block to where this file departs from the first
+        size_t match = 0;
+        const std::vector<IncludeDirective>& reference = scanned.empty() ? directives : scanned.front().second;
+        size_t limit = std::min({common, directives.size(), reference.size()});
+        while (match < limit && directives[match].key == reference[match].key) ++match;
+        common = match;
+        scanned.emplace_back(std::move(absolute), std::move(directives));
+        if (common == 0) return false;
+    }
+    if (scanned.empty()) return false;
+
+    for (size_t i = 0; i < common; ++i) {
+        shared_.push_back(scanned.front().second[i].key);
+    }
+    for (const auto& [file, directives] : scanned) {
+        bytes_[file] = directives[common - 1].end;
+    }
+    return true;
+}
+
+bool PreambleCache::isFresh(const std::string& dependencyFile, const std::string& hashFile) const {
+    std::error_code error;
+    fs::file_time_type built = fs::last_write_time(pchPath_, error);
+    if (error) return false;
+
+    std::vector<std::string> dependencies = dependencyPaths(readText(dependencyFile));
+    if (dependencies.empty()) return false;
+    for (const auto& dependency : dependencies) {
+        fs::file_time_type modified = fs::last_write_time(dependency, error);
+        if (error || modified > built) return false;
+    }
+
+    // Checkouts and copies can change a header without a newer mtime
+    uint64_t hash = 0;
+    return contentsHash(dependencies, hash) && readText(hashFile) == hexString(hash);
+}
+
+void PreambleCache::prune(const std::string& keep) const {
+    // Files of one PCH share the hash they are named after; the newest of
+    // them tells when it was last built or reused
+    struct Entry {
+        fs::file_time_type lastUsed = fs::file_time_type::min();
+        uint64_t bytes = 0;
+        std::vector<fs::path> files;
+    };
+    std::unordered_map<std::string, Entry> entries;
+    std::error_code error;
+    for (fs::directory_iterator it(directory_, error), end; !error && it != end; it.increment(error)) {
+        std::error_code fileError;
+        if (!it->is_regular_file(fileError)) continue;
+
+        // Leave alone anything this cache did not write
+        std::string filename = it->path().filename().string();
+        std::string stem = filename.substr(0, filename.find('.'));
+        if (stem.empty() || stem.size() == filename.size() || stem.size() > 16 ||
+            stem.find_first_not_of("0123456789abcdef") != std::string::npos) {
+            continue;
+        }
+
+        fs::file_time_type modified = it->last_write_time(fileError);
+        uint64_t bytes = it->file_size(fileError);
+        if (fileError) continue;
+        Entry& entry = entries[stem];
+        entry.lastUsed = std::max(entry.lastUsed, modified);
+        entry.bytes += bytes;
+        entry.files.push_back(it->path());
+    }
+
+    auto remove = [](const Entry& entry) {
+        std::error_code removeError;
+        for (const auto& file : entry.files) fs::remove(file, removeError);
+    };
+    auto cutoff = fs::file_time_type::clock::now() - std::chrono::hours(24 * kMaxAgeDays);
+    std::vector<std::pair<fs::file_time_type, const Entry*>> kept;
+    uint64_t total = 0;
+    for (const auto& [stem, entry] : entries) {
+        if (stem != keep && entry.lastUsed < cutoff) {
+            remove(entry);
+            continue;
+        }
+        total += entry.bytes;
+        if (stem != keep) kept.push_back({entry.lastUsed, &entry});
+    }
+
+    // Least recently used first
+    std::sort(kept.begin(), kept.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+    for (size_t i = 0; i < kept.size() && total > kMaxBytes; ++i) {
+        remove(*kept[i].second);
+        total -= kept[i].second->bytes;
+    }
+}
+
+bool PreambleCache::prepare(const std::vector<std::string>& args, Tracer* tracer) {
+    if (shared_.empty() || directory_.empty()) return false;
+
+    TraceScope scope(tracer, "preamble", "parse");
+    scope.setCounter("directives", static_cast<int64_t>(shared_.size()));
+
+    std::string header;
+    for (const auto& key : shared_) {
+        header += "#include " + key + "\n";
+    }
+    std::vector<std::string> keyParts = {clang::getClangFullVersion(), header};
+    keyParts.insert(keyParts.end(), args.begin(), args.end());
+    std::stringstream name;
+    name << std::hex << preambleHash(keyParts);
+
+    std::error_code error;
+    fs::create_directories(directory_, error);
+    if (error) {
+        std::cerr << "Warning: Cannot create preamble cache " << directory_ << ": " << error.message()
+                  << std::endl;
+        return false;
+    }
+
+    fs::path base = fs::path(directory_) / name.str();
+    pchPath_ = base.string() + ".pch";
+    std::string dependencyFile = base.string() + ".d";
+    std::string hashFile = base.string() + ".hash";
+    if (isFresh(dependencyFile, hashFile)) {
+        // The hash file's mtime marks the last use for pruning
+        fs::last_write_time(hashFile, fs::file_time_type::clock::now(), error);
+        prune(name.str());
+        reused_ = true;
+        scope.setCounter("reused", 1);
+        return true;
+    }
+
+    std::string headerPath = base.string() + ".h";
+    {
+        std::ofstream out(headerPath);
+        if (!out.is_open()) {
+            std::cerr << "Warning: Cannot write " << headerPath << std::endl;
+            return false;
+        }
+        out << header;
+    }
+
+    // Concurrent runs (e.g. shards) may build the same PCH; each writes its
+    // own files and renames them into place
+    std::string suffix = "." + std::to_string(::getpid()) + ".tmp";
+    std::string pchTemp = pchPath_ + suffix;
+    std::string dependencyTemp = dependencyFile + suffix;
+    std::string hashTemp = hashFile + suffix;
+    std::vector<std::string> pchArgs = args;
+    pchArgs.insert(pchArgs.end(), {"-x", "c++-header", "-MD", "-MF", dependencyTemp, "-o", pchTemp});
+
+    clang::tooling::FixedCompilationDatabase compilations(".", pchArgs);
+    clang::tooling::ClangTool tool(compilations, {headerPath});
+    // The defaults would turn this into a syntax-only run without outputs
+    tool.clearArgumentsAdjusters();
+    auto factory = clang::tooling::newFrontendActionFactory<clang::GeneratePCHAction>();
+    bool built = tool.run(factory.get()) == 0;
+
+    // Hash the headers as they were built from, so later edits that keep
+    // their mtime still invalidate the PCH
+    uint64_t hash = 0;
+    if (built && contentsHash(dependencyPaths(readText(dependencyTemp)), hash)) {
+        std::ofstream out(hashTemp, std::ios::binary);
+        out << hexString(hash);
+        built = out.good();
+    } else {
+        built = false;
+    }
+
+    if (built) {
+        // The hash goes in last, so a PCH is never reused with a stale one
+        fs::remove(hashFile, error);
+        fs::rename(pchTemp, pchPath_, error);
+        if (!error) fs::rename(dependencyTemp, dependencyFile, error);
+        if (!error) fs::rename(hashTemp, hashFile, error);
+        built = !error;
+    }
+    if (!built) {
+        fs::remove(pchTemp, error);
+        fs::remove(dependencyTemp, error);
+        fs::remove(hashTemp, error);
+        std::cerr << "Warning: Could not precompile the shared includes, parsing without them" << std::endl;
+        return false;
+    }
+    prune(name.str());
+    scope.setCounter("reused", 0);
+    return true;
+}
+
+size_t PreambleCache::preambleBytes(const std::string& file) const {
+    auto it = bytes_.find(normalizedPath(file));
+    return it == bytes_.end() ? 0 : it->second;
+}
+
+} // namespace cpp_diagram
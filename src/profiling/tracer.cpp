@@ -0,0 +1,200 @@
+#include "profiling/tracer.h"
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+namespace cpp_diagram {
+
+namespace {
+
+// Process CPU time (user + system) and peak resident set size
+void sampleUsage(int64_t& cpuMicros, int64_t& peakRssKb) {
+#if defined(__unix__) || defined(__APPLE__)
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    cpuMicros = (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000LL +
+                usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+#if defined(__APPLE__)
+    peakRssKb = usage.ru_maxrss / 1024;  // bytes on macOS
+#else
+    peakRssKb = usage.ru_maxrss;
+#endif
+#else
+    cpuMicros = static_cast<int64_t>(std::clock()) * 1000000LL / CLOCKS_PER_SEC;
+    peakRssKb = 0;
+#endif
+}
+
+std::string escapeJson(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        switch (c) {
+            case '"': escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\t': escaped += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buffer[8];
+                    std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                    escaped += buffer;
+                } else {
+                    escaped += c;
+                }
+        }
+    }
+    return escaped;
+}
+
+} // namespace
+
+Tracer::Tracer() : origin_(std::chrono::steady_clock::now()) {}
+Tracer::~Tracer() = default;
+
+int64_t Tracer::nowMicros() const {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - origin_).count();
+}
+
+size_t Tracer::begin(const std::string& name, const std::string& category) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Event event;
+    event.name = name;
+    event.category = category;
+    event.depth = openEvents_++;
+    int64_t cpuMicros = 0;
+    sampleUsage(cpuMicros, event.peakRssKb);
+    event.startMicros = nowMicros();
+    events_.push_back(std::move(event));
+    cpuAtBegin_.push_back(cpuMicros);
+    return events_.size() - 1;
+}
+
+void Tracer::end(size_t event) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (event >= events_.size()) {
+        return;
+    }
+    Event& entry = events_[event];
+    entry.wallMicros = nowMicros() - entry.startMicros;
+    int64_t cpuMicros = 0;
+    sampleUsage(cpuMicros, entry.peakRssKb);
+    entry.cpuMicros = cpuMicros - cpuAtBegin_[event];
+    --openEvents_;
+}
+
+void Tracer::setCounter(size_t event, const std::string& name, int64_t value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (event < events_.size()) {
+        events_[event].counters[name] = value;
+    }
+}
+
+bool Tracer::writeChromeTrace(const std::string& path) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    // Complete ("X") events carry their own duration, so nesting is implied
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    for (size_t i = 0; i < events_.size(); ++i) {
+        const Event& event = events_[i];
+        if (i > 0) file << ",";
+        file << "\n{\"name\":\"" << escapeJson(event.name) << "\""
+             << ",\"cat\":\"" << escapeJson(event.category) << "\""
+             << ",\"ph\":\"X\",\"pid\":1,\"tid\":1"
+             << ",\"ts\":" << event.startMicros
+             << ",\"dur\":" << event.wallMicros
+             << ",\"args\":{\"cpu_us\":" << event.cpuMicros
+             << ",\"peak_rss_kb\":" << event.peakRssKb;
+        for (const auto& counter : event.counters) {
+            file << ",\"" << escapeJson(counter.first) << "\":" << counter.second;
+        }
+        file << "}}";
+    }
+    file << "\n]}\n";
+    return file.good();
+}
+
+std::map<std::string, Tracer::PhaseTotal> Tracer::categoryTotals() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::map<std::string, PhaseTotal> totals;
+    for (const auto& event : events_) {
+        PhaseTotal& total = totals[event.category];
+        ++total.count;
+        total.wallMicros += event.wallMicros;
+        total.cpuMicros += event.cpuMicros;
+    }
+    return totals;
+}
+
+int64_t Tracer::peakRssKb() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    int64_t peak = 0;
+    for (const auto& event : events_) {
+        peak = std::max(peak, event.peakRssKb);
+    }
+    return peak;
+}
+
+std::string Tracer::generateSummary() const {
+    auto totals = categoryTotals();
+    int64_t peak = peakRssKb();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::stringstream ss;
+
+    ss << std::fixed << std::setprecision(1);
+    ss << "Phase Summary (peak RSS " << peak / 1024.0 << " MB):\n";
+    ss << "  " << std::left << std::setw(16) << "category" << std::right
+       << std::setw(8) << "events" << std::setw(12) << "wall ms" << std::setw(12) << "cpu ms" << "\n";
+    for (const auto& entry : totals) {
+        ss << "  " << std::left << std::setw(16) << entry.first << std::right
+           << std::setw(8) << entry.second.count
+           << std::setw(12) << entry.second.wallMicros / 1000.0
+           << std::setw(12) << entry.second.cpuMicros / 1000.0 << "\n";
+    }
+
+    ss << "\nEvents:\n";
+    for (const auto& event : events_) {
+        ss << "  " << std::string(event.depth * 2, ' ') << event.name
+           << " [" << event.category << "] wall " << event.wallMicros / 1000.0
+           << " ms, cpu " << event.cpuMicros / 1000.0
+           << " ms, rss " << event.peakRssKb / 1024.0 << " MB";
+        for (const auto& counter : event.counters) {
+            ss << ", " << counter.first << " " << counter.second;
+        }
+        ss << "\n";
+    }
+
+    return ss.str();
+}
+
+TraceScope::TraceScope(Tracer* tracer, const std::string& name, const std::string& category)
+    : tracer_(tracer) {
+    if (tracer_) {
+        event_ = tracer_->begin(name, category);
+    }
+}
+
+TraceScope::~TraceScope() {
+    if (tracer_) {
+        tracer_->end(event_);
+    }
+}
+
+void TraceScope::setCounter(const std::string& name, int64_t value) {
+    if (tracer_) {
+        tracer_->setCounter(event_, name, value);
+    }
+}
+
+} // namespace cpp_diagram
@@ -0,0 +1,827 @@
+#include "server/query_server.h"
+#include "parser/ast_parser.h"
+#include "visualizer/diagram_generator.h"
+#include "analysis/graph_query.h"
+#include "analysis/layout_analyzer.h"
+#include "analysis/concurrency_analyzer.h"
+#include "analysis/component_analyzer.h"
+#include "model/model_file.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace cpp_diagram {
+
+namespace {
+
+std::string escapeJson(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        switch (c) {
+            case '"': escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\t': escaped += "\\t"; break;
+            case '\r': escaped += "\\r"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buffer[8];
+                    std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                    escaped += buffer;
+                } else {
+                    escaped += c;
+                }
+        }
+    }
+    return escaped;
+}
+
+std::string quote(const std::string& text) {
+    return "\"" + escapeJson(text) + "\"";
+}
+
+std::string errorResponse(const std::string& message) {
+    return "{\"ok\":false,\"error\":" + quote(message) + "}";
+}
+
+void skipSpace(const std::string& text, size_t& pos) {
+    while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) ++pos;
+}
+
+bool parseString(const std::string& text, size_t& pos, std::string& value) {
+    if (pos >= text.size() || text[pos] != '"') return false;
+    ++pos;
+    value.clear();
+    while (pos < text.size() && text[pos] != '"') {
+        char c = text[pos++];
+        if (c == '\\' && pos < text.size()) {
+            char escape = text[pos++];
+            switch (escape) {
+                case 'n': value += '\n'; break;
+                case 't': value += '\t'; break;
+                case 'r': value += '\r'; break;
+                case 'u':
+                    // Requests only carry names and paths; keep ASCII escapes
+                    if (pos + 4 > text.size()) return false;
+                    {
+                        int code = 0;
+                        for (size_t end = pos + 4; pos < end; ++pos) {
+                            char digit = text[pos];
+                            if (!std::isxdigit(static_cast<unsigned char>(digit))) return false;
+                            code = code * 16 + (std::isdigit(static_cast<unsigned char>(digit))
+                                                    ? digit - '0'
+                                                    : std::tolower(static_cast<unsigned char>(digit)) - 'a' + 10);
+                        }
+                        value += static_cast<char>(code & 0x7f);
+                    }
+                    break;
+                default: value += escape; break;
+            }
+        } else {
+            value += c;
+        }
+    }
+    if (pos >= text.size()) return false;
+    ++pos;
+    return true;
+}
+
+// Requests are flat objects; numbers, booleans and null are kept as text
+bool parseRequest(const std::string& text, std::map<std::string, std::string>& request) {
+    size_t pos = 0;
+    skipSpace(text, pos);
+    if (pos >= text.size() || text[pos++] != '{') return false;
+    skipSpace(text, pos);
+    if (pos < text.size() && text[pos] == '}') return true;
+
+    while (pos < text.size()) {
+        std::string key;
+        std::string value;
+        skipSpace(text, pos);
+        if (!parseString(text, pos, key)) return false;
+        skipSpace(text, pos);
+        if (pos >= text.size() || text[pos++] != ':') return false;
+        skipSpace(text, pos);
+        if (pos < text.size() && text[pos] == '"') {
+            if (!parseString(text, pos, value)) return false;
+        } else {
+            size_t start = pos;
+            while (pos < text.size() && text[pos] != ',' && text[pos] != '}' &&
+                   !std::isspace(static_cast<unsigned char>(text[pos]))) {
+                ++pos;
+            }
+            value = text.substr(start, pos - start);
+            if (value.empty()) return false;
+        }
+        request[key] = value;
+        skipSpace(text, pos);
+        if (pos < text.size() && text[pos] == ',') {
+            ++pos;
+            continue;
+        }
+        return pos < text.size() && text[pos] == '}';
+    }
+    return false;
+}
+
+std::string field(const std::map<std::string, std::string>& request, const std::string& key,
+                  const std::string& fallback = "") {
+    auto it = request.find(key);
+    return it != request.end() ? it->second : fallback;
+}
+
+int intField(const std::map<std::string, std::string>& request, const std::string& key, int fallback) {
+    auto it = request.find(key);
+    if (it == request.end()) return fallback;
+    try {
+        return std::stoi(it->second);
+    } catch (const std::exception&) {
+        return fallback;
+    }
+}
+
+const char* relationshipName(RelationshipType type) {
+    switch (type) {
+        case RelationshipType::Inheritance: return "inheritance";
+        case RelationshipType::Composition: return "composition";
+        case RelationshipType::Aggregation: return "aggregation";
+        case RelationshipType::Association: return "association";
+        case RelationshipType::Dependency: return "dependency";
+    }
+    return "unknown";
+}
+
+std::string metricsJson(const CodeMetrics& metrics) {
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(3);
+    ss << "{\"cyclomatic_complexity\":" << metrics.cyclomaticComplexity
+       << ",\"lines_of_code\":" << metrics.linesOfCode
+       << ",\"methods\":" << metrics.numberOfMethods
+       << ",\"attributes\":" << metrics.numberOfAttributes
+       << ",\"coupling\":" << metrics.coupling
+       << ",\"cohesion\":" << metrics.cohesion << "}";
+    return ss.str();
+}
+
+// Formats whose output can be returned inline in a JSON string
+bool isTextFormat(const std::string& format) {
+    return format == "svg" || format == "dot" || format == "gv" || format == "plain" ||
+           format == "json" || format == "xdot";
+}
+
+bool readFile(const fs::path& path, std::string& content) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+    content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+bool sendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool makeAddress(const std::string& socketPath, sockaddr_un& address) {
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Error: Socket path too long: " << socketPath << std::endl;
+        return false;
+    }
+    std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+    return true;
+}
+
+// Only a stale socket left by a previous run is removed; any other file at
+// the path, or a socket another server still listens on, is an error
+bool removeStaleSocket(const std::string& socketPath, const sockaddr_un& address) {
+    struct stat status;
+    if (lstat(socketPath.c_str(), &status) != 0) {
+        if (errno == ENOENT) return true;
+        std::cerr << "Error: Cannot stat " << socketPath << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    if (!S_ISSOCK(status.st_mode)) {
+        std::cerr << "Error: " << socketPath << " exists and is not a socket" << std::endl;
+        return false;
+    }
+
+    int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+    bool live = probe >= 0 &&
+                connect(probe, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0;
+    if (probe >= 0) close(probe);
+    if (live) {
+        std::cerr << "Error: Another server is listening on " << socketPath << std::endl;
+        return false;
+    }
+
+    if (unlink(socketPath.c_str()) != 0) {
+        std::cerr << "Error: Cannot remove " << socketPath << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// A client connection and the part of a request line read so far
+struct Client {
+    int fd;
+    std::string buffer;
+    std::chrono::steady_clock::time_point lastActive;
+};
+
+// Clients idle this long are dropped, and a request line may be at most
+// kMaxRequestBytes, so stuck or misbehaving clients cannot pin descriptors
+// or memory
+constexpr auto kIdleTimeout = std::chrono::seconds(60);
+constexpr int kSendTimeoutSeconds = 10;
+constexpr size_t kMaxRequestBytes = 1 << 20;
+
+} // namespace
+
+QueryServer::QueryServer() {
+    std::error_code error;
+    outputRoot_ = fs::current_path(error);
+}
+QueryServer::~QueryServer() {
+    if (!scratchDirectory_.empty()) {
+        std::error_code error;
+        fs::remove_all(scratchDirectory_, error);
+    }
+}
+
+fs::path QueryServer::scratchDirectory() {
+    // Created with mode 0700 under an unpredictable name, so other users
+    // cannot plant files or symlinks where inline diagrams are rendered
+    if (scratchDirectory_.empty()) {
+        std::string pattern = (fs::temp_directory_path() / "cpp_diagram_server_XXXXXX").string();
+        if (mkdtemp(pattern.data())) {
+            scratchDirectory_ = pattern;
+        } else {
+            std::cerr << "Error: Cannot create a scratch directory: " << std::strerror(errno) << std::endl;
+        }
+    }
+    return scratchDirectory_;
+}
+
+bool QueryServer::setOutputRoot(const std::string& directory) {
+    std::error_code error;
+    fs::path root = fs::canonical(directory, error);
+    if (error || !fs::is_directory(root)) {
+        std::cerr << "Error: Output root is not a directory: " << directory << std::endl;
+        return false;
+    }
+    outputRoot_ = root;
+    return true;
+}
+
+fs::path QueryServer::resolveOutput(const std::string& path) const {
+    if (outputRoot_.empty()) return {};
+
+    // Resolve symlinks in the existing part of the path, so a link inside
+    // the root cannot point the write elsewhere
+    std::error_code error;
+    fs::path target = fs::weakly_canonical(outputRoot_ / path, error);
+    if (error) return {};
+    fs::path relative = target.lexically_relative(outputRoot_);
+    if (relative.empty() || relative == "." || *relative.begin() == "..") return {};
+    return target;
+}
+
+bool QueryServer::load(const std::vector<std::string>& inputFiles) {
+    ASTParser parser;
+    if (!parser.parseFiles(inputFiles)) {
+        return false;
+    }
+
+    // The index refers into the vectors, so drop it before replacing them
+    index_.reset();
+    inputFiles_ = inputFiles;
+    modelPath_.clear();
+    classes_ = parser.getClassInfo();
+    functions_ = parser.getFunctionInfo();
+    relationships_ = parser.getRelationships();
+    buildIndex();
+    return true;
+}
+
+bool QueryServer::loadModel(const std::string& path) {
+    std::vector<ClassInfo> classes;
+    std::vector<FunctionInfo> functions;
+    std::vector<RelationshipInfo> relationships;
+    ModelFile modelFile;
+    if (!modelFile.open(path) || !modelFile.load(classes, functions, relationships)) {
+        return false;
+    }
+
+    index_.reset();
+    inputFiles_.clear();
+    modelPath_ = path;
+    classes_ = std::move(classes);
+    functions_ = std::move(functions);
+    relationships_ = std::move(relationships);
+    buildIndex();
+    return true;
+}
+
+void QueryServer::buildIndex() {
+    index_ = std::make_unique<ModelIndex>(classes_, functions_, relationships_);
+
+    classNeighbours_.assign(classes_.size(), {});
+    for (size_t id = 0; id < classes_.size(); ++id) {
+        for (size_t baseId : index_->baseClasses(id)) {
+            classNeighbours_[id].push_back(baseId);
+            classNeighbours_[baseId].push_back(id);
+        }
+    }
+    for (const auto& relationship : relationships_) {
+        size_t fromId = index_->findClass(relationship.fromClass);
+        size_t toId = index_->findClass(relationship.toClass);
+        if (fromId != ModelIndex::npos && toId != ModelIndex::npos && fromId != toId) {
+            classNeighbours_[fromId].push_back(toId);
+            classNeighbours_[toId].push_back(fromId);
+        }
+    }
+
+
+    // Whole-codebase metrics are the most common query; compute them once
+    summary_ = analyzer_.analyzeCodebase(classes_, functions_, relationships_);
+}
+
+std::vector<size_t> QueryServer::sliceClasses(size_t root, int depth) const {
+    std::vector<int> distance(classes_.size(), -1);
+    std::vector<size_t> slice{root};
+    distance[root] = 0;
+    for (size_t i = 0; i < slice.size(); ++i) {
+        size_t id = slice[i];
+        if (distance[id] >= depth) continue;
+        for (size_t next : classNeighbours_[id]) {
+            if (distance[next] < 0) {
+                distance[next] = distance[id] + 1;
+                slice.push_back(next);
+            }
+        }
+    }
+    return slice;
+}
+
+std::vector<size_t> QueryServer::sliceFunctions(size_t root, int depth, const std::string& direction) const {
+    bool followCallees = direction != "callers";
+    bool followCallers = direction != "callees";
+    std::vector<int> distance(functions_.size(), -1);
+    std::vector<size_t> slice{root};
+    distance[root] = 0;
+    for (size_t i = 0; i < slice.size(); ++i) {
+        size_t id = slice[i];
+        if (distance[id] >= depth) continue;
+        auto visit = [&](ModelIndex::IdRange neighbours) {
+            for (size_t next : neighbours) {
+                if (distance[next] < 0) {
+                    distance[next] = distance[id] + 1;
+                    slice.push_back(next);
+                }
+            }
+        };
+        if (followCallees) visit(index_->callees(id));
+        if (followCallers) visit(index_->callers(id));
+    }
+    return slice;
+}
+
+std::string QueryServer::handle(const std::string& line) {
+    auto start = std::chrono::steady_clock::now();
+    ++requestCount_;
+
+    Request request;
+    std::string response;
+    if (!parseRequest(line, request)) {
+        response = errorResponse("malformed request");
+    } else {
+        std::string query = field(request, "query");
+        if (!index_ && query != "reload" && query != "shutdown") {
+            response = errorResponse("no model loaded");
+        } else if (query == "metrics") {
+            response = handleMetrics(request);
+        } else if (query == "slice") {
+            response = handleSlice(request);
+        } else if (query == "select") {
+            response = handleSelect(request);
+        } else if (query == "diagram") {
+            response = handleDiagram(request);
+        } else if (query == "reload") {
+            response = handleReload();
+        } else if (query == "shutdown") {
+            running_ = false;
+            response = "{\"ok\":true}";
+        } else {
+            response = errorResponse("unknown query: " + query);
+        }
+    }
+
+    // Every response carries the server-side latency
+    double elapsedMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(3) << ",\"elapsed_ms\":" << elapsedMs << "}";
+    response.pop_back();
+    return response + ss.str();
+}
+
+std::string QueryServer::handleMetrics(const Request& request) {
+    std::stringstream ss;
+    std::string className = field(request, "class");
+    std::string functionName = field(request, "function");
+
+    if (!className.empty()) {
+        size_t id = index_->findClass(className);
+        if (id == ModelIndex::npos) return errorResponse("unknown class: " + className);
+        CodeSummary summary = analyzer_.analyzeClass(classes_[id]);
+        ss << "{\"ok\":true,\"class\":" << quote(className)
+           << ",\"purpose\":" << quote(summary.purpose)
+           << ",\"metrics\":" << metricsJson(summary.metrics) << "}";
+        return ss.str();
+    }
+
+    if (!functionName.empty()) {
+        size_t id = index_->findFunction(functionName);
+        if (id == ModelIndex::npos) return errorResponse("unknown function: " + functionName);
+        CodeSummary summary = analyzer_.analyzeFunction(functions_[id]);
+        ss << "{\"ok\":true,\"function\":" << quote(functionName)
+           << ",\"purpose\":" << quote(summary.purpose)
+           << ",\"metrics\":" << metricsJson(summary.metrics)
+           << ",\"callers\":" << index_->callers(id).size()
+           << ",\"callees\":" << index_->callees(id).size() << "}";
+        return ss.str();
+    }
+
+    ss << "{\"ok\":true,\"classes\":" << classes_.size()
+       << ",\"functions\":" << functions_.size()
+       << ",\"relationships\":" << relationships_.size()
+       << ",\"purpose\":" << quote(summary_.purpose)
+       << ",\"metrics\":" << metricsJson(summary_.metrics)
+       << ",\"patterns\":[";
+    for (size_t i = 0; i < summary_.designPatterns.size(); ++i) {
+        if (i > 0) ss << ",";
+        ss << quote(summary_.designPatterns[i]);
+    }
+    ss << "]}";
+    return ss.str();
+}
+
+std::string QueryServer::handleSlice(const Request& request) {
+    std::string root = field(request, "root");
+    int depth = std::max(intField(request, "depth", 1), 0);
+    std::stringstream ss;
+
+    size_t classId = index_->findClass(root);
+    if (classId != ModelIndex::npos) {
+        auto slice = sliceClasses(classId, depth);
+        std::vector<bool> inSlice(classes_.size(), false);
+        for (size_t id : slice) inSlice[id] = true;
+
+        ss << "{\"ok\":true,\"kind\":\"class\",\"root\":" << quote(root) << ",\"classes\":[";
+        for (size_t i = 0; i < slice.size(); ++i) {
+            if (i > 0) ss << ",";
+            ss << quote(classes_[slice[i]].qualifiedName);
+        }
+        ss << "],\"relationships\":[";
+        bool first = true;
+        for (const auto& relationship : relationships_) {
+            size_t fromId = index_->findClass(relationship.fromClass);
+            size_t toId = index_->findClass(relationship.toClass);
+            if (fromId == ModelIndex::npos || toId == ModelIndex::npos ||
+                !inSlice[fromId] || !inSlice[toId]) {
+                continue;
+            }
+            ss << (first ? "" : ",") << "{\"from\":" << quote(relationship.fromClass)
+               << ",\"to\":" << quote(relationship.toClass)
+               << ",\"type\":\"" << relationshipName(relationship.type) << "\"}";
+            first = false;
+        }
+        ss << "]}";
+        return ss.str();
+    }
+
+    size_t functionId = index_->findFunction(root);
+    if (functionId != ModelIndex::npos) {
+        auto slice = sliceFunctions(functionId, depth, field(request, "direction", "both"));
+        ss << "{\"ok\":true,\"kind\":\"function\",\"root\":" << quote(root) << ",\"functions\":[";
+        for (size_t i = 0; i < slice.size(); ++i) {
+            if (i > 0) ss << ",";
+            ss << quote(functions_[slice[i]].qualifiedName);
+        }
+        ss << "]}";
+        return ss.str();
+    }
+
+    return errorResponse("unknown class or function: " + root);
+}
+
+std::string QueryServer::handleSelect(const Request& request) {
+    GraphQuery query;
+    if (!query.compile(field(request, "select"))) {
+        return errorResponse("invalid query: " + query.error());
+    }
+    QueryResult matches = query.run(*index_);
+    bool isClass = matches.target == QueryTarget::Classes;
+
+    std::stringstream ss;
+    ss << "{\"ok\":true,\"kind\":\"" << (isClass ? "class" : "function") << "\",\"count\":"
+       << matches.ids.size() << ",\"matches\":[";
+    for (size_t i = 0; i < matches.ids.size(); ++i) {
+        if (i > 0) ss << ",";
+        size_t id = matches.ids[i];
+        ss << quote(isClass ? classes_[id].qualifiedName : functions_[id].qualifiedName);
+    }
+    ss << "]}";
+    return ss.str();
+}
+
+std::string QueryServer::handleDiagram(const Request& request) {
+    std::string type = field(request, "type", "class");
+    std::string format = field(request, "format", "svg");
+    std::string root = field(request, "root");
+    std::string output = field(request, "output");
+    int depth = std::max(intField(request, "depth", 1), 0);
+
+    if (output.empty() && !isTextFormat(format)) {
+        return errorResponse("binary format " + format + " needs an output path");
+    }
+    fs::path target;
+    if (!output.empty()) {
+        target = resolveOutput(output);
+        if (target.empty()) return errorResponse("output must be a file under " + outputRoot_.string());
+    }
+
+    // Restrict the model to a query's matches or to the slice around root,
+    // if either was given
+    std::string selection = field(request, "select");
+    std::vector<ClassInfo> classes;
+    std::vector<FunctionInfo> functions;
+    if (!selection.empty()) {
+        if (!root.empty()) return errorResponse("root and select cannot be combined");
+        GraphQuery query;
+        if (!query.compile(selection)) return errorResponse("invalid query: " + query.error());
+        // Edges are filtered to the drawn classes when rendering
+        std::vector<RelationshipInfo> relationships;
+        GraphQuery::select(*index_, query.run(*index_), classes, functions, relationships);
+    } else if (root.empty()) {
+        classes = classes_;
+        functions = functions_;
+    } else if (type == "call") {
+        size_t id = index_->findFunction(root);
+        if (id == ModelIndex::npos) return errorResponse("unknown function: " + root);
+        for (size_t sliceId : sliceFunctions(id, depth, field(request, "direction", "both"))) {
+            functions.push_back(functions_[sliceId]);
+        }
+    } else {
+        size_t id = index_->findClass(root);
+        if (id == ModelIndex::npos) return errorResponse("unknown class: " + root);
+        for (size_t sliceId : sliceClasses(id, depth)) {
+            classes.push_back(classes_[sliceId]);
+        }
+    }
+
+    if (output.empty()) {
+        fs::path scratch = scratchDirectory();
+        if (scratch.empty()) return errorResponse("cannot create a scratch directory");
+        target = scratch / ("diagram_" + std::to_string(requestCount_) + "." + format);
+    }
+
+    DiagramGenerator diagramGenerator;
+    diagramGenerator.setStyle(field(request, "style", "default"));
+    diagramGenerator.setOutputFormat(format);
+    diagramGenerator.setDetailLevel(intField(request, "detail", 3),
+                                    static_cast<size_t>(std::max(intField(request, "member_limit", 0), 0)));
+
+    bool success = false;
+    if (type == "class") {
+        success = diagramGenerator.generateClassDiagram(classes, relationships_, target.string());
+    } else if (type == "call") {
+        success = diagramGenerator.generateCallGraph(functions, target.string());
+    } else if (type == "component") {
+        ComponentAnalyzer componentAnalyzer;
+        if (!componentAnalyzer.setGrouping(field(request, "group", "directory"), intField(request, "component_depth", 0))) {
+            return errorResponse("unknown component grouping");
+        }
+        success = diagramGenerator.generateComponentDiagram(
+            componentAnalyzer.analyze(classes, functions, relationships_), target.string());
+    } else if (type == "layout") {
+        LayoutAnalyzer layoutAnalyzer;
+        success = diagramGenerator.generateLayoutDiagram(layoutAnalyzer.analyze(classes), target.string());
+    } else if (type == "concurrency") {
+        // Writes are counted over the whole model, not just the slice
+        ConcurrencyAnalyzer concurrencyAnalyzer;
+        concurrencyAnalyzer.setWriteThreshold(intField(request, "write_threshold", 2));
+        success = diagramGenerator.generateConcurrencyDiagram(concurrencyAnalyzer.analyze(classes, functions_),
+                                                              target.string());
+    } else {
+        return errorResponse("unknown diagram type: " + type);
+    }
+
+    if (!success) {
+        return errorResponse("failed to generate " + type + " diagram");
+    }
+
+    std::stringstream ss;
+    ss << "{\"ok\":true,\"type\":" << quote(type) << ",\"format\":" << quote(format)
+       << ",\"classes\":" << classes.size() << ",\"functions\":" << functions.size();
+    if (output.empty()) {
+        std::string content;
+        bool read = readFile(target, content);
+        fs::remove(target);
+        if (!read) return errorResponse("cannot read rendered diagram");
+        ss << ",\"content\":" << quote(content);
+    } else {
+        ss << ",\"output\":" << quote(target.string());
+    }
+    ss << "}";
+    return ss.str();
+}
+
+std::string QueryServer::handleReload() {
+    if (!modelPath_.empty()) {
+        std::string modelPath = modelPath_;
+        if (!loadModel(modelPath)) {
+            return errorResponse("failed to load model " + modelPath);
+        }
+    } else if (!inputFiles_.empty()) {
+        std::vector<std::string> inputFiles = inputFiles_;
+        if (!load(inputFiles)) {
+            return errorResponse("failed to parse input files");
+        }
+    } else {
+        return errorResponse("nothing to reload");
+    }
+    std::stringstream ss;
+    ss << "{\"ok\":true,\"classes\":" << classes_.size() << ",\"functions\":" << functions_.size() << "}";
+    return ss.str();
+}
+
+bool QueryServer::serve(const std::string& socketPath) {
+    sockaddr_un address;
+    if (!makeAddress(socketPath, address)) {
+        return false;
+    }
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        std::cerr << "Error: Cannot create socket" << std::endl;
+        return false;
+    }
+
+    if (!removeStaleSocket(socketPath, address)) {
+        close(listener);
+        return false;
+    }
+    if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+        listen(listener, 16) < 0) {
+        std::cerr << "Error: Cannot listen on " << socketPath << std::endl;
+        close(listener);
+        return false;
+    }
+
+    // Remember which file is ours, so shutdown leaves alone a socket that
+    // replaced it in the meantime
+    struct stat bound;
+    bool haveBound = lstat(socketPath.c_str(), &bound) == 0;
+
+    // Requests are handled on this thread, so the model is never shared,
+    // but every client is polled and a slow one only delays its own
+    // requests; responses wait at most kSendTimeoutSeconds on a full socket
+    std::vector<Client> clients;
+    std::vector<pollfd> fds;
+    running_ = true;
+    while (running_) {
+        fds.assign(1, pollfd{listener, POLLIN, 0});
+        for (const Client& client : clients) {
+            fds.push_back(pollfd{client.fd, POLLIN, 0});
+        }
+        int ready = poll(fds.data(), fds.size(), 1000);
+        if (ready < 0 && errno != EINTR) {
+            std::cerr << "Error: poll failed: " << std::strerror(errno) << std::endl;
+            break;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        std::vector<char> closed(clients.size(), 0);
+        for (size_t i = 0; ready > 0 && i < clients.size() && running_; ++i) {
+            if (!fds[i + 1].revents) continue;
+            Client& client = clients[i];
+            client.lastActive = now;
+
+            char chunk[4096];
+            ssize_t n = recv(client.fd, chunk, sizeof(chunk), 0);
+            if (n <= 0) {
+                closed[i] = 1;
+                continue;
+            }
+            client.buffer.append(chunk, static_cast<size_t>(n));
+
+            size_t newline;
+            while (!closed[i] && running_ && (newline = client.buffer.find('\n')) != std::string::npos) {
+                std::string line = client.buffer.substr(0, newline);
+                client.buffer.erase(0, newline + 1);
+                if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+                // A failing handler costs its request, not the server
+                std::string response;
+                try {
+                    response = handle(line);
+                } catch (const std::exception& e) {
+                    response = errorResponse(std::string("internal error: ") + e.what());
+                }
+                if (!sendAll(client.fd, response + "\n")) closed[i] = 1;
+            }
+            if (client.buffer.size() > kMaxRequestBytes) {
+                sendAll(client.fd, errorResponse("request too long") + "\n");
+                closed[i] = 1;
+            }
+        }
+
+        size_t kept = 0;
+        for (size_t i = 0; i < clients.size(); ++i) {
+            if (closed[i] || now - clients[i].lastActive > kIdleTimeout) {
+                close(clients[i].fd);
+            } else {
+                clients[kept++] = std::move(clients[i]);
+            }
+        }
+        clients.resize(kept);
+
+        if (ready > 0 && running_ && (fds[0].revents & POLLIN)) {
+            int connection = accept(listener, nullptr, nullptr);
+            if (connection >= 0) {
+                timeval timeout{kSendTimeoutSeconds, 0};
+                setsockopt(connection, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+                clients.push_back(Client{connection, std::string(), now});
+            }
+        }
+    }
+
+    for (const Client& client : clients) {
+        close(client.fd);
+    }
+    close(listener);
+    struct stat current;
+    if (haveBound && lstat(socketPath.c_str(), &current) == 0 && S_ISSOCK(current.st_mode) &&
+        current.st_ino == bound.st_ino && current.st_dev == bound.st_dev) {
+        unlink(socketPath.c_str());
+    }
+    return true;
+}
+
+bool QueryServer::query(const std::string& socketPath, const std::string& request,
+                        std::string& response) {
+    sockaddr_un address;
+    if (!makeAddress(socketPath, address)) {
+        return false;
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        std::cerr << "Error: Cannot connect to " << socketPath << std::endl;
+        if (fd >= 0) close(fd);
+        return false;
+    }
+
+    bool sent = sendAll(fd, request + "\n");
+    response.clear();
+    char chunk[4096];
+    while (sent && response.find('\n') == std::string::npos) {
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) break;
+        response.append(chunk, static_cast<size_t>(n));
+    }
+    close(fd);
+
+    if (!sent || response.empty()) {
+        std::cerr << "Error: No response from " << socketPath << std::endl;
+        return false;
+    }
+    response.erase(response.find_last_not_of('\n') + 1);
+    return true;
+}
+
+} // namespace cpp_diagram
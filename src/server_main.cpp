@@ -0,0 +1,77 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cxxopts.hpp>
+#include "server/query_server.h"
+
+int main(int argc, char* argv[]) {
+    try {
+        cxxopts::Options options("cpp_diagram_server",
+                               "Keep a parsed C++ model in memory and answer queries over a Unix socket");
+
+        options.add_options()
+            ("i,input", "Input C++ source files to load", cxxopts::value<std::vector<std::string>>())
+            ("load-model", "Model file saved with --save-model to load instead of parsing",
+             cxxopts::value<std::string>())
+            ("socket", "Unix socket path", cxxopts::value<std::string>())
+            ("output-root", "Directory diagram requests may write output files under (default: working directory)",
+             cxxopts::value<std::string>())
+            ("q,query", "Send one JSON request to a running server and print the response",
+             cxxopts::value<std::string>())
+            ("h,help", "Print usage");
+
+        auto result = options.parse(argc, argv);
+
+        if (result.count("help")) {
+            std::cout << options.help() << std::endl;
+            return 0;
+        }
+
+        if (!result.count("socket")) {
+            std::cerr << "Error: Missing required argument --socket" << std::endl;
+            std::cout << options.help() << std::endl;
+            return 1;
+        }
+        std::string socketPath = result["socket"].as<std::string>();
+
+        // Client mode
+        if (result.count("query")) {
+            std::string response;
+            if (!cpp_diagram::QueryServer::query(socketPath, result["query"].as<std::string>(), response)) {
+                return 1;
+            }
+            std::cout << response << std::endl;
+            return response.rfind("{\"ok\":true", 0) == 0 ? 0 : 1;
+        }
+
+        cpp_diagram::QueryServer server;
+        if (result.count("output-root") && !server.setOutputRoot(result["output-root"].as<std::string>())) {
+            return 1;
+        }
+        if (result.count("load-model")) {
+            if (!server.loadModel(result["load-model"].as<std::string>())) {
+                std::cerr << "Error: Failed to load model" << std::endl;
+                return 1;
+            }
+        } else if (result.count("input")) {
+            if (!server.load(result["input"].as<std::vector<std::string>>())) {
+                std::cerr << "Error: Failed to parse input files" << std::endl;
+                return 1;
+            }
+        } else {
+            std::cerr << "Error: Missing required argument --input or --load-model" << std::endl;
+            std::cout << options.help() << std::endl;
+            return 1;
+        }
+
+        std::cout << "Listening on " << socketPath << std::endl;
+        return server.serve(socketPath) ? 0 : 1;
+
+    } catch (const cxxopts::OptionException& e) {
+        std::cerr << "Error parsing options: " << e.what() << std::endl;
+        return 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
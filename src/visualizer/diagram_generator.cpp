@@ -2,11 +2,77 @@
 #include "parser/ast_types.h"
 #include <graphviz/cgraph.h>
 #include <graphviz/gvc.h>
+#include <cstdio>
 #include <iostream>
 #include <fstream>
+#include <algorithm>
+#include <map>
 
 namespace cpp_diagram {
 
+namespace {
+
+std::string escapeHtml(const std::string& text) {
+    std::string escaped;
+    escaped.reserve(text.size());
+    for (char c : text) {
+        switch (c) {
+            case '<': escaped += "&lt;"; break;
+            case '>': escaped += "&gt;"; break;
+            case '&': escaped += "&amp;"; break;
+            case '"': escaped += "&quot;"; break;
+            default: escaped += c; break;
+        }
+    }
+    return escaped;
+}
+
+// Graphviz only treats a label as HTML if the string was interned as such
+void setHtmlLabel(Agraph_t* graph, void* object, const std::string& html) {
+    char* label = agstrdup_html(graph, html.c_str());
+    agsafeset(object, "label", label, "");
+    agstrfree(graph, label);
+}
+
+// Characters with a meaning in record labels
+std::string escapeRecord(const std::string& text) {
+    std::string escaped;
+    escaped.reserve(text.size());
+    for (char c : text) {
+        if (c == '{' || c == '}' || c == '|' || c == '<' || c == '>' || c == '"') {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+// Green for added, red and dashed for removed, orange for modified, gray for context
+void setChangeStyle(void* object, ChangeKind kind, bool isNode) {
+    const char* color = "gray60";
+    const char* fill = "white";
+    switch (kind) {
+        case ChangeKind::Added: color = "darkgreen"; fill = "palegreen"; break;
+        case ChangeKind::Removed: color = "red3"; fill = "mistyrose"; break;
+        case ChangeKind::Modified: color = "darkorange3"; fill = "lightgoldenrod1"; break;
+        case ChangeKind::Unchanged: break;
+    }
+    agsafeset(object, "color", color, "");
+    if (kind != ChangeKind::Unchanged) {
+        agsafeset(object, "penwidth", "2", "");
+    } else {
+        agsafeset(object, "fontcolor", "gray40", "");
+    }
+    if (isNode) {
+        agsafeset(object, "fillcolor", fill, "");
+        agsafeset(object, "style", kind == ChangeKind::Removed ? "filled,dashed" : "filled", "");
+    } else if (kind == ChangeKind::Removed) {
+        agsafeset(object, "style", "dashed", "");
+    }
+}
+
+} // namespace
+
 DiagramGenerator::DiagramGenerator() {
     gvc_ = gvContext();
 }
@@ -25,6 +91,39 @@ void DiagramGenerator::setOutputFormat(const std::string& format) {
     outputFormat_ = format;
 }
 
+void DiagramGenerator::setDetailLevel(int level, size_t memberLimit) {
+    detailLevel_ = std::clamp(level, 1, 3);
+    memberLimit_ = memberLimit;
+}
+
+void DiagramGenerator::setTracer(Tracer* tracer) {
+    tracer_ = tracer;
+}
+
+void DiagramGenerator::setTemplateCosts(const std::vector<TemplateInfo>& templates) {
+    templateCosts_.clear();
+    maxTemplateNodes_ = 0;
+    for (const auto& info : templates) {
+        templateCosts_[info.name] = info;
+        maxTemplateNodes_ = std::max(maxTemplateNodes_, info.astNodes);
+    }
+}
+
+void DiagramGenerator::setProfile(const ProfileData& profile, double pruneThreshold) {
+    profile_ = profile;
+    hasProfile_ = true;
+    pruneThreshold_ = pruneThreshold;
+}
+
+void DiagramGenerator::setPerfFindings(const std::vector<PerfLintEntry>& entries) {
+    perfFindings_.clear();
+    for (const auto& entry : entries) {
+        if (!entry.isClass) {
+            perfFindings_[entry.owner].push_back(entry.finding);
+        }
+    }
+}
+
 bool DiagramGenerator::generateClassDiagram(const std::vector<ClassInfo>& classes,
                                           const std::vector<RelationshipInfo>& relationships,
                                           const std::string& outputFile) {
@@ -40,12 +139,7 @@ bool DiagramGenerator::generateClassDiagram(const std::vector<ClassInfo>& classe
     agsafeset(graph, "ranksep", "0.5", "");
 
     // Layout and render the graph
-    gvLayout(gvc_, graph, "dot");
-    gvRenderFilename(gvc_, graph, outputFormat_.c_str(), outputFile.c_str());
-    gvFreeLayout(gvc_, graph);
-    agclose(graph);
-
-    return true;
+    return layoutAndRender(graph, outputFile);
 }
 
 bool DiagramGenerator::generateCallGraph(const std::vector<FunctionInfo>& functions,
@@ -62,38 +156,110 @@ bool DiagramGenerator::generateCallGraph(const std::vector<FunctionInfo>& functi
     agsafeset(graph, "ranksep", "0.5", "");
 
     // Layout and render the graph
-    gvLayout(gvc_, graph, "dot");
-    gvRenderFilename(gvc_, graph, outputFormat_.c_str(), outputFile.c_str());
-    gvFreeLayout(gvc_, graph);
-    agclose(graph);
-
-    return true;
+    return layoutAndRender(graph, outputFile);
 }
 
-bool DiagramGenerator::generateComponentDiagram(const std::vector<ClassInfo>& classes,
+bool DiagramGenerator::generateComponentDiagram(const ComponentGraph& components,
                                               const std::string& outputFile) {
-    Agraph_t* graph = createComponentGraph(classes);
+    Agraph_t* graph = createComponentGraph(components);
+    if (!graph) {
+        return false;
+    }
+
+    // Set graph attributes; edges carry weight labels, which ortho cannot place
+    agsafeset(graph, "rankdir", "TB", "");
+    agsafeset(graph, "nodesep", "0.5", "");
+    agsafeset(graph, "ranksep", "0.7", "");
+
+    // Layout and render the graph
+    return layoutAndRender(graph, outputFile);
+}
+
+bool DiagramGenerator::generateLayoutDiagram(const std::vector<ClassLayout>& layouts,
+                                           const std::string& outputFile) {
+    Agraph_t* graph = createLayoutGraph(layouts);
+    if (!graph) {
+        return false;
+    }
+
+    // Set graph attributes
+    agsafeset(graph, "rankdir", "LR", "");
+    agsafeset(graph, "nodesep", "0.5", "");
+    agsafeset(graph, "ranksep", "0.5", "");
+
+    // Layout and render the graph
+    return layoutAndRender(graph, outputFile);
+}
+
+bool DiagramGenerator::generateConcurrencyDiagram(const std::vector<ConcurrencyLayout>& layouts,
+                                                  const std::string& outputFile) {
+    Agraph_t* graph = createConcurrencyGraph(layouts);
+    if (!graph) {
+        return false;
+    }
+
+    // Set graph attributes
+    agsafeset(graph, "rankdir", "LR", "");
+    agsafeset(graph, "nodesep", "0.5", "");
+    agsafeset(graph, "ranksep", "0.5", "");
+
+    // Layout and render the graph
+    return layoutAndRender(graph, outputFile);
+}
+
+bool DiagramGenerator::generateIncludeDiagram(const std::vector<HeaderInfo>& headers,
+                                            const std::string& outputFile) {
+    Agraph_t* graph = createIncludeGraph(headers);
+    if (!graph) {
+        return false;
+    }
+
+    // Set graph attributes
+    agsafeset(graph, "rankdir", "LR", "");
+    agsafeset(graph, "nodesep", "0.3", "");
+    agsafeset(graph, "ranksep", "0.8", "");
+
+    // Layout and render the graph
+    return layoutAndRender(graph, outputFile);
+}
+
+bool DiagramGenerator::generateDiffDiagram(const ModelDiff& diff, const std::string& outputFile) {
+    Agraph_t* graph = createDiffGraph(diff);
     if (!graph) {
         return false;
     }
 
     // Set graph attributes
     agsafeset(graph, "rankdir", "TB", "");
-    agsafeset(graph, "splines", "ortho", "");
     agsafeset(graph, "nodesep", "0.5", "");
     agsafeset(graph, "ranksep", "0.5", "");
 
     // Layout and render the graph
-    gvLayout(gvc_, graph, "dot");
-    gvRenderFilename(gvc_, graph, outputFormat_.c_str(), outputFile.c_str());
+    return layoutAndRender(graph, outputFile);
+}
+
+bool DiagramGenerator::layoutAndRender(Agraph_t* graph, const std::string& outputFile) {
+    {
+        TraceScope scope(tracer_, "gvLayout", "layout");
+        scope.setCounter("nodes", agnnodes(graph));
+        scope.setCounter("edges", agnedges(graph));
+        gvLayout(gvc_, graph, "dot");
+    }
+
+    bool rendered = false;
+    {
+        TraceScope scope(tracer_, "gvRenderFilename", "render");
+        rendered = gvRenderFilename(gvc_, graph, outputFormat_.c_str(), outputFile.c_str()) == 0;
+    }
+
     gvFreeLayout(gvc_, graph);
     agclose(graph);
-
-    return true;
+    return rendered;
 }
 
 Agraph_t* DiagramGenerator::createClassGraph(const std::vector<ClassInfo>& classes,
                                            const std::vector<RelationshipInfo>& relationships) {
+    TraceScope scope(tracer_, "createClassGraph", "graph");
     Agraph_t* graph = agopen("ClassDiagram", Agdirected, nullptr);
     if (!graph) {
         return nullptr;
@@ -122,14 +288,22 @@ Agraph_t* DiagramGenerator::createClassGraph(const std::vector<ClassInfo>& class
 }
 
 Agraph_t* DiagramGenerator::createCallGraph(const std::vector<FunctionInfo>& functions) {
+    TraceScope scope(tracer_, "createCallGraph", "graph");
     Agraph_t* graph = agopen("CallGraph", Agdirected, nullptr);
     if (!graph) {
         return nullptr;
     }
 
-    // Create nodes for each function
+    // Create nodes for each function, pruning cold ones before layout
     std::map<std::string, Agnode_t*> functionNodes;
     for (const auto& functionInfo : functions) {
+        if (hasProfile_ && pruneThreshold_ > 0.0) {
+            auto it = profile_.functions.find(functionInfo.qualifiedName);
+            int64_t samples = it != profile_.functions.end() ? it->second.inclusiveSamples : 0;
+            if (profile_.share(samples) < pruneThreshold_) {
+                continue;
+            }
+        }
         Agnode_t* node = createFunctionNode(graph, functionInfo);
         if (node) {
             functionNodes[functionInfo.qualifiedName] = node;
@@ -146,27 +320,275 @@ Agraph_t* DiagramGenerator::createCallGraph(const std::vector<FunctionInfo>& fun
                     Agedge_t* edge = agedge(graph, fromIt->second, toIt->second, nullptr, 1);
                     if (edge) {
                         agsafeset(edge, "label", "calls", "");
+                        if (hasProfile_) {
+                            auto callIt = profile_.calls.find({functionInfo.qualifiedName, calledFunction});
+                            applyProfileCost(edge, callIt != profile_.calls.end() ? callIt->second : 0);
+                        }
                     }
                 }
             }
         }
     }
 
+    // Sampled calls the parser did not see, e.g. through virtual dispatch
+    // or function pointers
+    if (hasProfile_) {
+        for (const auto& [call, samples] : profile_.calls) {
+            auto fromIt = functionNodes.find(call.first);
+            auto toIt = functionNodes.find(call.second);
+            if (fromIt == functionNodes.end() || toIt == functionNodes.end() ||
+                agedge(graph, fromIt->second, toIt->second, nullptr, 0)) {
+                continue;
+            }
+            Agedge_t* edge = agedge(graph, fromIt->second, toIt->second, nullptr, 1);
+            if (edge) {
+                agsafeset(edge, "label", "sampled", "");
+                agsafeset(edge, "style", "dashed", "");
+                applyProfileCost(edge, samples);
+            }
+        }
+    }
+
+    return graph;
+}
+
+Agraph_t* DiagramGenerator::createDiffGraph(const ModelDiff& diff) {
+    TraceScope scope(tracer_, "createDiffGraph", "graph");
+    Agraph_t* graph = agopen("DiffDiagram", Agdirected, nullptr);
+    if (!graph) {
+        return nullptr;
+    }
+
+    // Method changes are listed inside their class
+    std::map<std::string, std::string> methodLines;
+    for (const auto& change : diff.methods) {
+        const char* symbol = change.kind == ChangeKind::Added ? "+ " :
+                             change.kind == ChangeKind::Removed ? "- " : "~ ";
+        std::string name = change.name.compare(0, change.owner.size() + 2, change.owner + "::") == 0
+                           ? change.name.substr(change.owner.size() + 2) : change.name;
+        methodLines[change.owner] += symbol + escapeRecord(name + change.parameters) + "\\l";
+    }
+
+    // Classes and functions get separate namespaces so names cannot collide
+    std::map<std::string, Agnode_t*> classNodes;
+    for (const auto& change : diff.classes) {
+        std::string id = "class " + change.name;
+        Agnode_t* node = agnode(graph, id.c_str(), 1);
+        if (!node) continue;
+        agsafeset(node, "shape", "record", "");
+        std::string label = "{ " + escapeRecord(change.name);
+        if (!change.details.empty()) {
+            label += "\\n(";
+            for (size_t i = 0; i < change.details.size(); ++i) {
+                if (i > 0) label += ", ";
+                label += change.details[i];
+            }
+            label += ")";
+        }
+        auto linesIt = methodLines.find(change.name);
+        if (linesIt != methodLines.end()) {
+            label += " | " + linesIt->second;
+        }
+        label += " }";
+        agsafeset(node, "label", label.c_str(), "");
+        setChangeStyle(node, change.kind, true);
+        classNodes[change.name] = node;
+    }
+
+    for (const auto& change : diff.relationships) {
+        auto fromIt = classNodes.find(change.from);
+        auto toIt = classNodes.find(change.to);
+        if (fromIt == classNodes.end() || toIt == classNodes.end()) continue;
+        Agedge_t* edge = agedge(graph, fromIt->second, toIt->second, nullptr, 1);
+        if (edge) {
+            agsafeset(edge, "label", change.label.c_str(), "");
+            setChangeStyle(edge, change.kind, false);
+        }
+    }
+
+    // Overloads share a node; the first entry decides its style
+    std::map<std::string, Agnode_t*> functionNodes;
+    for (const auto& change : diff.functions) {
+        if (functionNodes.count(change.name)) continue;
+        std::string id = "function " + change.name;
+        Agnode_t* node = agnode(graph, id.c_str(), 1);
+        if (!node) continue;
+        agsafeset(node, "shape", "box", "");
+        agsafeset(node, "label", (change.name + change.parameters).c_str(), "");
+        setChangeStyle(node, change.kind, true);
+        functionNodes[change.name] = node;
+    }
+
+    for (const auto& change : diff.calls) {
+        auto fromIt = functionNodes.find(change.from);
+        auto toIt = functionNodes.find(change.to);
+        if (fromIt == functionNodes.end() || toIt == functionNodes.end()) continue;
+        Agedge_t* edge = agedge(graph, fromIt->second, toIt->second, nullptr, 1);
+        if (edge) {
+            agsafeset(edge, "label", change.label.c_str(), "");
+            setChangeStyle(edge, change.kind, false);
+        }
+    }
+
     return graph;
 }
 
-Agraph_t* DiagramGenerator::createComponentGraph(const std::vector<ClassInfo>& classes) {
+Agraph_t* DiagramGenerator::createComponentGraph(const ComponentGraph& components) {
+    TraceScope scope(tracer_, "createComponentGraph", "graph");
     Agraph_t* graph = agopen("ComponentDiagram", Agdirected, nullptr);
     if (!graph) {
         return nullptr;
     }
 
-    // Create nodes for each class as components
-    for (const auto& classInfo : classes) {
-        Agnode_t* node = agnode(graph, classInfo.qualifiedName.c_str(), 1);
-        if (node) {
-            agsafeset(node, "shape", "component", "");
-            agsafeset(node, "label", classInfo.name.c_str(), "");
+    // Components of one layer share a rank
+    std::map<int, Agraph_t*> layers;
+    std::vector<Agnode_t*> nodes(components.components.size(), nullptr);
+    for (size_t id = 0; id < components.components.size(); ++id) {
+        const Component& component = components.components[id];
+        Agraph_t* parent = graph;
+        if (component.layer >= 0) {
+            Agraph_t*& layer = layers[component.layer];
+            if (!layer) {
+                std::string name = "layer" + std::to_string(component.layer);
+                layer = agsubg(graph, name.c_str(), 1);
+                agsafeset(layer, "rank", "same", "");
+            }
+            parent = layer;
+        }
+
+        Agnode_t* node = agnode(parent, component.name.c_str(), 1);
+        if (!node) continue;
+        std::string label = component.name + "\\n" + std::to_string(component.classes) + " classes, " +
+                            std::to_string(component.functions) + " functions";
+        agsafeset(node, "shape", "component", "");
+        agsafeset(node, "style", "filled", "");
+        agsafeset(node, "fillcolor", "lightblue", "");
+        agsafeset(node, "label", label.c_str(), "");
+        nodes[id] = node;
+    }
+
+    // Components on a cycle are shaded; cycle edges and layering violations are red
+    for (const auto& cycle : components.cycles) {
+        for (size_t id : cycle) {
+            if (nodes[id]) agsafeset(nodes[id], "fillcolor", "mistyrose", "");
+        }
+    }
+
+    int maxWeight = 1;
+    for (const auto& dependency : components.dependencies) {
+        maxWeight = std::max(maxWeight, dependency.weight());
+    }
+    for (const auto& dependency : components.dependencies) {
+        if (!nodes[dependency.from] || !nodes[dependency.to]) continue;
+        Agedge_t* edge = agedge(graph, nodes[dependency.from], nodes[dependency.to], nullptr, 1);
+        if (!edge) continue;
+        std::string penwidth = std::to_string(1.0 + 4.0 * dependency.weight() / maxWeight);
+        agsafeset(edge, "penwidth", penwidth.c_str(), "");
+        agsafeset(edge, "label", std::to_string(dependency.weight()).c_str(), "");
+        if (dependency.violatesLayering) {
+            agsafeset(edge, "color", "red", "");
+            agsafeset(edge, "style", "bold", "");
+            agsafeset(edge, "label", (std::to_string(dependency.weight()) + " (layering)").c_str(), "");
+        } else if (dependency.inCycle) {
+            agsafeset(edge, "color", "orangered", "");
+        }
+    }
+
+    return graph;
+}
+
+Agraph_t* DiagramGenerator::createLayoutGraph(const std::vector<ClassLayout>& layouts) {
+    TraceScope scope(tracer_, "createLayoutGraph", "graph");
+    Agraph_t* graph = agopen("LayoutDiagram", Agdirected, nullptr);
+    if (!graph) {
+        return nullptr;
+    }
+
+    // One unconnected table per class
+    for (const auto& layout : layouts) {
+        createLayoutNode(graph, layout);
+    }
+
+    return graph;
+}
+
+Agraph_t* DiagramGenerator::createConcurrencyGraph(const std::vector<ConcurrencyLayout>& layouts) {
+    TraceScope scope(tracer_, "createConcurrencyGraph", "graph");
+    Agraph_t* graph = agopen("ConcurrencyDiagram", Agdirected, nullptr);
+    if (!graph) {
+        return nullptr;
+    }
+
+    // One unconnected table per class
+    for (const auto& layout : layouts) {
+        createConcurrencyNode(graph, layout);
+    }
+
+    return graph;
+}
+
+Agraph_t* DiagramGenerator::createIncludeGraph(const std::vector<HeaderInfo>& headers) {
+    TraceScope scope(tracer_, "createIncludeGraph", "graph");
+    Agraph_t* graph = agopen("IncludeGraph", Agdirected, nullptr);
+    if (!graph) {
+        return nullptr;
+    }
+
+    std::map<std::string, const HeaderInfo*> byPath;
+    int64_t maxTokens = 1;
+    for (const auto& header : headers) {
+        byPath[header.path] = &header;
+        if (!header.isMainFile) {
+            maxTokens = std::max(maxTokens, header.inclusiveTokens);
+        }
+    }
+
+    // Keep project files plus the system headers they include directly;
+    // the inside of the standard library is rarely actionable
+    auto isShown = [&byPath](const HeaderInfo& header) {
+        if (!header.isSystem) return true;
+        for (const auto& includer : header.includedBy) {
+            auto it = byPath.find(includer);
+            if (it != byPath.end() && !it->second->isSystem) return true;
+        }
+        return false;
+    };
+
+    std::map<std::string, Agnode_t*> headerNodes;
+    for (const auto& header : headers) {
+        if (!isShown(header)) continue;
+
+        Agnode_t* node = agnode(graph, header.path.c_str(), 1);
+        if (!node) continue;
+        headerNodes[header.path] = node;
+
+        std::string name = header.path.substr(header.path.find_last_of("/\\") + 1);
+        std::string label = name + "\\n" + std::to_string(header.inclusiveTokens) + " tokens";
+        if (!header.isMainFile) {
+            label += " x" + std::to_string(header.translationUnits) + " TUs";
+        }
+
+        agsafeset(node, "shape", header.isMainFile ? "box" : "note", "");
+        agsafeset(node, "style", "filled", "");
+        agsafeset(node, "label", label.c_str(), "");
+        if (header.isMainFile) {
+            agsafeset(node, "fillcolor", "lightblue", "");
+        } else {
+            // Shade from white to red by share of the costliest header
+            int shade = 1 + static_cast<int>(8.0 * header.inclusiveTokens / maxTokens);
+            std::string color = "/reds9/" + std::to_string(std::min(shade, 9));
+            agsafeset(node, "fillcolor", color.c_str(), "");
+        }
+    }
+
+    for (const auto& header : headers) {
+        auto toIt = headerNodes.find(header.path);
+        if (toIt == headerNodes.end()) continue;
+        for (const auto& includer : header.includedBy) {
+            auto fromIt = headerNodes.find(includer);
+            if (fromIt != headerNodes.end() && !byPath[includer]->isSystem) {
+                agedge(graph, fromIt->second, toIt->second, nullptr, 1);
+            }
         }
     }
 
@@ -194,38 +616,61 @@ Agnode_t* DiagramGenerator::createClassNode(Agraph_t* graph, const ClassInfo& cl
         }
         label += "\\>";
     }
-    label += " | ";
+    applyTemplateCost(node, classInfo.qualifiedName, label);
+
+    // Small labels keep dot's node sizing and edge routing cheap on large
+    // diagrams: level 1 drops the members, level 2 the non-public ones
+    if (detailLevel_ <= 1) {
+        label += " }";
+        agsafeset(node, "label", label.c_str(), "");
+        return node;
+    }
+    auto accessSymbol = [](AccessSpecifier access) {
+        switch (access) {
+            case AccessSpecifier::Public: return "+";
+            case AccessSpecifier::Protected: return "#";
+            case AccessSpecifier::Private: return "-";
+        }
+        return "";
+    };
+    bool everyMember = detailLevel_ >= 3;
 
-    // Add fields
+    std::vector<std::string> rows;
     for (const auto& field : classInfo.fields) {
-        std::string accessSymbol;
-        switch (field.access) {
-            case AccessSpecifier::Public: accessSymbol = "+"; break;
-            case AccessSpecifier::Protected: accessSymbol = "#"; break;
-            case AccessSpecifier::Private: accessSymbol = "-"; break;
-        }
-        label += accessSymbol + field.name + " : " + field.type + "\\l";
+        if (!everyMember && field.access != AccessSpecifier::Public) continue;
+        rows.push_back(accessSymbol(field.access) + field.name + " : " + field.type);
     }
-
-    // Add methods
     for (const auto& method : classInfo.methods) {
-        std::string accessSymbol;
-        switch (method.access) {
-            case AccessSpecifier::Public: accessSymbol = "+"; break;
-            case AccessSpecifier::Protected: accessSymbol = "#"; break;
-            case AccessSpecifier::Private: accessSymbol = "-"; break;
-        }
-        label += accessSymbol + method.name + "(";
+        if (!everyMember && method.access != AccessSpecifier::Public) continue;
+        std::string row = accessSymbol(method.access) + method.name + "(";
         for (size_t i = 0; i < method.parameters.size(); ++i) {
-            if (i > 0) label += ", ";
-            label += method.parameters[i];
+            if (i > 0) row += ", ";
+            row += method.parameters[i];
+        }
+        row += ") : " + method.returnType;
+        if (method.isVirtual) row += " (virtual)";
+        if (method.isPureVirtual) row += " = 0";
+        if (method.isStatic) row += " (static)";
+        if (method.isConst) row += " const";
+        rows.push_back(std::move(row));
+    }
+
+    size_t shown = rows.size();
+    if (memberLimit_ > 0 && shown > memberLimit_) {
+        shown = memberLimit_;
+    }
+    label += " | ";
+    for (size_t i = 0; i < shown; ++i) {
+        label += rows[i] + "\\l";
+    }
+    if (shown < rows.size()) {
+        // The folded members stay reachable as the node's hover text in SVG
+        label += "... " + std::to_string(rows.size() - shown) + " more\\l";
+        std::string tooltip = classInfo.qualifiedName;
+        for (const auto& row : rows) {
+            tooltip += "\n" + row;
         }
-        label += ") : " + method.returnType;
-        if (method.isVirtual) label += " (virtual)";
-        if (method.isPureVirtual) label += " = 0";
-        if (method.isStatic) label += " (static)";
-        if (method.isConst) label += " const";
-        label += "\\l";
+        agsafeset(node, "tooltip", tooltip.c_str(), "");
     }
 
     label += "}";
@@ -245,20 +690,32 @@ Agnode_t* DiagramGenerator::createFunctionNode(Agraph_t* graph, const FunctionIn
     agsafeset(node, "style", "filled", "");
     agsafeset(node, "fillcolor", "lightblue", "");
 
-    // Create label with function signature
-    std::string label = functionInfo.name + "(";
-    for (size_t i = 0; i < functionInfo.parameters.size(); ++i) {
-        if (i > 0) label += ", ";
-        label += functionInfo.parameters[i];
+    // Create label with function signature; names only at detail level 1
+    std::string label = functionInfo.name;
+    if (detailLevel_ > 1) {
+        label += "(";
+        for (size_t i = 0; i < functionInfo.parameters.size(); ++i) {
+            if (i > 0) label += ", ";
+            label += functionInfo.parameters[i];
+        }
+        label += ") : " + functionInfo.returnType;
     }
-    label += ") : " + functionInfo.returnType;
     if (functionInfo.isTemplate) {
-        label += "\\<";
-        for (size_t i = 0; i < functionInfo.templateParameters.size(); ++i) {
-            if (i > 0) label += ", ";
-            label += functionInfo.templateParameters[i];
+        if (detailLevel_ > 1) {
+            label += "\\<";
+            for (size_t i = 0; i < functionInfo.templateParameters.size(); ++i) {
+                if (i > 0) label += ", ";
+                label += functionInfo.templateParameters[i];
+            }
+            label += "\\>";
         }
-        label += "\\>";
+        applyTemplateCost(node, functionInfo.qualifiedName, label);
+    }
+    if (hasProfile_) {
+        applyProfileCost(node, functionInfo.qualifiedName, label);
+    }
+    if (!perfFindings_.empty()) {
+        applyPerfFindings(node, functionInfo.qualifiedName, label);
     }
 
     agsafeset(node, "label", label.c_str(), "");
@@ -266,6 +723,204 @@ Agnode_t* DiagramGenerator::createFunctionNode(Agraph_t* graph, const FunctionIn
     return node;
 }
 
+void DiagramGenerator::applyTemplateCost(Agnode_t* node, const std::string& qualifiedName,
+                                         std::string& label) {
+    auto it = templateCosts_.find(qualifiedName);
+    if (it == templateCosts_.end() || maxTemplateNodes_ == 0) {
+        return;
+    }
+
+    // Shade from light to dark orange by share of the heaviest template
+    const TemplateInfo& info = it->second;
+    int shade = 1 + static_cast<int>(8.0 * info.astNodes / maxTemplateNodes_);
+    std::string color = "/oranges9/" + std::to_string(std::min(shade, 9));
+    agsafeset(node, "fillcolor", color.c_str(), "");
+    label += "\\n[" + std::to_string(info.instantiations) + " inst, " +
+             std::to_string(info.astNodes) + " nodes]";
+}
+
+void DiagramGenerator::applyProfileCost(Agnode_t* node, const std::string& qualifiedName,
+                                        std::string& label) {
+    auto it = profile_.functions.find(qualifiedName);
+    if (it == profile_.functions.end()) {
+        agsafeset(node, "fillcolor", "white", "");
+        agsafeset(node, "fontcolor", "gray50", "");
+        return;
+    }
+
+    // Shade by inclusive share, grow border and font by self share
+    double inclusive = profile_.share(it->second.inclusiveSamples);
+    double self = profile_.share(it->second.selfSamples);
+    int shade = std::min(9, 1 + static_cast<int>(8.0 * inclusive));
+    std::string color = "/reds9/" + std::to_string(shade);
+    agsafeset(node, "fillcolor", color.c_str(), "");
+    if (shade >= 7) {
+        agsafeset(node, "fontcolor", "white", "");
+    }
+    agsafeset(node, "penwidth", std::to_string(1.0 + 8.0 * self).c_str(), "");
+    agsafeset(node, "fontsize", std::to_string(static_cast<int>(14 + 16 * self)).c_str(), "");
+
+    char costs[64];
+    snprintf(costs, sizeof(costs), "\\n[incl %.1f%%, self %.1f%%]", inclusive * 100.0, self * 100.0);
+    label += costs;
+}
+
+void DiagramGenerator::applyProfileCost(Agedge_t* edge, int64_t samples) {
+    if (samples == 0) {
+        agsafeset(edge, "color", "gray70", "");
+        return;
+    }
+    double share = profile_.share(samples);
+    int shade = std::min(9, 3 + static_cast<int>(6.0 * share));
+    std::string color = "/reds9/" + std::to_string(shade);
+    agsafeset(edge, "color", color.c_str(), "");
+    agsafeset(edge, "penwidth", std::to_string(1.0 + 8.0 * share).c_str(), "");
+    char costs[32];
+    snprintf(costs, sizeof(costs), "%.1f%%", share * 100.0);
+    agsafeset(edge, "label", costs, "");
+}
+
+void DiagramGenerator::applyPerfFindings(Agnode_t* node, const std::string& qualifiedName,
+                                         std::string& label) {
+    auto it = perfFindings_.find(qualifiedName);
+    if (it == perfFindings_.end()) {
+        return;
+    }
+
+    // A double orange outline leaves the fill to the template and profile shading
+    agsafeset(node, "color", "darkorange", "");
+    agsafeset(node, "peripheries", "2", "");
+
+    std::vector<PerfIssue> issues;
+    std::string tooltip;
+    for (const auto& finding : it->second) {
+        if (std::find(issues.begin(), issues.end(), finding.issue) == issues.end()) {
+            issues.push_back(finding.issue);
+        }
+        if (!tooltip.empty()) tooltip += "\n";
+        tooltip += finding.message;
+    }
+    label += "\\l[lint:";
+    for (size_t i = 0; i < issues.size(); ++i) {
+        label += (i > 0 ? ", " : " ") + std::string(PerfLintAnalyzer::issueName(issues[i]));
+    }
+    label += "]";
+    agsafeset(node, "tooltip", tooltip.c_str(), "");
+}
+
+Agnode_t* DiagramGenerator::createLayoutNode(Agraph_t* graph, const ClassLayout& layout) {
+    Agnode_t* node = agnode(graph, layout.className.c_str(), 1);
+    if (!node) {
+        return nullptr;
+    }
+
+    agsafeset(node, "shape", "plaintext", "");
+
+    // Header row, then one row per slot with cache line boundaries in between
+    std::string html = "<TABLE BORDER=\"0\" CELLBORDER=\"1\" CELLSPACING=\"0\">";
+    html += "<TR><TD COLSPAN=\"3\" BGCOLOR=\"lightgray\"><B>" + escapeHtml(layout.className) +
+            "</B> (" + std::to_string(layout.size) + " bytes, " +
+            std::to_string(layout.paddingBytes) + " padding)</TD></TR>";
+
+    int64_t nextBoundary = LayoutAnalyzer::kCacheLineSize;
+    for (const auto& slot : layout.slots) {
+        while (slot.offset >= nextBoundary) {
+            html += "<TR><TD COLSPAN=\"3\" BGCOLOR=\"lightblue\">cache line " +
+                    std::to_string(nextBoundary / LayoutAnalyzer::kCacheLineSize) +
+                    " @ " + std::to_string(nextBoundary) + "</TD></TR>";
+            nextBoundary += LayoutAnalyzer::kCacheLineSize;
+        }
+
+        const char* color = "white";
+        if (slot.kind == LayoutSlotKind::Padding) color = "lightpink";
+        else if (slot.kind == LayoutSlotKind::Header) color = "lightyellow";
+        else if (slot.kind == LayoutSlotKind::VirtualBase) color = "khaki";
+        else if (slot.straddlesCacheLine) color = "orange";
+
+        html += "<TR><TD BGCOLOR=\"" + std::string(color) + "\" ALIGN=\"RIGHT\">" +
+                std::to_string(slot.offset) + "</TD><TD BGCOLOR=\"" + color + "\" ALIGN=\"RIGHT\">" +
+                std::to_string(slot.size) + "</TD><TD BGCOLOR=\"" + color + "\" ALIGN=\"LEFT\">" +
+                escapeHtml(slot.name);
+        if (!slot.type.empty()) {
+            html += " : " + escapeHtml(slot.type);
+        }
+        html += "</TD></TR>";
+    }
+
+    if (!layout.suggestedOrder.empty()) {
+        std::string order;
+        for (size_t i = 0; i < layout.suggestedOrder.size(); ++i) {
+            if (i > 0) order += ", ";
+            order += layout.suggestedOrder[i];
+        }
+        html += "<TR><TD COLSPAN=\"3\" BGCOLOR=\"palegreen\">reorder to " +
+                std::to_string(layout.suggestedSize) + " bytes: " + escapeHtml(order) + "</TD></TR>";
+    }
+    html += "</TABLE>";
+
+    setHtmlLabel(graph, node, html);
+    return node;
+}
+
+Agnode_t* DiagramGenerator::createConcurrencyNode(Agraph_t* graph, const ConcurrencyLayout& layout) {
+    Agnode_t* node = agnode(graph, layout.className.c_str(), 1);
+    if (!node) {
+        return nullptr;
+    }
+
+    agsafeset(node, "shape", "plaintext", "");
+
+    // Fields that take part in a conflict, and the lines that carry one
+    std::vector<bool> conflicted(layout.fields.size(), false);
+    std::vector<int64_t> hotLines;
+    for (const auto& conflict : layout.conflicts) {
+        conflicted[conflict.first] = conflicted[conflict.second] = true;
+        hotLines.push_back(conflict.cacheLine);
+    }
+    for (size_t index : layout.splitFields) {
+        conflicted[index] = true;
+    }
+
+    std::string html = "<TABLE BORDER=\"0\" CELLBORDER=\"1\" CELLSPACING=\"0\">";
+    html += "<TR><TD COLSPAN=\"4\" BGCOLOR=\"lightgray\"><B>" + escapeHtml(layout.className) +
+            "</B> (" + std::to_string(layout.size) + " bytes, " +
+            std::to_string(layout.conflicts.size()) + " conflicts)</TD></TR>";
+
+    int64_t line = -1;
+    for (size_t i = 0; i < layout.fields.size(); ++i) {
+        const ConcurrencyField& field = layout.fields[i];
+        while (line < field.firstLine) {
+            ++line;
+            bool shared = std::find(hotLines.begin(), hotLines.end(), line) != hotLines.end();
+            html += "<TR><TD COLSPAN=\"4\" BGCOLOR=\"" + std::string(shared ? "salmon" : "lightblue") +
+                    "\">cache line " + std::to_string(line) + " @ " +
+                    std::to_string(line * ConcurrencyAnalyzer::kCacheLineSize) +
+                    (shared ? " - false sharing" : "") + "</TD></TR>";
+        }
+
+        const char* color = "white";
+        if (conflicted[i]) color = "tomato";
+        else if (field.sync == SyncKind::Atomic) color = "lightskyblue";
+        else if (field.sync != SyncKind::None) color = "plum";
+        else if (field.isContended) color = "khaki";
+
+        std::string notes = ConcurrencyAnalyzer::syncName(field.sync);
+        if (field.writeSites > 0) {
+            notes += (notes.empty() ? "" : ", ") + std::to_string(field.writeSites) +
+                     (field.writeSites == 1 ? " write" : " writes");
+        }
+        html += "<TR><TD BGCOLOR=\"" + std::string(color) + "\" ALIGN=\"RIGHT\">" +
+                std::to_string(field.offset) + "</TD><TD BGCOLOR=\"" + color + "\" ALIGN=\"RIGHT\">" +
+                std::to_string(field.size) + "</TD><TD BGCOLOR=\"" + color + "\" ALIGN=\"LEFT\">" +
+                escapeHtml(field.name) + " : " + escapeHtml(field.type) + "</TD><TD BGCOLOR=\"" + color +
+                "\" ALIGN=\"LEFT\">" + escapeHtml(notes) + "</TD></TR>";
+    }
+    html += "</TABLE>";
+
+    setHtmlLabel(graph, node, html);
+    return node;
+}
+
 Agedge_t* DiagramGenerator::createRelationshipEdge(Agraph_t* graph, Agnode_t* from, Agnode_t* to,
                                                 const RelationshipInfo& relationship) {
     Agedge_t* edge = agedge(graph, from, to, nullptr, 1);
@@ -0,0 +1,24 @@
+#include "../core/engine.h"
+
+class App {
+public:
+    App() : engine_(&config_) {
+        config_.owner = this;
+    }
+
+    void run() {
+        for (int i = 0; i < 3; ++i) {
+            engine_.tick();
+        }
+    }
+
+private:
+    Config config_;
+    Engine engine_;
+};
+
+int main() {
+    App app;
+    app.run();
+    return 0;
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "../util/config.h"
+
+class Engine {
+public:
+    explicit Engine(Config* config) : config_(config) {}
+
+    void tick() {
+        ticks_ += clampRate(config_->tickRate);
+    }
+
+private:
+    Config* config_;
+    int ticks_ = 0;
+};
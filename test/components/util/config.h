@@ -0,0 +1,16 @@
+#pragma once
+
+#include <string>
+
+class App;
+
+// Settings shared by every layer
+struct Config {
+    std::string name;
+    int tickRate = 60;
+    App* owner = nullptr;  // reaches up into the app layer
+};
+
+inline int clampRate(int rate) {
+    return rate < 1 ? 1 : rate;
+}
@@ -0,0 +1,61 @@
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+// Two counters bumped by different threads share one cache line, and the
+// queue's lock sits next to the fields producers write on every push
+struct Counters {
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+};
+
+class WorkQueue {
+public:
+    void push(int item) {
+        std::lock_guard<std::mutex> guard(mutex_);
+        tail_ = item;
+        ++size_;
+        ready_.notify_one();
+    }
+
+    int pop() {
+        std::unique_lock<std::mutex> guard(mutex_);
+        ready_.wait(guard, [this] { return size_ > 0; });
+        --size_;
+        return tail_;
+    }
+
+private:
+    std::mutex mutex_;
+    int tail_ = 0;
+    int size_ = 0;
+    std::condition_variable ready_;
+    std::string name_;
+};
+
+// The fix: every contended member on its own cache line
+struct PaddedCounters {
+    alignas(64) std::atomic<uint64_t> hits{0};
+    alignas(64) std::atomic<uint64_t> misses{0};
+};
+
+void record(Counters& counters, PaddedCounters& padded, bool hit) {
+    if (hit) {
+        counters.hits.fetch_add(1, std::memory_order_relaxed);
+        padded.hits.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        ++counters.misses;
+        ++padded.misses;
+    }
+}
+
+int main() {
+    Counters counters;
+    PaddedCounters padded;
+    WorkQueue queue;
+    queue.push(1);
+    record(counters, padded, queue.pop() == 1);
+    return 0;
+}
@@ -125,4 +125,114 @@ public:
             observer->update(message);
         }
     }
-}; 
\ No newline at end of file
+}; 
+
+// Visitor pattern
+class Circle;
+class Square;
+
+class ShapeVisitor {
+public:
+    virtual ~ShapeVisitor() = default;
+    virtual void visit(const Circle& circle) = 0;
+    virtual void visit(const Square& square) = 0;
+};
+
+class VisitableShape {
+public:
+    virtual ~VisitableShape() = default;
+    virtual void accept(ShapeVisitor& visitor) const = 0;
+};
+
+class Square : public VisitableShape {
+private:
+    double side;
+
+public:
+    explicit Square(double side) : side(side) {}
+
+    void accept(ShapeVisitor& visitor) const override {
+        visitor.visit(*this);
+    }
+};
+
+// Composite pattern
+class Group : public Shape {
+private:
+    std::vector<std::unique_ptr<Shape>> children;
+
+public:
+    void add(std::unique_ptr<Shape> child) {
+        children.push_back(std::move(child));
+    }
+
+    double getArea() const override {
+        double area = 0.0;
+        for (const auto& child : children) {
+            area += child->getArea();
+        }
+        return area;
+    }
+};
+
+// CRTP
+template<typename Derived>
+class Comparable {
+public:
+    bool operator!=(const Derived& other) const {
+        return !(static_cast<const Derived&>(*this) == other);
+    }
+};
+
+class Version : public Comparable<Version> {
+private:
+    int number;
+
+public:
+    explicit Version(int number) : number(number) {}
+
+    bool operator==(const Version& other) const {
+        return number == other.number;
+    }
+};
+
+// pImpl idiom
+class Connection {
+public:
+    Connection();
+    ~Connection();
+    void send(const std::string& data);
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+};
+
+// Poorly ordered fields leave padding holes
+struct PaddedRecord {
+    bool active;
+    double weight;
+    bool dirty;
+    int count;
+};
+
+// The virtual base is laid out after the fields
+struct SharedHeader {
+    int id;
+};
+
+struct TaggedRecord : virtual SharedHeader {
+    char tag;
+};
+
+// Instantiates the Container template
+int countItems() {
+    Container<int> numbers;
+    numbers.add(1);
+    numbers.add(2);
+
+    Container<std::string> names;
+    names.add("first");
+
+    return static_cast<int>(numbers.size() + names.size());
+}
@@ -0,0 +1,240 @@
+#include <string>
+#include <vector>
+#include <memory>
+
+// Abstract base class
+class Animal {
+public:
+    virtual ~Animal() = default;
+    virtual void makeSound() const = 0;
+    virtual std::string getName() const = 0;
+};
+
+// Concrete class
+class Dog : public Animal {
+private:
+    std::string name;
+    int age;
+    
+public:
+    Dog(const std::string& name, int age) : name(name), age(age) {}
+    
+    void makeSound() const override {
+        std::cout << "Woof!" << std::endl;
+    }
+    
+    std::string getName() const override {
+        return name;
+    }
+    
+    int getAge() const {
+        return age;
+    }
+};
+
+// Template class
+template<typename T>
+class Container {
+private:
+    std::vector<T> items;
+    
+public:
+    void add(const T& item) {
+        items.push_back(item);
+    }
+    
+    T get(size_t index) const {
+        return items[index];
+    }
+    
+    size_t size() const {
+        return items.size();
+    }
+};
+
+// Singleton pattern
+class Logger {
+private:
+    static Logger* instance;
+    Logger() = default;
+    
+public:
+    static Logger* getInstance() {
+        if (!instance) {
+            instance = new Logger();
+        }
+        return instance;
+    }
+    
+    void log(const std::string& message) {
+        std::cout << "LOG: " << message << std::endl;
+    }
+
+    void warn(const std::string& message) {
+        log("WARN: " + message);
+    }
+};
+
+// Factory pattern
+class Shape {
+public:
+    virtual ~Shape() = default;
+    virtual double getArea() const = 0;
+};
+
+class Circle : public Shape {
+private:
+    double radius;
+    
+public:
+    Circle(double radius) : radius(radius) {}
+    
+    double getArea() const override {
+        return 3.14159 * radius * radius;
+    }
+};
+
+class Triangle : public Shape {
+private:
+    double base;
+    double height;
+
+public:
+    Triangle(double base, double height) : base(base), height(height) {}
+
+    double getArea() const override {
+        return 0.5 * base * height;
+    }
+};
+
+class ShapeFactory {
+public:
+    static std::unique_ptr<Shape> createCircle(double radius) {
+        return std::make_unique<Circle>(radius);
+    }
+};
+
+// Observer pattern
+class Observer {
+public:
+    virtual ~Observer() = default;
+    virtual void update(const std::string& message) = 0;
+};
+
+class Subject {
+private:
+    std::vector<Observer*> observers;
+    
+public:
+    void attach(Observer* observer) {
+        observers.push_back(observer);
+    }
+    
+    void notify(const std::string& message) {
+        for (auto observer : observers) {
+            observer->update(message);
+        }
+    }
+}; 
+
+// Visitor pattern
+class Circle;
+class Square;
+
+class ShapeVisitor {
+public:
+    virtual ~ShapeVisitor() = default;
+    virtual void visit(const Circle& circle) = 0;
+    virtual void visit(const Square& square) = 0;
+};
+
+class VisitableShape {
+public:
+    virtual ~VisitableShape() = default;
+    virtual void accept(ShapeVisitor& visitor) const = 0;
+};
+
+class Square : public VisitableShape {
+private:
+    double side;
+
+public:
+    explicit Square(double side) : side(side) {}
+
+    void accept(ShapeVisitor& visitor) const override {
+        visitor.visit(*this);
+    }
+};
+
+// Composite pattern
+class Group : public Shape {
+private:
+    std::vector<std::unique_ptr<Shape>> children;
+
+public:
+    void add(std::unique_ptr<Shape> child) {
+        children.push_back(std::move(child));
+    }
+
+    double getArea() const override {
+        double area = 0.0;
+        for (const auto& child : children) {
+            area += child->getArea();
+        }
+        return area;
+    }
+};
+
+// CRTP
+template<typename Derived>
+class Comparable {
+public:
+    bool operator!=(const Derived& other) const {
+        return !(static_cast<const Derived&>(*this) == other);
+    }
+};
+
+class Version : public Comparable<Version> {
+private:
+    int number;
+
+public:
+    explicit Version(int number) : number(number) {}
+
+    bool operator==(const Version& other) const {
+        return number == other.number;
+    }
+};
+
+// pImpl idiom
+class Connection {
+public:
+    Connection();
+    ~Connection();
+    void send(const std::string& data);
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+};
+
+// Poorly ordered fields leave padding holes
+struct PaddedRecord {
+    double weight;
+    int count;
+    bool active;
+    bool dirty;
+};
+
+// Instantiates the Container template
+int countItems() {
+    Container<int> numbers;
+    numbers.add(1);
+    numbers.add(2);
+
+    Container<std::string> names;
+    names.add("first");
+
+    Logger::getInstance()->warn("counted");
+    return static_cast<int>(numbers.size() + names.size());
+}
@@ -0,0 +1,77 @@
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Each function below trips one perf lint check; the *Fixed variants do not
+
+struct Sample {
+    std::string source;
+    std::vector<double> values;
+
+    Sample() = default;
+    Sample(const Sample& other) : source(other.source), values(other.values) {}
+    Sample(Sample&& other) : source(std::move(other.source)), values(std::move(other.values)) {}
+};
+
+struct Point {
+    double x = 0.0;
+    double y = 0.0;
+};
+
+class Recorder {
+public:
+    // Takes its name by value and moves it: a sink, not a copy
+    explicit Recorder(std::string name) : name_(std::move(name)) {}
+
+    void add(Sample sample) {
+        total_ += sample.values.size();
+    }
+
+    void forEach(const std::function<void(const Sample&)>& visit) const {
+        for (const auto& sample : samples_) {
+            visit(sample);
+        }
+    }
+
+private:
+    std::string name_;
+    std::vector<Sample> samples_;
+    size_t total_ = 0;
+};
+
+std::vector<int> squares(int count) {
+    std::vector<int> result;
+    for (int i = 0; i < count; ++i) {
+        result.push_back(i * i);
+    }
+    return result;
+}
+
+std::vector<int> squaresFixed(int count) {
+    std::vector<int> result;
+    result.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        result.push_back(i * i);
+    }
+    return result;
+}
+
+double sumPoints(const std::vector<Point>& points) {
+    double sum = 0.0;
+    for (const auto& point : points) {
+        auto copy = std::make_shared<Point>(point);
+        int* scratch = new int(0);
+        sum += copy->x + copy->y + *scratch;
+        delete scratch;
+    }
+    return sum;
+}
+
+int main() {
+    Recorder recorder("main");
+    recorder.add(Sample());
+    recorder.forEach([](const Sample&) {});
+    std::vector<Point> points(4);
+    return static_cast<int>(sumPoints(points)) + squares(3).size() + squaresFixed(3).size();
+}
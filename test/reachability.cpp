@@ -0,0 +1,75 @@
+#include <string>
+#include <vector>
+
+// main reaches the encoders only through a virtual call, parses its input
+// with two mutually recursive functions, and never touches the legacy code
+class Encoder {
+public:
+    virtual ~Encoder() = default;
+    virtual std::string encode(const std::string& text) const = 0;
+};
+
+class Base64Encoder : public Encoder {
+public:
+    std::string encode(const std::string& text) const override {
+        return "b64:" + text;
+    }
+};
+
+class HexEncoder : public Encoder {
+public:
+    std::string encode(const std::string& text) const override {
+        return "hex:" + text;
+    }
+};
+
+std::string run(const Encoder& encoder, const std::string& text) {
+    return encoder.encode(text);
+}
+
+int parseList(const std::string& text, size_t& pos);
+
+int parseValue(const std::string& text, size_t& pos) {
+    if (pos < text.size() && text[pos] == '[') {
+        ++pos;
+        return parseList(text, pos);
+    }
+    return text[pos++] - '0';
+}
+
+int parseList(const std::string& text, size_t& pos) {
+    int sum = 0;
+    while (pos < text.size() && text[pos] != ']') {
+        sum += parseValue(text, pos);
+    }
+    ++pos;
+    return sum;
+}
+
+class LegacyCache {
+public:
+    void store(const std::string& key) {
+        keys_.push_back(key);
+        if (keys_.size() > 16) {
+            compact();
+        }
+    }
+
+    void compact() {
+        std::vector<std::string> kept(keys_.end() - 8, keys_.end());
+        keys_.swap(kept);
+    }
+
+private:
+    std::vector<std::string> keys_;
+};
+
+void legacyFlush(LegacyCache& cache) {
+    cache.compact();
+}
+
+int main() {
+    Base64Encoder encoder;
+    size_t pos = 0;
+    return static_cast<int>(run(encoder, "x").size()) + parseValue("[12[3]]", pos);
+}
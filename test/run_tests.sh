@@ -19,4 +19,92 @@ echo "Test 3: Generating component diagram..."
 echo "Test 4: Generating detailed analysis..."
 ./cpp_diagram_visualizer -i test/example.cpp -o output/analysis.txt -t analysis -f text -d 3
 
+# Test 5: Generate devirtualization report
+echo "Test 5: Generating devirtualization report..."
+./cpp_diagram_visualizer -i test/example.cpp -o output/devirt -t devirt --hot Subject::notify
+
+# Test 6: Generate memory layout diagram
+echo "Test 6: Generating memory layout diagram..."
+./cpp_diagram_visualizer -i test/example.cpp -o output/layout -t layout -f svg
+
+# Test 7: Generate include graph
+echo "Test 7: Generating include graph..."
+./cpp_diagram_visualizer -i test/example.cpp -o output/include -t include -f svg
+
+# Test 8: Profile template instantiations
+echo "Test 8: Profiling template instantiations..."
+./cpp_diagram_visualizer -i test/example.cpp -o output/templates -t class -f svg --templates
+
+# Test 9: Trace phase timings
+echo "Test 9: Tracing phase timings..."
+./cpp_diagram_visualizer -i test/example.cpp -o output/trace -t class -f svg --trace output/trace/trace.json
+
+# Test 10: Query server
+echo "Test 10: Querying a running server..."
+./cpp_diagram_server -i test/example.cpp --socket output/server.sock &
+SERVER_PID=$!
+for i in $(seq 1 50); do [ -S output/server.sock ] && break; sleep 0.2; done
+./cpp_diagram_server --socket output/server.sock -q '{"query":"metrics"}'
+./cpp_diagram_server --socket output/server.sock -q '{"query":"slice","root":"Shape","depth":1}'
+./cpp_diagram_server --socket output/server.sock -q '{"query":"diagram","type":"class","root":"Shape","format":"svg","output":"output/server_slice.svg"}'
+./cpp_diagram_server --socket output/server.sock -q '{"query":"diagram","type":"class","format":"svg","output":"../server_escape.svg"}' || true
+./cpp_diagram_server --socket output/server.sock -q '{"query":"shutdown"}'
+wait $SERVER_PID
+
+# Test 11: Save the model once and render from the saved file
+echo "Test 11: Saving and loading a binary model..."
+./cpp_diagram_visualizer -i test/example.cpp -o output/model -t class -f svg --save-model output/model/example.model
+./cpp_diagram_visualizer --load-model output/model/example.model -o output/model -t call -f svg
+
+# Test 12: Overlay a sampled profile on the call graph
+echo "Test 12: Overlaying a profile on the call graph..."
+./cpp_diagram_visualizer -i test/example.cpp -o output/profile -t call -f svg --profile test/example.folded --profile-threshold 10
+
+# Test 13: Diff two versions of the example against each other and against the saved model
+echo "Test 13: Diffing model snapshots..."
+./cpp_diagram_visualizer -i test/example_v2.cpp -o output/diff -t diff -f svg --base-input test/example.cpp
+./cpp_diagram_visualizer -i test/example_v2.cpp -o output/diff_model -t diff -f svg --base-model output/model/example.model
+
+# Test 14: Parse in two shards, merge them and render from the merged model
+echo "Test 14: Sharded parsing and merging..."
+mkdir -p output/shards
+./cpp_diagram_visualizer -i test/example.cpp,test/example_v2.cpp --shard 0/2 --save-model output/shards/shard0.model &
+./cpp_diagram_visualizer -i test/example.cpp,test/example_v2.cpp --shard 1/2 --save-model output/shards/shard1.model &
+wait
+./cpp_diagram_visualizer merge -o output/shards/merged.model output/shards/shard0.model output/shards/shard1.model
+./cpp_diagram_visualizer --load-model output/shards/merged.model -o output/shards -t class -f svg
+
+# Test 15: Component dependencies with cycle and layering checks
+echo "Test 15: Component dependencies..."
+./cpp_diagram_visualizer -i test/components/app/main.cpp -o output/components -t component -f svg --layers test/components/app,test/components/core,test/components/util
+
+# Test 16: Performance lint findings in the summary, JSON and call graph
+echo "Test 16: Performance lint..."
+./cpp_diagram_visualizer -i test/perf_lint.cpp -o output/lint -t call -f svg --lint --hot Recorder::forEach
+
+# Test 17: False sharing between synchronization members
+echo "Test 17: Concurrency layout..."
+./cpp_diagram_visualizer -i test/concurrency.cpp -o output/concurrency -t concurrency -f svg
+
+# Test 18: Shared precompiled preamble, built on the first run and reused on the second
+echo "Test 18: Shared precompiled preamble..."
+rm -rf output/pch
+./cpp_diagram_visualizer -i test/example.cpp,test/example_v2.cpp -o output/pch -t class -f svg --pch-cache output/pch/cache --trace output/pch/first.json
+./cpp_diagram_visualizer -i test/example.cpp,test/example_v2.cpp -o output/pch -t class -f svg --pch-cache output/pch/cache --trace output/pch/second.json
+./cpp_diagram_visualizer -i test/example.cpp,test/example_v2.cpp -o output/pch/scratch -t class -f svg --no-pch
+ls output/pch/cache/*.pch
+
+# Test 19: Detail levels in class nodes, with large classes folded
+echo "Test 19: Compact class nodes..."
+./cpp_diagram_visualizer -i test/example.cpp -o output/detail/names -t class -f svg -d 1
+./cpp_diagram_visualizer -i test/example.cpp -o output/detail/folded -t class -f svg -d 3 --member-limit 3
+# Test 20: Query-selected diagrams
+echo "Test 20: Graph queries..."
+./cpp_diagram_visualizer -i test/example.cpp -o output/query/classes -t class -f svg -q "classes where derives(Shape) or base_of(Dog)"
+./cpp_diagram_visualizer -i test/example.cpp -o output/query/functions -t call -f svg -q "functions where member_of(Subject) and not name ~ attach"
+# Test 21: Reachability from main through virtual calls, with recursion and dead code
+echo "Test 21: Reachability..."
+./cpp_diagram_visualizer -i test/reachability.cpp -o output/reach -t reach
+./cpp_diagram_visualizer -i test/reachability.cpp -o output/reach/legacy -t reach --roots legacyFlush
+
 echo "Tests completed. Check the output directory for results." 
\ No newline at end of file